@@ -7,29 +7,89 @@ ActionDispatcher::ActionDispatcher() {}
 
 ActionDispatcher::~ActionDispatcher() {}
 
-void ActionDispatcher::Trigger(const std::string &actionName) {
-  std::cout << "[Action] Triggering: " << actionName << std::endl;
-
-  // 1. Check for ConfigManager managed action first
-  AppConfig &cfg = ConfigManager::Get().Current();
-  std::string command = actionName;
-
+std::string ActionDispatcher::ResolveCommand(const std::string &actionName) {
   // If the actionName exists in the map, use the mapped command string
-  if (cfg.actionMap.count(actionName)) {
-    command = cfg.actionMap[actionName];
-    std::cout << "  -> Resolved to: " << command << std::endl;
+  AppConfig &cfg = ConfigManager::Get().Current();
+  auto it = cfg.actionMap.find(actionName);
+  if (it != cfg.actionMap.end()) {
+    return it->second;
   }
+  return actionName;
+}
 
-  // 2. Plugin Commands
+std::string ActionDispatcher::PluginNameFor(const std::string &command) {
   // Support legacy "quick_panel" for older configs, but map to plugin
   if (command == "quick_panel") {
-    SendPluginCommand("QuickPanel");
+    return "QuickPanel";
+  }
+  if (command.rfind("plugin:", 0) == 0) {
+    return command.substr(7);
+  }
+  return "";
+}
+
+void ActionDispatcher::Prepare(const std::string &actionName) {
+  if (actionName == m_preparedAction)
+    return;
+  DiscardPrepared();
+
+  std::string command = ResolveCommand(actionName);
+  if (command == "none" || command.empty())
+    return;
+
+  m_preparedAction = actionName;
+  std::cout << "[Action] Preparing: " << actionName << std::endl;
+
+  if (command == "quick_panel" || command.rfind("plugin:", 0) == 0) {
+    std::string pluginName = PluginNameFor(command);
+    if (!pluginName.empty()) {
+      m_preparedPlugin = pluginName;
+      SendPluginMessage(COPYDATA_PREPARE_PLUGIN, pluginName);
+    }
     return;
   }
 
-  if (command.rfind("plugin:", 0) == 0) {
-    // Starts with "plugin:"
-    std::string pluginName = command.substr(7);
+  m_preparedInputs = ParseKeySequence(command);
+}
+
+void ActionDispatcher::DiscardPrepared() {
+  if (!m_preparedPlugin.empty()) {
+    SendPluginMessage(COPYDATA_DISCARD_PLUGIN, m_preparedPlugin);
+  }
+  m_preparedAction.clear();
+  m_preparedPlugin.clear();
+  m_preparedInputs.clear();
+}
+
+void ActionDispatcher::Trigger(const std::string &actionName) {
+  std::cout << "[Action] Triggering: " << actionName << std::endl;
+
+  // 1. Reuse the work done by Prepare() during the gesture
+  if (!m_preparedAction.empty() && actionName == m_preparedAction) {
+    std::vector<INPUT> inputs = std::move(m_preparedInputs);
+    std::string pluginName = std::move(m_preparedPlugin);
+    m_preparedAction.clear();
+    m_preparedInputs.clear();
+    m_preparedPlugin.clear();
+
+    if (!pluginName.empty()) {
+      SendPluginCommand(pluginName);
+    } else if (!inputs.empty()) {
+      SendKeySequence(inputs);
+    }
+    return;
+  }
+  DiscardPrepared();
+
+  // 2. Check for ConfigManager managed action
+  std::string command = ResolveCommand(actionName);
+  if (command != actionName) {
+    std::cout << "  -> Resolved to: " << command << std::endl;
+  }
+
+  // 3. Plugin Commands
+  if (command == "quick_panel" || command.rfind("plugin:", 0) == 0) {
+    std::string pluginName = PluginNameFor(command);
     if (!pluginName.empty()) {
       SendPluginCommand(pluginName);
     }
@@ -40,7 +100,7 @@ void ActionDispatcher::Trigger(const std::string &actionName) {
     return;
   }
 
-  // 3. Parse and Execute Key Sequence
+  // 4. Parse and Execute Key Sequence
   std::vector<INPUT> inputs = ParseKeySequence(command);
   if (!inputs.empty()) {
     SendKeySequence(inputs);
@@ -163,16 +223,29 @@ void ActionDispatcher::SendKeySequence(const std::vector<INPUT> &inputs) {
 }
 
 void ActionDispatcher::SendPluginCommand(const std::string &pluginName) {
+  SendPluginMessage(COPYDATA_SHOW_PLUGIN, pluginName);
+}
+
+void ActionDispatcher::SendPluginMessage(ULONG_PTR id,
+                                         const std::string &pluginName) {
   HWND hwnd = FindWindowW(NULL, L"EdgeGesture Config");
   if (hwnd) {
     // prepare COPYDATASTRUCT
     COPYDATASTRUCT cds;
-    cds.dwData = 1; // ID for Plugin Command
+    cds.dwData = id;
     cds.cbData = (DWORD)(pluginName.size() + 1);
     cds.lpData = (PVOID)pluginName.c_str();
 
-    SendMessage(hwnd, WM_COPYDATA, 0, (LPARAM)&cds);
-    std::cout << "[Action] Sent plugin command: " << pluginName << std::endl;
+    // Hints must not stall the gesture, only the show command is synchronous
+    if (id == COPYDATA_SHOW_PLUGIN) {
+      SendMessage(hwnd, WM_COPYDATA, 0, (LPARAM)&cds);
+    } else {
+      DWORD_PTR result = 0;
+      SendMessageTimeout(hwnd, WM_COPYDATA, 0, (LPARAM)&cds,
+                         SMTO_ABORTIFHUNG, 50, &result);
+    }
+    std::cout << "[Action] Sent plugin message " << id << ": " << pluginName
+              << std::endl;
   } else {
     std::cerr << "[Action] Qt Window not found for Plugin Command" << std::endl;
   }
@@ -12,10 +12,29 @@ public:
 
   void Trigger(const std::string &actionName);
 
+  // Pre-warm the likely action while the gesture is still in progress:
+  // key sequences are parsed ahead of time and plugins get a hint so the UI
+  // can instantiate them hidden. Trigger() consumes the prepared work.
+  void Prepare(const std::string &actionName);
+  void DiscardPrepared();
+  const std::string &PreparedAction() const { return m_preparedAction; }
+
 private:
+  std::string ResolveCommand(const std::string &actionName);
+  static std::string PluginNameFor(const std::string &command);
   void SendKeySequence(const std::vector<INPUT> &inputs);
   std::vector<INPUT> ParseKeySequence(const std::string &sequence);
   WORD GetKeyCode(const std::string &keyName);
   void NotifyQtQuickPanel();
   void SendPluginCommand(const std::string &pluginName);
+  void SendPluginMessage(ULONG_PTR id, const std::string &pluginName);
+
+  // WM_COPYDATA ids understood by SettingsUI
+  static const ULONG_PTR COPYDATA_SHOW_PLUGIN = 1;
+  static const ULONG_PTR COPYDATA_PREPARE_PLUGIN = 2;
+  static const ULONG_PTR COPYDATA_DISCARD_PLUGIN = 3;
+
+  std::string m_preparedAction;
+  std::string m_preparedPlugin;
+  std::vector<INPUT> m_preparedInputs;
 };
@@ -0,0 +1,124 @@
+#include "BlacklistMatcher.h"
+#include <algorithm>
+#include <cctype>
+
+std::string BlacklistMatcher::Fold(const std::string &s) {
+  std::string out(s);
+  for (char &c : out) {
+    c = (char)std::tolower((unsigned char)c);
+  }
+  return out;
+}
+
+void BlacklistMatcher::Clear() {
+  m_exact.clear();
+  m_globs.clear();
+  m_trie.assign(1, TrieNode{});
+  m_hasPrefixes = false;
+}
+
+void BlacklistMatcher::Compile(const std::vector<std::string> &entries) {
+  Clear();
+  m_exact.reserve(entries.size());
+
+  for (const auto &entry : entries) {
+    if (entry.empty())
+      continue;
+
+    std::string folded = Fold(entry);
+    size_t wild = folded.find_first_of("*?");
+
+    if (wild == std::string::npos) {
+      m_exact.insert(std::move(folded));
+    } else if (wild == folded.size() - 1 && folded[wild] == '*') {
+      // "name*" family, the common case for launchers and RDP clients
+      AddPrefix(folded.substr(0, wild));
+    } else {
+      m_globs.push_back(std::move(folded));
+    }
+  }
+}
+
+void BlacklistMatcher::AddPrefix(const std::string &prefix) {
+  m_hasPrefixes = true;
+  int node = 0;
+  for (char c : prefix) {
+    auto &edges = m_trie[node].next;
+    auto it = std::lower_bound(
+        edges.begin(), edges.end(), c,
+        [](const std::pair<char, int> &e, char key) { return e.first < key; });
+    if (it != edges.end() && it->first == c) {
+      node = it->second;
+    } else {
+      int child = (int)m_trie.size();
+      edges.insert(it, {c, child});
+      m_trie.emplace_back();
+      node = child;
+    }
+  }
+  m_trie[node].terminal = true;
+}
+
+bool BlacklistMatcher::MatchesPrefix(const std::string &folded) const {
+  if (!m_hasPrefixes)
+    return false;
+
+  int node = 0;
+  if (m_trie[node].terminal)
+    return true; // bare "*"
+
+  for (char c : folded) {
+    const auto &edges = m_trie[node].next;
+    auto it = std::lower_bound(
+        edges.begin(), edges.end(), c,
+        [](const std::pair<char, int> &e, char key) { return e.first < key; });
+    if (it == edges.end() || it->first != c)
+      return false;
+    node = it->second;
+    if (m_trie[node].terminal)
+      return true;
+  }
+  return false;
+}
+
+bool BlacklistMatcher::Matches(const std::string &exeName) const {
+  if (exeName.empty() || Empty())
+    return false;
+
+  std::string folded = Fold(exeName);
+  if (m_exact.count(folded))
+    return true;
+  if (MatchesPrefix(folded))
+    return true;
+  for (const auto &glob : m_globs) {
+    if (GlobMatch(glob.c_str(), folded.c_str()))
+      return true;
+  }
+  return false;
+}
+
+// Iterative '*' / '?' matcher with single-star backtracking, linear in
+// practice for the short patterns used here.
+bool BlacklistMatcher::GlobMatch(const char *pattern, const char *text) {
+  const char *star = nullptr;
+  const char *resume = nullptr;
+
+  while (*text) {
+    if (*pattern == '?' || *pattern == *text) {
+      ++pattern;
+      ++text;
+    } else if (*pattern == '*') {
+      star = pattern++;
+      resume = text;
+    } else if (star) {
+      pattern = star + 1;
+      text = ++resume;
+    } else {
+      return false;
+    }
+  }
+
+  while (*pattern == '*')
+    ++pattern;
+  return *pattern == '\0';
+}
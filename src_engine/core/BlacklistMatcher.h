@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Compiled form of AppConfig::blacklist.
+// Plain executable names go into a case-folded hash set. Entries ending in a
+// single '*' ("steam*") are compiled into a prefix trie, and any other entry
+// containing '*' or '?' is kept as a folded glob pattern.
+class BlacklistMatcher {
+public:
+  void Compile(const std::vector<std::string> &entries);
+  void Clear();
+
+  bool Matches(const std::string &exeName) const;
+  bool Empty() const {
+    return m_exact.empty() && m_globs.empty() && !m_hasPrefixes;
+  }
+
+  static bool GlobMatch(const char *pattern, const char *text);
+
+private:
+  struct TrieNode {
+    std::vector<std::pair<char, int>> next; // sorted by char
+    bool terminal = false;
+  };
+
+  static std::string Fold(const std::string &s);
+  void AddPrefix(const std::string &prefix);
+  bool MatchesPrefix(const std::string &folded) const;
+
+  std::unordered_set<std::string> m_exact;
+  std::vector<TrieNode> m_trie; // root at index 0
+  std::vector<std::string> m_globs;
+  bool m_hasPrefixes = false;
+};
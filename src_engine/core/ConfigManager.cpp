@@ -4,7 +4,7 @@
 #include <iomanip>
 #include <iostream>
 
-void ConfigManager::Load() {
+unsigned ConfigManager::Load() {
   if (!std::filesystem::exists(m_configPath)) {
     json j;
     j["physics"] = {{"tension", 0.35}, {"friction", 0.65}};
@@ -40,38 +40,106 @@ void ConfigManager::Load() {
     o << std::setw(4) << j << std::endl;
   }
 
-  LoadFromPath(m_configPath);
+  unsigned changed = LoadFromPath(m_configPath);
   m_currentProfile = "default";
+  return changed;
 }
 
-void ConfigManager::LoadProfile(const std::string &appName) {
+unsigned ConfigManager::LoadProfile(const std::string &appName) {
   if (appName == m_currentProfile) {
-    return;
+    return SectionNone;
   }
 
   std::string profilePath = m_configsDir + "/" + appName + ".json";
   std::string defaultPath = m_configsDir + "/default.json";
 
+  unsigned changed = SectionNone;
   if (std::filesystem::exists(profilePath)) {
-    LoadFromPath(profilePath);
+    changed = LoadFromPath(profilePath);
     m_currentProfile = appName;
     std::cout << "[Config] Loaded profile: " << appName << std::endl;
   } else if (std::filesystem::exists(defaultPath)) {
-    LoadFromPath(defaultPath);
+    changed = LoadFromPath(defaultPath);
     m_currentProfile = "default";
     std::cout << "[Config] Profile not found, using default" << std::endl;
   } else {
     std::cout << "[Config] No profile or default found, keeping current"
               << std::endl;
-    return;
+    return SectionNone;
   }
 
   if (m_profileChangeCb) {
     m_profileChangeCb(m_currentProfile);
   }
+  return changed;
 }
 
-void ConfigManager::LoadFromPath(const std::string &path) {
+unsigned ConfigManager::Diff(const AppConfig &a, const AppConfig &b) {
+  unsigned changed = SectionNone;
+
+  auto sameLayout = [](const SideConfig &x, const SideConfig &y) {
+    return x.enabled == y.enabled && x.width == y.width &&
+           x.size == y.size && x.position == y.position;
+  };
+  if (!sameLayout(a.left, b.left) || !sameLayout(a.right, b.right))
+    changed |= SectionLayout;
+
+  if (a.tension != b.tension || a.friction != b.friction ||
+      a.triggerThreshold != b.triggerThreshold || a.maxWaveX != b.maxWaveX ||
+      a.verticalRange != b.verticalRange ||
+      a.longSwipeThreshold != b.longSwipeThreshold ||
+      a.shortSwipeThreshold != b.shortSwipeThreshold ||
+      a.left.color != b.left.color || a.right.color != b.right.color)
+    changed |= SectionPhysics;
+
+  if (a.splitMode != b.splitMode || a.gestureMap != b.gestureMap)
+    changed |= SectionGestures;
+  if (a.actionMap != b.actionMap)
+    changed |= SectionActions;
+  if (a.blacklist != b.blacklist)
+    changed |= SectionBlacklist;
+
+  return changed;
+}
+
+unsigned ConfigManager::LoadFromPath(const std::string &path) {
+  // The UI notifies every engine window per save; skip files we already have
+  std::error_code stampEc;
+  std::error_code sizeEc;
+  auto stamp = std::filesystem::last_write_time(path, stampEc);
+  auto size = std::filesystem::file_size(path, sizeEc);
+  long long stampValue = (long long)stamp.time_since_epoch().count();
+  // Both must be known to compare; otherwise always reload
+  bool statOk = !stampEc && !sizeEc;
+  if (statOk && path == m_loadedPath && stampValue == m_loadedStamp &&
+      size == m_loadedSize) {
+    return SectionNone;
+  }
+
+  // Parse over a copy of the published snapshot (sections missing from the
+  // file keep their values), then publish only if it differs
+  AppConfig next = m_config;
+  if (!ParseFile(path, next))
+    return SectionNone;
+
+  // An unknown stamp must never match a later notification
+  m_loadedPath = statOk ? path : std::string();
+  m_loadedStamp = statOk ? stampValue : 0;
+  m_loadedSize = statOk ? size : 0;
+
+  unsigned changed = Diff(m_config, next);
+  if (changed == SectionNone)
+    return SectionNone;
+
+  m_config = std::move(next);
+  if (changed & SectionBlacklist) {
+    m_blacklist.Compile(m_config.blacklist);
+  }
+  m_generation++;
+  return changed;
+}
+
+bool ConfigManager::ParseFile(const std::string &path, AppConfig &out) {
   try {
     std::ifstream i(path);
     json j;
@@ -104,65 +172,67 @@ void ConfigManager::LoadFromPath(const std::string &path) {
     }
 
     if (j.contains("physics")) {
-      m_config.tension = j["physics"].value("tension", 0.35f);
-      m_config.friction = j["physics"].value("friction", 0.65f);
+      out.tension = j["physics"].value("tension", 0.35f);
+      out.friction = j["physics"].value("friction", 0.65f);
     }
 
     if (j.contains("general")) {
-      m_config.triggerThreshold =
+      out.triggerThreshold =
           j["general"].value("trigger_threshold", 90.0f);
-      m_config.maxWaveX = j["general"].value("max_wave_x", 160.0f);
-      m_config.verticalRange = j["general"].value("vertical_range", 50);
-      m_config.splitMode = j["general"].value("split_mode", 0);
-      m_config.longSwipeThreshold =
+      out.maxWaveX = j["general"].value("max_wave_x", 160.0f);
+      out.verticalRange = j["general"].value("vertical_range", 50);
+      out.splitMode = j["general"].value("split_mode", 0);
+      out.longSwipeThreshold =
           j["general"].value("long_swipe_threshold", 450.0f);
-      m_config.shortSwipeThreshold =
+      out.shortSwipeThreshold =
           j["general"].value("short_swipe_threshold", 30.0f);
     }
 
     if (j.contains("left_handle")) {
       auto &l = j["left_handle"];
-      m_config.left.enabled = l.value("enabled", true);
-      m_config.left.width = l.value("width", 30);
-      m_config.left.size = l.value("size", 100);
-      m_config.left.position = l.value("position", 50);
-      m_config.left.color = l.value("color", "#000000");
+      out.left.enabled = l.value("enabled", true);
+      out.left.width = l.value("width", 30);
+      out.left.size = l.value("size", 100);
+      out.left.position = l.value("position", 50);
+      out.left.color = l.value("color", "#000000");
     }
 
     if (j.contains("right_handle")) {
       auto &r = j["right_handle"];
-      m_config.right.enabled = r.value("enabled", true);
-      m_config.right.width = r.value("width", 30);
-      m_config.right.size = r.value("size", 100);
-      m_config.right.position = r.value("position", 50);
-      m_config.right.color = r.value("color", "#000000");
+      out.right.enabled = r.value("enabled", true);
+      out.right.width = r.value("width", 30);
+      out.right.size = r.value("size", 100);
+      out.right.position = r.value("position", 50);
+      out.right.color = r.value("color", "#000000");
     }
 
     if (j.contains("actions")) {
-      m_config.actionMap.clear();
+      out.actionMap.clear();
       for (auto &el : j["actions"].items()) {
-        m_config.actionMap[el.key()] = el.value();
+        out.actionMap[el.key()] = el.value();
       }
     }
 
     if (j.contains("gestures")) {
-      m_config.gestureMap.clear();
+      out.gestureMap.clear();
       for (auto &el : j["gestures"].items()) {
-        m_config.gestureMap[el.key()] = el.value();
+        out.gestureMap[el.key()] = el.value();
       }
     }
 
-    m_config.blacklist.clear();
+    out.blacklist.clear();
     if (j.contains("blacklist")) {
       for (const auto &val : j["blacklist"]) {
-        m_config.blacklist.push_back(val.get<std::string>());
+        out.blacklist.push_back(val.get<std::string>());
       }
     }
 
     std::cout << "[Config] Loaded from: " << path << std::endl;
+    return true;
 
   } catch (std::exception &e) {
     std::cerr << "[Config] Error loading config: " << e.what() << std::endl;
+    return false;
   }
 }
 
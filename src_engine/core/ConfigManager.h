@@ -1,4 +1,5 @@
 #pragma once
+#include "BlacklistMatcher.h"
 #include <functional>
 #include <map>
 #include <nlohmann/json.hpp>
@@ -49,6 +50,18 @@ struct AppConfig {
   // Quick Panel IPC port or window name could go here
 };
 
+// Config sections a reload can touch, returned as a bitmask so callers only
+// re-apply what actually changed
+enum ConfigSection : unsigned {
+  SectionNone = 0,
+  SectionLayout = 1 << 0,    // handle enabled/width/size/position
+  SectionPhysics = 1 << 1,   // spring, thresholds, wave, colors
+  SectionGestures = 1 << 2,  // gestureMap, splitMode
+  SectionActions = 1 << 3,   // actionMap
+  SectionBlacklist = 1 << 4, // blacklist
+  SectionAll = 0x1F
+};
+
 class ConfigManager {
 public:
   static ConfigManager &Get() {
@@ -56,11 +69,18 @@ public:
     return instance;
   }
 
-  void Load();
-  void LoadProfile(const std::string &appName);
+  // Both return the ConfigSection bits that differ from the published config
+  unsigned Load();
+  unsigned LoadProfile(const std::string &appName);
+  static unsigned Diff(const AppConfig &a, const AppConfig &b);
   AppConfig &Current() { return m_config; }
   std::string CurrentProfileName() const { return m_currentProfile; }
 
+  // Compiled from Current().blacklist on every load
+  const BlacklistMatcher &Blacklist() const { return m_blacklist; }
+  // Bumped on every successful load, lets callers invalidate cached lookups
+  unsigned Generation() const { return m_generation; }
+
   using ProfileChangeCallback = std::function<void(const std::string &)>;
   void SetProfileChangeCallback(ProfileChangeCallback cb) {
     m_profileChangeCb = cb;
@@ -70,9 +90,17 @@ public:
 
 private:
   ConfigManager() = default;
-  void LoadFromPath(const std::string &path);
+  unsigned LoadFromPath(const std::string &path);
+  bool ParseFile(const std::string &path, AppConfig &out);
 
   AppConfig m_config;
+  BlacklistMatcher m_blacklist;
+  unsigned m_generation = 0;
+
+  // Identity of the last parsed file; an untouched file is not parsed again
+  std::string m_loadedPath;
+  long long m_loadedStamp = 0;
+  unsigned long long m_loadedSize = 0;
   std::string m_configPath = "config.json";
   std::string m_configsDir = "configs";
   std::string m_currentProfile = "default";
@@ -1,15 +1,23 @@
 #include "EngineCore.h"
+#include <chrono>
 #include <cmath>
 #include <iostream>
 #include <psapi.h>
 #include <string>
 
-EngineCore::EngineCore() {}
+// Static trampoline for the foreground WinEvent hook
+static EngineCore *g_EngineInstance = nullptr;
 
-EngineCore::~EngineCore() {}
+EngineCore::EngineCore() { g_EngineInstance = this; }
 
-std::string EngineCore::GetActiveProcessName() {
-  HWND hwnd = GetForegroundWindow();
+EngineCore::~EngineCore() {
+  if (m_foregroundHook)
+    UnhookWinEvent(m_foregroundHook);
+  InputWindow::Get().SetScheduler(nullptr);
+  g_EngineInstance = nullptr;
+}
+
+std::string EngineCore::GetProcessName(HWND hwnd) {
   if (!hwnd)
     return "";
 
@@ -33,46 +41,158 @@ std::string EngineCore::GetActiveProcessName() {
 }
 
 void EngineCore::Run() {
-  ConfigManager::Get().Load();
+  TraceRecorder &trace = TraceRecorder::Get();
+  uint64_t startupBegin = trace.NowUs();
+
+  {
+    TraceScope scope("Config::Load");
+    ConfigManager::Get().Load();
+  }
 
   int screenW = GetSystemMetrics(SM_CXSCREEN);
   int screenH = GetSystemMetrics(SM_CYSCREEN);
 
+  // Cheap: the window and Direct2D objects are deferred (see warm-up below)
   m_vis.Init(screenW, screenH);
 
-  InputWindow::Get().SetCallbacks(
-      [this](bool inZone, bool isLeft) { OnZoneState(inZone, isLeft); },
-      [this](bool isLeft, int y) { OnGestureStart(isLeft, y); },
-      [this](int x, int y) { OnGestureUpdate(x, y); },
-      [this]() { OnGestureEnd(); });
-  InputWindow::Get().Initialize();
+  {
+    TraceScope scope("InputWindow::Initialize");
+    InputWindow::Get().SetCallbacks(
+        [this](bool inZone, bool isLeft) { OnZoneState(inZone, isLeft); },
+        [this](bool isLeft, int y) { OnGestureStart(isLeft, y); },
+        [this](int x, int y) { OnGestureUpdate(x, y); },
+        [this]() { OnGestureEnd(); });
+    InputWindow::Get().SetScheduler(&m_scheduler);
+    InputWindow::Get().Initialize();
+  }
 
-  // SetTimer(NULL, m_profileTimerId, 500, nullptr);
-  m_profileTimerId = SetTimer(NULL, 0, 500, nullptr);
-  MSG msg;
-  while (GetMessage(&msg, nullptr, 0, 0)) {
-    TranslateMessage(&msg);
-    DispatchMessage(&msg);
+  {
+    // Foreground changes drive profile switching, blacklist lookups and the
+    // overlay watchdog, so nothing needs to poll while the user is idle
+    TraceScope scope("Foreground::Hook");
+    m_foregroundHook = SetWinEventHook(
+        EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, nullptr,
+        WinEventProc, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+    RefreshForeground();
+  }
 
-    if (msg.message == (WM_USER + 101)) {
-      ReloadConfig();
-    }
+  uint64_t startupUs = trace.NowUs() - startupBegin;
+  trace.Record("Startup", startupBegin, startupUs);
+  std::cout << "[Core] Ready in " << startupUs / 1000.0 << " ms" << std::endl;
+
+  // Build the visualizer while idle so the first gesture does not pay for
+  // it; a gesture arriving earlier creates it on demand instead
+  m_warmupTimer = m_scheduler.Once(VISUALIZER_WARMUP_MS, [this]() {
+    m_warmupTimer = 0;
+    m_vis.EnsureCreated();
+    TraceRecorder::Get().Dump();
+  });
+
+  // Sleep until a message arrives or the next scheduled timer is due
+  MSG msg;
+  bool running = true;
+  while (running) {
+    MsgWaitForMultipleObjectsEx(0, nullptr, m_scheduler.NextTimeout(),
+                                QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+
+    while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+      if (msg.message == WM_QUIT) {
+        running = false;
+        break;
+      }
+      TranslateMessage(&msg);
+      DispatchMessage(&msg);
 
-    if (msg.message == WM_TIMER && msg.wParam == m_profileTimerId) {
-      std::string appName = GetActiveProcessName();
-      if (!appName.empty() && appName != m_lastAppName) {
-        m_lastAppName = appName;
-        ConfigManager::Get().LoadProfile(appName);
-        InputWindow::Get().UpdateLayout();
+      // Sent to every engine window per UI save, handled once here
+      if (msg.message == (WM_USER + 101)) {
+        RequestReload();
       }
     }
+
+    m_scheduler.Advance();
+  }
+
+  TraceRecorder::Get().Dump();
+}
+
+void CALLBACK EngineCore::WinEventProc(HWINEVENTHOOK, DWORD event, HWND,
+                                       LONG idObject, LONG, DWORD, DWORD) {
+  if (event == EVENT_SYSTEM_FOREGROUND && idObject == OBJID_WINDOW &&
+      g_EngineInstance) {
+    g_EngineInstance->OnForegroundEvent();
+  }
+}
+
+void EngineCore::OnForegroundEvent() {
+  // Coalesce bursts (alt-tab cycling) into one refresh on the next loop turn
+  if (!m_scheduler.IsActive(m_foregroundTimer)) {
+    m_foregroundTimer = m_scheduler.Once(0, [this]() {
+      m_foregroundTimer = 0;
+      RefreshForeground();
+    });
+  }
+  // Win+D and similar hide the overlays while changing the foreground
+  InputWindow::Get().ArmWatchdog();
+}
+
+void EngineCore::RefreshForeground() {
+  HWND hwnd = GetForegroundWindow();
+  if (hwnd == m_foregroundHwnd)
+    return;
+  m_foregroundHwnd = hwnd;
+  m_foregroundApp = GetProcessName(hwnd);
+
+  if (!m_foregroundApp.empty() && m_foregroundApp != m_lastAppName) {
+    m_lastAppName = m_foregroundApp;
+    ApplyConfigChanges(ConfigManager::Get().LoadProfile(m_foregroundApp));
+  }
+
+  ConfigManager &config = ConfigManager::Get();
+  m_foregroundBlacklisted = config.Blacklist().Matches(m_foregroundApp);
+  m_blacklistGeneration = config.Generation();
+}
+
+void EngineCore::RequestReload() {
+  // Both windows receive the notification in the same burst; the zero-delay
+  // timer runs after the queue is drained so they collapse into one reload
+  if (!m_scheduler.IsActive(m_reloadTimer)) {
+    m_reloadTimer = m_scheduler.Once(0, [this]() {
+      m_reloadTimer = 0;
+      ReloadConfig();
+    });
   }
 }
 
 void EngineCore::ReloadConfig() {
-  ConfigManager::Get().Load();
-  InputWindow::Get().UpdateLayout();
-  std::cout << "[Core] Config Reloaded" << std::endl;
+  TraceScope trace("Config::Reload");
+  auto start = std::chrono::steady_clock::now();
+  unsigned changed = ConfigManager::Get().Load();
+  ApplyConfigChanges(changed);
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+
+  std::cout << "[Core] Config Reloaded in " << ms << " ms, changed:"
+            << ((changed & SectionLayout) ? " layout" : "")
+            << ((changed & SectionPhysics) ? " physics" : "")
+            << ((changed & SectionGestures) ? " gestures" : "")
+            << ((changed & SectionActions) ? " actions" : "")
+            << ((changed & SectionBlacklist) ? " blacklist" : "")
+            << (changed == SectionNone ? " nothing" : "") << std::endl;
+}
+
+void EngineCore::ApplyConfigChanges(unsigned changed) {
+  if (changed & SectionLayout) {
+    InputWindow::Get().UpdateLayout();
+  }
+  if (changed & (SectionGestures | SectionActions)) {
+    // A prepared action may no longer match the tables
+    m_stableKey.clear();
+    m_stableSamples = 0;
+    m_dispatcher.DiscardPrepared();
+  }
+  // Physics is read live every frame and the blacklist verdict is
+  // re-matched lazily through ConfigManager::Generation()
 }
 
 void EngineCore::OnZoneState(bool inZone, bool isLeft) {
@@ -102,8 +222,15 @@ void EngineCore::OnGestureStart(bool isLeft, int y) {
   m_velocityX = 0;
   m_velocityY = 0;
 
-  m_vis.SetTimerCallback([this]() { this->PhysicsLoop(); });
-  SetTimer(m_vis.GetHwnd(), m_timerId, 16, nullptr);
+  m_currentAction = "none";
+  m_stableKey.clear();
+  m_stableSamples = 0;
+  m_dispatcher.DiscardPrepared();
+
+  if (!m_scheduler.IsActive(m_physicsTimer)) {
+    m_physicsTimer =
+        m_scheduler.Every(PHYSICS_INTERVAL_MS, [this]() { PhysicsLoop(); });
+  }
 }
 
 void EngineCore::OnGestureUpdate(int x, int y) {
@@ -134,6 +261,29 @@ void EngineCore::OnGestureEnd() {
     m_dispatcher.Trigger(m_currentAction);
   } else {
     std::cout << "  -> Below threshold, not triggering" << std::endl;
+    m_dispatcher.DiscardPrepared();
+  }
+}
+
+void EngineCore::UpdatePrewarm(const std::string &key) {
+  AppConfig &cfg = ConfigManager::Get().Current();
+
+  if (key != m_stableKey || m_currentX <= cfg.triggerThreshold) {
+    // Classification moved or fell back under the threshold
+    m_stableKey = key;
+    m_stableSamples = 0;
+    if (!m_dispatcher.PreparedAction().empty() &&
+        m_dispatcher.PreparedAction() != m_currentAction) {
+      m_dispatcher.DiscardPrepared();
+    }
+    if (m_currentX <= cfg.triggerThreshold)
+      return;
+  }
+
+  if (++m_stableSamples == PREWARM_STABLE_SAMPLES &&
+      m_currentAction != "none") {
+    std::cout << "  -> Likely action: " << m_currentAction << std::endl;
+    m_dispatcher.Prepare(m_currentAction);
   }
 }
 
@@ -193,6 +343,8 @@ void EngineCore::DetermineGesture() {
       std::cout << "  -> Gesture key NOT found in map: " << key << std::endl;
       m_currentAction = "none";
     }
+
+    UpdatePrewarm(key);
   }
 }
 
@@ -217,7 +369,7 @@ void EngineCore::PhysicsLoop() {
   if (!m_isDragging && std::abs(m_currentX) < 0.5f &&
       std::abs(m_velocityX) < 0.5f) {
     m_currentX = 0;
-    KillTimer(m_vis.GetHwnd(), m_timerId);
+    m_scheduler.Cancel(m_physicsTimer);
   }
 
   bool triggered = (m_currentX > cfg.triggerThreshold);
@@ -226,16 +378,14 @@ void EngineCore::PhysicsLoop() {
 }
 
 bool EngineCore::IsBlacklistedAppActive() {
-  std::string exeName = GetActiveProcessName();
-  if (exeName.empty())
-    return false;
-
-  AppConfig &cfg = ConfigManager::Get().Current();
-  for (const auto &blocked : cfg.blacklist) {
-    if (_stricmp(exeName.c_str(), blocked.c_str()) == 0) {
-      return true;
-    }
+  // Only an HWND compare unless a foreground event is still pending
+  RefreshForeground();
+
+  // Config reloads recompile the matcher, re-match the cached name
+  ConfigManager &config = ConfigManager::Get();
+  if (m_blacklistGeneration != config.Generation()) {
+    m_foregroundBlacklisted = config.Blacklist().Matches(m_foregroundApp);
+    m_blacklistGeneration = config.Generation();
   }
-
-  return false;
+  return m_foregroundBlacklisted;
 }
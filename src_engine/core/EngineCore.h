@@ -1,6 +1,8 @@
 #pragma once
 #include "actions/ActionDispatcher.h"
 #include "core/ConfigManager.h"
+#include "core/TimerScheduler.h"
+#include "core/TraceRecorder.h"
 #include "input/InputWindow.h"
 #include "ui/Visualizer.h"
 #include <memory>
@@ -15,7 +17,16 @@ public:
   void Run();
   void ReloadConfig();
 
+  TimerScheduler &Scheduler() { return m_scheduler; }
+
 private:
+  static void CALLBACK WinEventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+                                    LONG idObject, LONG idChild,
+                                    DWORD idEventThread, DWORD dwmsEventTime);
+  void OnForegroundEvent();
+  void RequestReload();
+  void ApplyConfigChanges(unsigned changed);
+
   void OnZoneState(bool inZone, bool isLeft);
   void OnGestureStart(bool isLeft, int y);
   void OnGestureUpdate(int x, int y);
@@ -24,10 +35,13 @@ private:
   void PhysicsLoop();
 
   bool IsBlacklistedAppActive();
-  std::string GetActiveProcessName();
+  void RefreshForeground();
+  static std::string GetProcessName(HWND hwnd);
 
   void DetermineGesture();
+  void UpdatePrewarm(const std::string &key);
 
+  TimerScheduler m_scheduler;
   Visualizer m_vis;
   ActionDispatcher m_dispatcher;
 
@@ -43,10 +57,30 @@ private:
   bool m_isAnimating = false;
   bool m_isLeft = true;
 
-  UINT_PTR m_timerId = 1001;
-  UINT_PTR m_profileTimerId = 2001;
+  TimerScheduler::Handle m_physicsTimer = 0;
+  TimerScheduler::Handle m_foregroundTimer = 0;
+  TimerScheduler::Handle m_reloadTimer = 0;
+  TimerScheduler::Handle m_warmupTimer = 0;
+  HWINEVENTHOOK m_foregroundHook = nullptr;
+
+  const UINT PHYSICS_INTERVAL_MS = 16;
+  // The visualizer is built this long after startup unless a gesture
+  // needs it first
+  const UINT VISUALIZER_WARMUP_MS = 1500;
+
+  // Pre-warm once the classification held for this many samples past the
+  // trigger threshold
+  const int PREWARM_STABLE_SAMPLES = 3;
+  std::string m_stableKey;
+  int m_stableSamples = 0;
 
   std::string m_currentAction;
   std::string m_currentGestureName;
   std::string m_lastAppName;
+
+  // Foreground tracking, resolved once per foreground change
+  HWND m_foregroundHwnd = nullptr;
+  std::string m_foregroundApp;
+  bool m_foregroundBlacklisted = false;
+  unsigned m_blacklistGeneration = 0;
 };
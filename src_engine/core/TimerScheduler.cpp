@@ -0,0 +1,140 @@
+#include "TimerScheduler.h"
+#include <algorithm>
+#include <chrono>
+
+TimerScheduler::Clock TimerScheduler::SteadyClock() {
+  return []() -> uint64_t {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  };
+}
+
+TimerScheduler::TimerScheduler(Clock clock)
+    : m_clock(std::move(clock)), m_wheel(kSlots) {
+  m_lastTick = m_clock();
+}
+
+TimerScheduler::Handle TimerScheduler::Once(uint32_t delayMs, Callback cb) {
+  return Schedule(delayMs, 0, std::move(cb));
+}
+
+TimerScheduler::Handle TimerScheduler::Every(uint32_t intervalMs,
+                                             Callback cb) {
+  if (intervalMs == 0)
+    intervalMs = 1;
+  return Schedule(intervalMs, intervalMs, std::move(cb));
+}
+
+TimerScheduler::Handle TimerScheduler::Schedule(uint32_t delayMs,
+                                                uint32_t intervalMs,
+                                                Callback cb) {
+  Handle handle = m_nextHandle++;
+  Timer &timer = m_timers[handle];
+  timer.deadline = m_clock() + delayMs;
+  timer.interval = intervalMs;
+  timer.cb = std::move(cb);
+  Place(handle, timer.deadline);
+  return handle;
+}
+
+void TimerScheduler::Place(Handle handle, uint64_t deadline) {
+  m_wheel[deadline % kSlots].push_back(handle);
+  if (deadline < m_earliest)
+    m_earliest = deadline;
+}
+
+void TimerScheduler::Cancel(Handle &handle) {
+  if (handle == 0)
+    return;
+  auto it = m_timers.find(handle);
+  if (it != m_timers.end()) {
+    if (it->second.deadline == m_earliest)
+      m_earliestDirty = true;
+    m_timers.erase(it);
+  }
+  handle = 0;
+}
+
+bool TimerScheduler::IsActive(Handle handle) const {
+  return handle != 0 && m_timers.count(handle) != 0;
+}
+
+void TimerScheduler::Advance() {
+  uint64_t now = m_clock();
+  if (now < m_lastTick)
+    return;
+
+  // Visit each slot between the last tick and now once; a full turn covers
+  // every slot, so long idle gaps cost at most kSlots steps. The current
+  // tick is revisited next time since zero-delay timers may still land in it.
+  uint64_t steps = std::min<uint64_t>(now - m_lastTick + 1, kSlots);
+  uint64_t tick = m_lastTick;
+  m_lastTick = now;
+
+  std::vector<Handle> due;
+  for (uint64_t i = 0; i < steps; ++i, ++tick) {
+    std::vector<Handle> &slot = m_wheel[tick % kSlots];
+    if (slot.empty())
+      continue;
+
+    size_t keep = 0;
+    for (Handle handle : slot) {
+      auto it = m_timers.find(handle);
+      if (it == m_timers.end())
+        continue; // cancelled
+      if (it->second.deadline <= now) {
+        due.push_back(handle);
+      } else {
+        slot[keep++] = handle; // a later lap
+      }
+    }
+    slot.resize(keep);
+  }
+
+  if (due.empty())
+    return;
+
+  m_earliestDirty = true;
+  std::sort(due.begin(), due.end(), [this](Handle a, Handle b) {
+    return m_timers[a].deadline < m_timers[b].deadline;
+  });
+
+  for (Handle handle : due) {
+    // Earlier callbacks may cancel later ones
+    auto it = m_timers.find(handle);
+    if (it == m_timers.end())
+      continue;
+
+    Callback cb = it->second.cb;
+    if (it->second.interval) {
+      Timer &timer = it->second;
+      timer.deadline += timer.interval;
+      if (timer.deadline <= now)
+        timer.deadline = now + timer.interval; // skip missed periods
+      Place(handle, timer.deadline);
+    } else {
+      m_timers.erase(it);
+    }
+    cb();
+  }
+}
+
+uint32_t TimerScheduler::NextTimeout() const {
+  if (m_timers.empty())
+    return kNoTimeout;
+
+  if (m_earliestDirty) {
+    m_earliest = UINT64_MAX;
+    for (const auto &entry : m_timers) {
+      m_earliest = std::min(m_earliest, entry.second.deadline);
+    }
+    m_earliestDirty = false;
+  }
+
+  uint64_t now = m_clock();
+  if (m_earliest <= now)
+    return 0;
+  uint64_t wait = m_earliest - now;
+  return wait >= kNoTimeout ? kNoTimeout - 1 : (uint32_t)wait;
+}
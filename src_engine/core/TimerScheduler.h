@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// Single-threaded hashed timer wheel driving every engine timer.
+// The owner calls Advance() after pumping messages and sleeps for at most
+// NextTimeout() ms, so when no timer is armed the thread never wakes up.
+// Time comes from a pluggable clock so tests can drive it virtually.
+class TimerScheduler {
+public:
+  using Clock = std::function<uint64_t()>; // milliseconds, monotonic
+  using Callback = std::function<void()>;
+  using Handle = uint64_t;                 // 0 is never a valid handle
+
+  static constexpr uint32_t kNoTimeout = 0xFFFFFFFF; // == INFINITE
+
+  explicit TimerScheduler(Clock clock = SteadyClock());
+
+  Handle Once(uint32_t delayMs, Callback cb);
+  Handle Every(uint32_t intervalMs, Callback cb);
+
+  // Cancels the timer and resets the handle. Safe on 0 or expired handles.
+  void Cancel(Handle &handle);
+  bool IsActive(Handle handle) const;
+
+  // Fires every timer whose deadline has passed
+  void Advance();
+  // Milliseconds until the next deadline, kNoTimeout when nothing is armed
+  uint32_t NextTimeout() const;
+
+  uint64_t Now() const { return m_clock(); }
+  size_t ActiveCount() const { return m_timers.size(); }
+
+  static Clock SteadyClock();
+
+private:
+  static constexpr uint32_t kSlots = 256; // 1 ms per slot
+
+  struct Timer {
+    uint64_t deadline = 0;
+    uint32_t interval = 0; // 0 = one-shot
+    Callback cb;
+  };
+
+  Handle Schedule(uint32_t delayMs, uint32_t intervalMs, Callback cb);
+  void Place(Handle handle, uint64_t deadline);
+
+  Clock m_clock;
+  uint64_t m_lastTick = 0;
+  Handle m_nextHandle = 1;
+
+  std::unordered_map<Handle, Timer> m_timers;
+  // Slots hold handles only; cancelled handles are dropped lazily
+  std::vector<std::vector<Handle>> m_wheel;
+
+  mutable uint64_t m_earliest = UINT64_MAX;
+  mutable bool m_earliestDirty = false;
+};
@@ -0,0 +1,65 @@
+#include "TraceRecorder.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+TraceRecorder::TraceRecorder() {
+  m_origin = std::chrono::duration_cast<std::chrono::microseconds>(
+                 std::chrono::steady_clock::now().time_since_epoch())
+                 .count();
+}
+
+uint64_t TraceRecorder::NowUs() const {
+  int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count();
+  return (uint64_t)(now - m_origin);
+}
+
+void TraceRecorder::Enable(const std::string &outputPath) {
+  m_outputPath = outputPath;
+  m_events.reserve(256);
+}
+
+void TraceRecorder::Record(const char *name, uint64_t startUs,
+                           uint64_t durationUs) {
+  if (!Enabled() || m_events.size() >= kMaxEvents)
+    return;
+  m_events.push_back({name, startUs, durationUs, false});
+}
+
+void TraceRecorder::Instant(const char *name) {
+  if (!Enabled() || m_events.size() >= kMaxEvents)
+    return;
+  m_events.push_back({name, NowUs(), 0, true});
+}
+
+bool TraceRecorder::Dump() const {
+  if (!Enabled())
+    return false;
+
+  json events = json::array();
+  for (const auto &e : m_events) {
+    json ev = {{"name", e.name}, {"cat", "engine"}, {"ts", e.startUs},
+               {"pid", 1},       {"tid", 1}};
+    if (e.instant) {
+      ev["ph"] = "i";
+      ev["s"] = "t";
+    } else {
+      ev["ph"] = "X";
+      ev["dur"] = e.durationUs;
+    }
+    events.push_back(std::move(ev));
+  }
+
+  std::ofstream o(m_outputPath, std::ios::trunc);
+  if (!o) {
+    std::cerr << "[Trace] Cannot write " << m_outputPath << std::endl;
+    return false;
+  }
+  o << json{{"traceEvents", events}, {"displayTimeUnit", "ms"}} << std::endl;
+  return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Lightweight phase tracer for the engine thread.
+// Disabled unless started with --trace=<file>; when enabled, recorded spans
+// are written as Chrome trace JSON (load in chrome://tracing or Perfetto).
+class TraceRecorder {
+public:
+  static TraceRecorder &Get() {
+    static TraceRecorder instance;
+    return instance;
+  }
+
+  void Enable(const std::string &outputPath);
+  bool Enabled() const { return !m_outputPath.empty(); }
+
+  void Record(const char *name, uint64_t startUs, uint64_t durationUs);
+  void Instant(const char *name);
+
+  // Rewrites the output file with everything recorded so far
+  bool Dump() const;
+
+  // Microseconds since process start of tracing
+  uint64_t NowUs() const;
+
+private:
+  TraceRecorder();
+
+  struct Event {
+    const char *name; // string literals only
+    uint64_t startUs;
+    uint64_t durationUs;
+    bool instant;
+  };
+
+  static constexpr size_t kMaxEvents = 16384;
+
+  std::string m_outputPath;
+  std::vector<Event> m_events;
+  int64_t m_origin = 0;
+};
+
+// Records the enclosing scope as one complete ("X") event
+class TraceScope {
+public:
+  explicit TraceScope(const char *name)
+      : m_name(name), m_start(TraceRecorder::Get().NowUs()) {}
+  ~TraceScope() {
+    TraceRecorder &trace = TraceRecorder::Get();
+    trace.Record(m_name, m_start, trace.NowUs() - m_start);
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  const char *m_name;
+  uint64_t m_start;
+};
@@ -19,14 +19,16 @@ void InputWindow::Initialize() {
 
   CreateWindows();
   UpdateLayout();
-
-  // Start watchdog timer to restore windows if hidden by system/win+D
-  if (m_hwndLeft) {
-    SetTimer(m_hwndLeft, TIMER_WATCHDOG, WATCHDOG_INTERVAL_MS, nullptr);
-  }
 }
 
 void InputWindow::Shutdown() {
+  if (m_scheduler) {
+    for (EdgeState *state : {&m_leftState, &m_rightState}) {
+      m_scheduler->Cancel(state->hoverTimer);
+      m_scheduler->Cancel(state->recoveryTimer);
+    }
+    m_scheduler->Cancel(m_watchdogTimer);
+  }
   if (m_hwndLeft) {
     DestroyWindow(m_hwndLeft);
     m_hwndLeft = nullptr;
@@ -133,6 +135,67 @@ bool InputWindow::IsTouchInput() {
   return false;
 }
 
+void InputWindow::ArmWatchdog() {
+  // Restores windows if hidden by system/win+D. Event driven rather than
+  // periodic so an idle engine never wakes up.
+  if (!m_scheduler || m_scheduler->IsActive(m_watchdogTimer))
+    return;
+  m_watchdogTimer = m_scheduler->Once(WATCHDOG_DELAY_MS, [this]() {
+    m_watchdogTimer = 0;
+    RunWatchdog();
+  });
+}
+
+void InputWindow::OnHoverTimeout(HWND hWnd) {
+  // Timeout reached: User is staring at the edge/aiming for scrollbar
+  EdgeState &state = StateOf(hWnd);
+  state.hoverTimer = 0;
+  state.isHovering = false;
+
+  // ACTION: Suppress the window (Hide it). Flag it first: the synchronous
+  // WM_WINDOWPOSCHANGED must see this hide as intended.
+  state.isSuppressed = true;
+  ShowWindow(hWnd, SW_HIDE);
+
+  // Schedule Recovery
+  if (m_scheduler) {
+    m_scheduler->Cancel(state.recoveryTimer);
+    state.recoveryTimer = m_scheduler->Once(
+        RECOVERY_DELAY_MS, [this, hWnd]() { OnRecovery(hWnd); });
+  }
+
+  std::cout << "[InputWindow] Auto-yield triggered (Suppressed)" << std::endl;
+}
+
+void InputWindow::OnRecovery(HWND hWnd) {
+  // Timeout reached: Bring the window back
+  EdgeState &state = StateOf(hWnd);
+  state.recoveryTimer = 0;
+  state.isSuppressed = false;
+
+  // Restore visibility (No Activate to prevent stealing focus)
+  ShowWindow(hWnd, SW_SHOWNOACTIVATE);
+
+  std::cout << "[InputWindow] Window recovered" << std::endl;
+}
+
+void InputWindow::RunWatchdog() {
+  // Watchdog: Check if windows are unexpectedly hidden (e.g., by Win+D)
+  // Only restore if not intentionally suppressed by hover logic
+  AppConfig &cfg = ConfigManager::Get().Current();
+
+  if (m_hwndLeft && cfg.left.enabled && !m_leftState.isSuppressed &&
+      !IsWindowVisible(m_hwndLeft)) {
+    ShowWindow(m_hwndLeft, SW_SHOWNOACTIVATE);
+    std::cout << "[InputWindow] Watchdog restored left window" << std::endl;
+  }
+  if (m_hwndRight && cfg.right.enabled && !m_rightState.isSuppressed &&
+      !IsWindowVisible(m_hwndRight)) {
+    ShowWindow(m_hwndRight, SW_SHOWNOACTIVATE);
+    std::cout << "[InputWindow] Watchdog restored right window" << std::endl;
+  }
+}
+
 LRESULT CALLBACK InputWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam,
                                       LPARAM lParam) {
   InputWindow *pThis = nullptr;
@@ -151,9 +214,11 @@ LRESULT CALLBACK InputWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam,
     // --- 1. Gesture Initiation (The "Fast Action") ---
     case WM_LBUTTONDOWN: {
       // If the user clicks immediately, we cancel any suppression logic
-      if (pThis->m_isHovering) {
-        KillTimer(hWnd, TIMER_HOVER_CHECK);
-        pThis->m_isHovering = false;
+      EdgeState &state = pThis->StateOf(hWnd);
+      if (state.isHovering) {
+        if (pThis->m_scheduler)
+          pThis->m_scheduler->Cancel(state.hoverTimer);
+        state.isHovering = false;
       }
 
       pThis->m_isDragging = true;
@@ -183,8 +248,9 @@ LRESULT CALLBACK InputWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam,
           pThis->OnUpdate(pt.x, pt.y);
       } else {
         // Logic: User is hovering but hasn't clicked yet
-        if (!pThis->m_isHovering) {
-          pThis->m_isHovering = true;
+        EdgeState &state = pThis->StateOf(hWnd);
+        if (!state.isHovering) {
+          state.isHovering = true;
 
           // Request notification when mouse leaves this window
           TRACKMOUSEEVENT tme;
@@ -194,7 +260,12 @@ LRESULT CALLBACK InputWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam,
           TrackMouseEvent(&tme);
 
           // Start the countdown: If user doesn't click in X ms, hide window
-          SetTimer(hWnd, TIMER_HOVER_CHECK, pThis->HOVER_THRESHOLD_MS, nullptr);
+          if (pThis->m_scheduler) {
+            pThis->m_scheduler->Cancel(state.hoverTimer);
+            state.hoverTimer = pThis->m_scheduler->Once(
+                pThis->HOVER_THRESHOLD_MS,
+                [pThis, hWnd]() { pThis->OnHoverTimeout(hWnd); });
+          }
         }
       }
       break;
@@ -202,55 +273,19 @@ LRESULT CALLBACK InputWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam,
 
     // --- 3. Mouse Left the Window (Cancel Check) ---
     case WM_MOUSELEAVE: {
-      pThis->m_isHovering = false;
-      KillTimer(hWnd, TIMER_HOVER_CHECK);
+      EdgeState &state = pThis->StateOf(hWnd);
+      state.isHovering = false;
+      if (pThis->m_scheduler)
+        pThis->m_scheduler->Cancel(state.hoverTimer);
       break;
     }
 
-    // --- 4. Timer Logic (Suppression & Recovery) ---
-    case WM_TIMER: {
-      if (wParam == TIMER_HOVER_CHECK) {
-        // Timeout reached: User is staring at the edge/aiming for scrollbar
-        KillTimer(hWnd, TIMER_HOVER_CHECK);
-        pThis->m_isHovering = false;
-
-        // ACTION: Suppress the window (Hide it)
-        ShowWindow(hWnd, SW_HIDE);
-        pThis->m_isSuppressed = true;
-
-        // Schedule Recovery
-        SetTimer(hWnd, TIMER_RECOVERY, pThis->RECOVERY_DELAY_MS, nullptr);
-
-        std::cout << "[InputWindow] Auto-yield triggered (Suppressed)"
-                  << std::endl;
-      } else if (wParam == TIMER_RECOVERY) {
-        // Timeout reached: Bring the window back
-        KillTimer(hWnd, TIMER_RECOVERY);
-        pThis->m_isSuppressed = false;
-
-        // Restore visibility (No Activate to prevent stealing focus)
-        ShowWindow(hWnd, SW_SHOWNOACTIVATE);
-
-        std::cout << "[InputWindow] Window recovered" << std::endl;
-      } else if (wParam == TIMER_WATCHDOG) {
-        // Watchdog: Check if windows are unexpectedly hidden (e.g., by Win+D)
-        // Only restore if not intentionally suppressed by hover logic
-        AppConfig &cfg = ConfigManager::Get().Current();
-
-        if (!pThis->m_isSuppressed) {
-          if (pThis->m_hwndLeft && cfg.left.enabled &&
-              !IsWindowVisible(pThis->m_hwndLeft)) {
-            ShowWindow(pThis->m_hwndLeft, SW_SHOWNOACTIVATE);
-            std::cout << "[InputWindow] Watchdog restored left window"
-                      << std::endl;
-          }
-          if (pThis->m_hwndRight && cfg.right.enabled &&
-              !IsWindowVisible(pThis->m_hwndRight)) {
-            ShowWindow(pThis->m_hwndRight, SW_SHOWNOACTIVATE);
-            std::cout << "[InputWindow] Watchdog restored right window"
-                      << std::endl;
-          }
-        }
+    // --- 4. Hidden behind our back (Win+D, explorer restarts) ---
+    case WM_WINDOWPOSCHANGED: {
+      WINDOWPOS *pos = (WINDOWPOS *)lParam;
+      if ((pos->flags & SWP_HIDEWINDOW) &&
+          !pThis->StateOf(hWnd).isSuppressed) {
+        pThis->ArmWatchdog();
       }
       break;
     }
@@ -270,11 +305,7 @@ LRESULT CALLBACK InputWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam,
       pThis->UpdateLayout();
       break;
     }
-    case WM_USER + 101: {
-      ConfigManager::Get().Load();
-      pThis->UpdateLayout();
-      break;
-    }
+    // WM_USER + 101 (config changed) is handled once by EngineCore's loop
     case WM_USER + 102: {
       // Preview Mode: wParam = 0 (Off), 1 (Left), 2 (Right)
       pThis->m_previewMode = (int)wParam;
@@ -1,4 +1,5 @@
 #pragma once
+#include "core/TimerScheduler.h"
 #include <functional>
 #include <windows.h>
 
@@ -26,6 +27,12 @@ public:
   // resolution
   void UpdateLayout();
 
+  // Engine-owned scheduler used for hover, recovery and watchdog timers
+  void SetScheduler(TimerScheduler *scheduler) { m_scheduler = scheduler; }
+
+  // Schedules a one-shot check that restores overlays hidden by the system
+  void ArmWatchdog();
+
 private:
   InputWindow();
   ~InputWindow();
@@ -39,6 +46,22 @@ private:
   // Check if the current message event comes from Touch
   bool IsTouchInput();
 
+  // Hover/suppression state, kept per overlay so one edge never cancels
+  // or masks the other's recovery
+  struct EdgeState {
+    bool isHovering = false;
+    bool isSuppressed = false; // True if hidden due to hover
+    TimerScheduler::Handle hoverTimer = 0;
+    TimerScheduler::Handle recoveryTimer = 0;
+  };
+  EdgeState &StateOf(HWND hWnd) {
+    return hWnd == m_hwndLeft ? m_leftState : m_rightState;
+  }
+
+  void OnHoverTimeout(HWND hWnd);
+  void OnRecovery(HWND hWnd);
+  void RunWatchdog();
+
   HWND m_hwndLeft = nullptr;
   HWND m_hwndRight = nullptr;
   int m_previewMode = 0; // 0=None, 1=Left, 2=Right
@@ -51,16 +74,15 @@ private:
   bool m_isDragging = false;
 
   // --- Dynamic Adjustment Members ---
-  bool m_isHovering = false;
-  bool m_isSuppressed = false; // True if window is currently hidden due to hover
+  EdgeState m_leftState;
+  EdgeState m_rightState;
 
-  // Timer Identifiers
-  static const UINT_PTR TIMER_HOVER_CHECK = 1001;
-  static const UINT_PTR TIMER_RECOVERY = 1002;
-  static const UINT_PTR TIMER_WATCHDOG = 1003;
+  // Timers
+  TimerScheduler *m_scheduler = nullptr;
+  TimerScheduler::Handle m_watchdogTimer = 0;
 
   // Configuration Constants (Consider moving to ConfigManager later)
-  const UINT HOVER_THRESHOLD_MS = 400;    // Time before window hides
-  const UINT RECOVERY_DELAY_MS = 2000;    // Time before window reappears
-  const UINT WATCHDOG_INTERVAL_MS = 2000; // Watchdog check interval
+  const UINT HOVER_THRESHOLD_MS = 400; // Time before window hides
+  const UINT RECOVERY_DELAY_MS = 2000; // Time before window reappears
+  const UINT WATCHDOG_DELAY_MS = 2000; // Watchdog check after a hide event
 };
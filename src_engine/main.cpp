@@ -3,7 +3,10 @@
 #endif
 
 #include "core/EngineCore.h"
+#include "core/TraceRecorder.h"
+#include <filesystem>
 #include <iostream>
+#include <shellapi.h>
 
 void InitConsole() {
   AllocConsole();
@@ -14,7 +17,27 @@ void InitConsole() {
   std::cout << "[INFO] EdgeGesture Engine Starting..." << std::endl;
 }
 
+// --trace=<file> records startup phases as Chrome trace JSON
+static void ParseCommandLine() {
+  int argc = 0;
+  LPWSTR *argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+  if (!argv)
+    return;
+
+  const std::wstring traceFlag = L"--trace=";
+  for (int i = 1; i < argc; i++) {
+    std::wstring arg = argv[i];
+    if (arg.rfind(traceFlag, 0) == 0 && arg.size() > traceFlag.size()) {
+      std::filesystem::path path(arg.substr(traceFlag.size()));
+      TraceRecorder::Get().Enable(path.string());
+    }
+  }
+  LocalFree(argv);
+}
+
 int APIENTRY wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int) {
+  ParseCommandLine();
+
   // Only allow one instance
   HANDLE hMutex = CreateMutex(NULL, TRUE, L"EdgeGestureEngineMutex");
   if (GetLastError() == ERROR_ALREADY_EXISTS) {
@@ -0,0 +1,149 @@
+// Checks BlacklistMatcher against the old linear scan and times both at
+// 10, 1,000 and 10,000 entries. Run through ctest; the timings are printed,
+// only wrong answers fail.
+#include "core/BlacklistMatcher.h"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static int s_failures = 0;
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__,    \
+                   #cond);                                                     \
+      ++s_failures;                                                            \
+    }                                                                          \
+  } while (0)
+
+// What IsBlacklistedAppActive did before: _stricmp over every entry
+static bool LinearMatches(const std::vector<std::string> &entries,
+                          const std::string &exeName) {
+  for (const auto &entry : entries) {
+    if (entry.size() != exeName.size())
+      continue;
+    size_t i = 0;
+    while (i < entry.size() &&
+           std::tolower((unsigned char)entry[i]) ==
+               std::tolower((unsigned char)exeName[i]))
+      ++i;
+    if (i == entry.size())
+      return true;
+  }
+  return false;
+}
+
+static void TestMatching() {
+  BlacklistMatcher matcher;
+  CHECK(matcher.Empty());
+  CHECK(!matcher.Matches("notepad.exe"));
+
+  matcher.Compile({"Game.exe", "steam*", "mstsc?.exe", "*launcher*.exe", ""});
+  CHECK(!matcher.Empty());
+  CHECK(matcher.Matches("game.exe"));
+  CHECK(matcher.Matches("GAME.EXE"));
+  CHECK(!matcher.Matches("game.exe.bak"));
+  CHECK(matcher.Matches("steam.exe"));
+  CHECK(matcher.Matches("SteamWebHelper.exe"));
+  CHECK(!matcher.Matches("stea.exe"));
+  CHECK(matcher.Matches("mstsc2.exe"));
+  CHECK(!matcher.Matches("mstsc.exe"));
+  CHECK(matcher.Matches("EpicGamesLauncher.exe"));
+  CHECK(matcher.Matches("launcher.exe"));
+  CHECK(!matcher.Matches("explorer.exe"));
+  CHECK(!matcher.Matches(""));
+
+  // A bare "*" blacklists everything
+  matcher.Compile({"*"});
+  CHECK(matcher.Matches("explorer.exe"));
+
+  matcher.Clear();
+  CHECK(matcher.Empty());
+  CHECK(!matcher.Matches("game.exe"));
+}
+
+static void TestGlob() {
+  CHECK(BlacklistMatcher::GlobMatch("*", ""));
+  CHECK(BlacklistMatcher::GlobMatch("a*b*c", "axxbyyc"));
+  CHECK(!BlacklistMatcher::GlobMatch("a*b*c", "axxbyy"));
+  CHECK(BlacklistMatcher::GlobMatch("a?c", "abc"));
+  CHECK(!BlacklistMatcher::GlobMatch("a?c", "ac"));
+  CHECK(BlacklistMatcher::GlobMatch("*.exe", "x.exe.exe"));
+}
+
+// A fleet-like list: mostly exact names, a few launcher families and globs
+static std::vector<std::string> MakeEntries(int count) {
+  std::vector<std::string> entries;
+  entries.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    if (i % 50 == 1)
+      entries.push_back("Launcher" + std::to_string(i) + "*");
+    else if (i % 500 == 2)
+      entries.push_back("*remote" + std::to_string(i) + "?.exe");
+    else
+      entries.push_back("App" + std::to_string(i) + ".exe");
+  }
+  return entries;
+}
+
+template <typename Fn> static double NsPerCall(int calls, Fn &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < calls; ++i)
+    fn(i);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / calls;
+}
+
+static void Benchmark(int count) {
+  const std::vector<std::string> entries = MakeEntries(count);
+  BlacklistMatcher matcher;
+  auto start = std::chrono::steady_clock::now();
+  matcher.Compile(entries);
+  double compileUs = std::chrono::duration<double, std::micro>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+  // Foreground apps that are not listed (the common case) and some that are
+  const std::vector<std::string> misses = {"explorer.exe", "Code.exe",
+                                           "chrome.exe", "WindowsTerminal.exe"};
+  const std::string hit = "APP" + std::to_string(count - 1) + ".EXE";
+  CHECK(matcher.Matches(hit) == LinearMatches(entries, hit));
+  for (const auto &miss : misses)
+    CHECK(!matcher.Matches(miss) && !LinearMatches(entries, miss));
+
+  const int calls = 200000;
+  volatile bool sink = false;
+  double missNs = NsPerCall(calls, [&](int i) {
+    sink = matcher.Matches(misses[i % misses.size()]);
+  });
+  double hitNs = NsPerCall(calls, [&](int) { sink = matcher.Matches(hit); });
+  // The linear scan is only worth a fraction of the calls at large counts
+  const int linearCalls = count >= 10000 ? 2000 : 20000;
+  double linearNs = NsPerCall(linearCalls, [&](int i) {
+    sink = LinearMatches(entries, misses[i % misses.size()]);
+  });
+  (void)sink;
+
+  std::printf("%6d entries: compile %8.1f us, miss %7.1f ns, hit %7.1f ns, "
+              "linear miss %10.1f ns\n",
+              count, compileUs, missNs, hitNs, linearNs);
+}
+
+int main() {
+  TestMatching();
+  TestGlob();
+
+  for (int count : {10, 1000, 10000})
+    Benchmark(count);
+
+  if (s_failures) {
+    std::fprintf(stderr, "%d check(s) failed\n", s_failures);
+    return EXIT_FAILURE;
+  }
+  std::puts("BlacklistMatcher: all checks passed");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+// Drives TimerScheduler with a fake clock: no sleeping, time moves only when
+// the test says so.
+#include "core/TimerScheduler.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static int s_failures = 0;
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__,    \
+                   #cond);                                                     \
+      ++s_failures;                                                            \
+    }                                                                          \
+  } while (0)
+
+struct FakeClock {
+  uint64_t now = 1000;
+  TimerScheduler::Clock clock() {
+    return [this]() { return now; };
+  }
+};
+
+static void TestOnceFiresAtDeadline() {
+  FakeClock time;
+  TimerScheduler scheduler(time.clock());
+  int fired = 0;
+  TimerScheduler::Handle handle = scheduler.Once(400, [&]() { ++fired; });
+
+  CHECK(scheduler.IsActive(handle));
+  CHECK(scheduler.NextTimeout() == 400);
+
+  time.now += 399;
+  scheduler.Advance();
+  CHECK(fired == 0);
+  CHECK(scheduler.NextTimeout() == 1);
+
+  time.now += 1;
+  scheduler.Advance();
+  CHECK(fired == 1);
+  CHECK(!scheduler.IsActive(handle));
+  CHECK(scheduler.NextTimeout() == TimerScheduler::kNoTimeout);
+
+  // One-shot: never again
+  time.now += 5000;
+  scheduler.Advance();
+  CHECK(fired == 1);
+}
+
+static void TestCancel() {
+  FakeClock time;
+  TimerScheduler scheduler(time.clock());
+  int fired = 0;
+  TimerScheduler::Handle handle = scheduler.Once(100, [&]() { ++fired; });
+
+  scheduler.Cancel(handle);
+  CHECK(handle == 0);
+  CHECK(scheduler.ActiveCount() == 0);
+  CHECK(scheduler.NextTimeout() == TimerScheduler::kNoTimeout);
+
+  time.now += 200;
+  scheduler.Advance();
+  CHECK(fired == 0);
+
+  // Cancelling a reset or expired handle is harmless
+  scheduler.Cancel(handle);
+  TimerScheduler::Handle expired = scheduler.Once(0, []() {});
+  scheduler.Advance();
+  scheduler.Cancel(expired);
+  CHECK(expired == 0);
+}
+
+static void TestRescheduleReplacesDeadline() {
+  // The hover pattern: cancel the pending timer and arm a fresh one
+  FakeClock time;
+  TimerScheduler scheduler(time.clock());
+  std::vector<int> fired;
+  TimerScheduler::Handle handle = scheduler.Once(400, [&]() {
+    fired.push_back(1);
+  });
+
+  time.now += 300;
+  scheduler.Advance();
+  scheduler.Cancel(handle);
+  handle = scheduler.Once(400, [&]() { fired.push_back(2); });
+  CHECK(scheduler.NextTimeout() == 400);
+
+  time.now += 100; // the first deadline passes
+  scheduler.Advance();
+  CHECK(fired.empty());
+
+  time.now += 300;
+  scheduler.Advance();
+  CHECK(fired.size() == 1 && fired[0] == 2);
+  CHECK(!scheduler.IsActive(handle));
+}
+
+static void TestIndependentTimers() {
+  // Cancelling one timer leaves the others alone, e.g. one edge's hover
+  // must not drop the other edge's recovery
+  FakeClock time;
+  TimerScheduler scheduler(time.clock());
+  int left = 0;
+  int right = 0;
+  TimerScheduler::Handle leftRecovery = scheduler.Once(2000, [&]() { ++left; });
+  TimerScheduler::Handle rightHover = scheduler.Once(400, [&]() { ++right; });
+
+  scheduler.Cancel(rightHover);
+  time.now += 2000;
+  scheduler.Advance();
+  CHECK(left == 1);
+  CHECK(right == 0);
+  CHECK(!scheduler.IsActive(leftRecovery));
+}
+
+static void TestOrderAndLongDelays() {
+  // Deadlines further out than one turn of the wheel, fired in order even
+  // after a long idle gap
+  FakeClock time;
+  TimerScheduler scheduler(time.clock());
+  std::vector<int> order;
+  scheduler.Once(700, [&]() { order.push_back(700); });
+  scheduler.Once(5, [&]() { order.push_back(5); });
+  scheduler.Once(300, [&]() { order.push_back(300); });
+
+  time.now += 10;
+  scheduler.Advance();
+  CHECK(order.size() == 1 && order[0] == 5);
+
+  time.now += 10000;
+  scheduler.Advance();
+  CHECK(order.size() == 3 && order[1] == 300 && order[2] == 700);
+}
+
+static void TestEvery() {
+  FakeClock time;
+  TimerScheduler scheduler(time.clock());
+  int ticks = 0;
+  TimerScheduler::Handle handle = scheduler.Every(100, [&]() { ++ticks; });
+
+  for (int i = 0; i < 5; ++i) {
+    time.now += 100;
+    scheduler.Advance();
+  }
+  CHECK(ticks == 5);
+
+  // Missed periods are skipped, not replayed
+  time.now += 1000;
+  scheduler.Advance();
+  CHECK(ticks == 6);
+  CHECK(scheduler.NextTimeout() == 100);
+
+  scheduler.Cancel(handle);
+  time.now += 1000;
+  scheduler.Advance();
+  CHECK(ticks == 6);
+}
+
+static void TestCallbackCancelsLaterTimer() {
+  FakeClock time;
+  TimerScheduler scheduler(time.clock());
+  int fired = 0;
+  TimerScheduler::Handle second = 0;
+  scheduler.Once(10, [&]() { scheduler.Cancel(second); });
+  second = scheduler.Once(20, [&]() { ++fired; });
+
+  time.now += 50;
+  scheduler.Advance();
+  CHECK(fired == 0);
+  CHECK(scheduler.ActiveCount() == 0);
+}
+
+int main() {
+  TestOnceFiresAtDeadline();
+  TestCancel();
+  TestRescheduleReplacesDeadline();
+  TestIndependentTimers();
+  TestOrderAndLongDelays();
+  TestEvery();
+  TestCallbackCancelsLaterTimer();
+
+  if (s_failures) {
+    std::fprintf(stderr, "%d check(s) failed\n", s_failures);
+    return EXIT_FAILURE;
+  }
+  std::puts("TimerScheduler: all checks passed");
+  return EXIT_SUCCESS;
+}
@@ -1,17 +1,11 @@
 #include "Visualizer.h"
+#include "core/TraceRecorder.h"
 #include <iostream>
 
 Visualizer::Visualizer() {}
 
 Visualizer::~Visualizer() {
-  if (m_pWaveBrush)
-    m_pWaveBrush->Release();
-  if (m_pActiveBrush)
-    m_pActiveBrush->Release();
-  if (m_pArrowBrush)
-    m_pArrowBrush->Release();
-  if (m_pDCRT)
-    m_pDCRT->Release();
+  DiscardResources();
   if (m_pD2DFactory)
     m_pD2DFactory->Release();
   if (m_hwnd)
@@ -20,21 +14,21 @@ Visualizer::~Visualizer() {
 
 LRESULT CALLBACK Visualizer::WndProc(HWND hWnd, UINT message, WPARAM wParam,
                                      LPARAM lParam) {
-  if (message == WM_TIMER) {
-    Visualizer *pThis = (Visualizer *)GetWindowLongPtr(hWnd, GWLP_USERDATA);
-    if (pThis && pThis->m_onTimer) {
-      pThis->m_onTimer();
-    }
-    return 0;
-  } else if (message == WM_USER + 101) {
-    ConfigManager::Get().Load();
-    return 0;
-  }
   return DefWindowProc(hWnd, message, wParam, lParam);
 }
 
 bool Visualizer::Init(int screenW, int screenH) {
   m_screenHeight = screenH;
+  return true;
+}
+
+bool Visualizer::EnsureCreated() {
+  if (m_hwnd)
+    return true;
+  if (m_createFailed)
+    return false;
+
+  TraceScope trace("Visualizer::EnsureCreated");
 
   WNDCLASSEXW wcex = {sizeof(WNDCLASSEX)};
   wcex.lpfnWndProc = WndProc;
@@ -49,15 +43,19 @@ bool Visualizer::Init(int screenW, int screenH) {
                            m_screenHeight, nullptr, nullptr,
                            GetModuleHandle(NULL), this);
 
-  if (!m_hwnd)
+  if (!m_hwnd) {
+    m_createFailed = true;
     return false;
+  }
 
   SetWindowLongPtr(m_hwnd, GWLP_USERDATA, (LONG_PTR)this);
 
   HRESULT hr =
       D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, &m_pD2DFactory);
-  if (FAILED(hr))
+  if (FAILED(hr)) {
+    m_createFailed = true;
     return false;
+  }
 
   CreateResources();
   return true;
@@ -69,13 +67,64 @@ void Visualizer::CreateResources() {
         D2D1_RENDER_TARGET_TYPE_DEFAULT,
         D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM,
                           D2D1_ALPHA_MODE_PREMULTIPLIED));
-    m_pD2DFactory->CreateDCRenderTarget(&props, &m_pDCRT);
+    if (FAILED(m_pD2DFactory->CreateDCRenderTarget(&props, &m_pDCRT)))
+      return;
+  }
+
+  // Brushes live as long as the render target; only their colour changes
+  if (!m_pWaveBrush) {
+    m_pDCRT->CreateSolidColorBrush(D2D1::ColorF(0, 0, 0, 0.5f), &m_pWaveBrush);
+    m_brushColor = CLR_INVALID;
+  }
+  if (!m_pActiveBrush) {
+    m_pDCRT->CreateSolidColorBrush(D2D1::ColorF(0, 0, 0, 0.8f),
+                                   &m_pActiveBrush);
+    m_brushColor = CLR_INVALID;
+  }
+  if (!m_pArrowBrush) {
+    m_pDCRT->CreateSolidColorBrush(D2D1::ColorF(1.0f, 1.0f, 1.0f, 0.9f),
+                                   &m_pArrowBrush);
+  }
+}
+
+void Visualizer::DiscardResources() {
+  if (m_pWaveBrush) {
+    m_pWaveBrush->Release();
+    m_pWaveBrush = nullptr;
   }
+  if (m_pActiveBrush) {
+    m_pActiveBrush->Release();
+    m_pActiveBrush = nullptr;
+  }
+  if (m_pArrowBrush) {
+    m_pArrowBrush->Release();
+    m_pArrowBrush = nullptr;
+  }
+  if (m_pDCRT) {
+    m_pDCRT->Release();
+    m_pDCRT = nullptr;
+  }
+  m_brushColor = CLR_INVALID;
+}
+
+void Visualizer::UpdateBrushColor(COLORREF color) {
+  if (color == m_brushColor || !m_pWaveBrush || !m_pActiveBrush)
+    return;
+
+  float r = GetRValue(color) / 255.0f;
+  float g = GetGValue(color) / 255.0f;
+  float b = GetBValue(color) / 255.0f;
+  m_pWaveBrush->SetColor(D2D1::ColorF(r, g, b, 0.5f));
+  m_pActiveBrush->SetColor(D2D1::ColorF(r, g, b, 0.8f));
+  m_brushColor = color;
 }
 
 void Visualizer::Update(float currentX, float currentY, float anchorY,
                         bool isLeft, bool isTriggered,
                         const std::string &gestureIcon) {
+  if (!EnsureCreated())
+    return;
+
   m_drawX = currentX;
   m_rawY = currentY;
 
@@ -106,6 +155,9 @@ void Visualizer::Update(float currentX, float currentY, float anchorY,
 void Visualizer::Render() {
   if (!m_pD2DFactory)
     return;
+  CreateResources();
+  if (!m_pDCRT)
+    return;
 
   HDC hScreenDC = GetDC(NULL);
   HDC hMemDC = CreateCompatibleDC(hScreenDC);
@@ -123,7 +175,6 @@ void Visualizer::Render() {
       CreateDIBSection(hMemDC, &bmi, DIB_RGB_COLORS, &pBits, NULL, 0);
   HBITMAP hOldBitmap = (HBITMAP)SelectObject(hMemDC, hBitmap);
 
-  CreateResources();
   RECT rc = {0, 0, m_width, m_screenHeight};
   m_pDCRT->BindDC(hMemDC, &rc);
   m_pDCRT->BeginDraw();
@@ -133,29 +184,16 @@ void Visualizer::Render() {
     // Color selection
     AppConfig &cfg = ConfigManager::Get().Current();
     std::string hex = m_isLeft ? cfg.left.color : cfg.right.color;
-    COLORREF color = ConfigManager::Get().GetColorRef(hex);
-    float r = GetRValue(color) / 255.0f;
-    float g = GetGValue(color) / 255.0f;
-    float b = GetBValue(color) / 255.0f;
-
-    if (m_pWaveBrush)
-      m_pWaveBrush->Release();
-    if (m_pActiveBrush)
-      m_pActiveBrush->Release();
-    if (m_pArrowBrush)
-      m_pArrowBrush->Release();
-
-    m_pDCRT->CreateSolidColorBrush(D2D1::ColorF(r, g, b, 0.5f), &m_pWaveBrush);
-    m_pDCRT->CreateSolidColorBrush(D2D1::ColorF(r, g, b, 0.8f),
-                                   &m_pActiveBrush);
-    m_pDCRT->CreateSolidColorBrush(D2D1::ColorF(1.0f, 1.0f, 1.0f, 0.9f),
-                                   &m_pArrowBrush);
+    UpdateBrushColor(ConfigManager::Get().GetColorRef(hex));
 
     DrawWave();
     DrawArrow();
   }
 
-  m_pDCRT->EndDraw();
+  if (m_pDCRT->EndDraw() == D2DERR_RECREATE_TARGET) {
+    // Rebuilt on the next frame
+    DiscardResources();
+  }
 
   POINT ptSrc = {0, 0};
   SIZE sizeWnd = {m_width, m_screenHeight};
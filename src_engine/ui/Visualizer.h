@@ -12,18 +12,19 @@ public:
   Visualizer();
   ~Visualizer();
 
+  // Only records the screen size; the window and Direct2D objects are
+  // created by EnsureCreated() on first use or from an idle warm-up
   bool Init(int screenW, int screenH);
+  bool EnsureCreated();
+  bool IsCreated() const { return m_hwnd != nullptr; }
   void Update(float currentX, float currentY, float anchorY, bool isLeft,
               bool isTriggered, const std::string &gestureIcon);
   void Render();
 
-  void SetTimerCallback(std::function<void()> cb) { m_onTimer = cb; }
-
   HWND GetHwnd() const { return m_hwnd; }
   void SetWindowVisible(bool visible);
 
 private:
-  std::function<void()> m_onTimer;
   HWND m_hwnd = nullptr;
   ID2D1Factory *m_pD2DFactory = nullptr;
   ID2D1DCRenderTarget *m_pDCRT = nullptr;
@@ -32,6 +33,7 @@ private:
   ID2D1SolidColorBrush *m_pWaveBrush = nullptr;
   ID2D1SolidColorBrush *m_pActiveBrush = nullptr;
   ID2D1SolidColorBrush *m_pArrowBrush = nullptr;
+  COLORREF m_brushColor = CLR_INVALID; // colour the wave brushes hold
 
   int m_width = 300; // Window width for drawing
   int m_screenHeight = 0;
@@ -45,7 +47,11 @@ private:
   bool m_triggered = false;
   std::string m_gestureIcon;
 
+  bool m_createFailed = false;
+
   void CreateResources();
+  void DiscardResources();
+  void UpdateBrushColor(COLORREF color);
   void DrawWave();
   void DrawArrow();
   static LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam,
@@ -0,0 +1,145 @@
+#include "AttachmentIndex.h"
+#include <QDir>
+#include <algorithm>
+
+void AttachmentIndex::reset(const QStringList &paths) {
+  clear();
+  m_paths.reserve(paths.size());
+  for (const QString &path : paths)
+    add(path);
+}
+
+void AttachmentIndex::clear() {
+  m_paths.clear();
+  m_byName.clear();
+}
+
+void AttachmentIndex::add(const QString &path) {
+  if (m_paths.contains(path))
+    return;
+  m_paths.insert(path);
+  m_byName[nameOf(path).toCaseFolded()].append(path);
+}
+
+bool AttachmentIndex::remove(const QString &path) {
+  if (!m_paths.remove(path))
+    return false;
+  auto it = m_byName.find(nameOf(path).toCaseFolded());
+  if (it != m_byName.end()) {
+    it.value().removeOne(path);
+    if (it.value().isEmpty())
+      m_byName.erase(it);
+  }
+  return true;
+}
+
+bool AttachmentIndex::removeTree(const QString &dirPath) {
+  if (remove(dirPath))
+    return true; // a file, not a folder
+
+  const QString prefix = dirPath + QLatin1Char('/');
+  QStringList gone;
+  for (const QString &path : std::as_const(m_paths)) {
+    if (path.startsWith(prefix))
+      gone.append(path);
+  }
+  for (const QString &path : std::as_const(gone))
+    remove(path);
+  return !gone.isEmpty();
+}
+
+void AttachmentIndex::renameTree(const QString &from, const QString &to) {
+  const QString prefix = from + QLatin1Char('/');
+  QStringList moved;
+  for (const QString &path : std::as_const(m_paths)) {
+    if (path == from || path.startsWith(prefix))
+      moved.append(path);
+  }
+  for (const QString &path : std::as_const(moved)) {
+    remove(path);
+    add(to + path.mid(from.size()));
+  }
+}
+
+QStringList AttachmentIndex::candidates(const QString &fileName) const {
+  QStringList paths = m_byName.value(fileName.toCaseFolded());
+  // Exact-case names first
+  std::stable_partition(paths.begin(), paths.end(),
+                        [&fileName](const QString &path) {
+                          return path.endsWith(fileName);
+                        });
+  return paths;
+}
+
+QString AttachmentIndex::resolve(const QString &link, const QString &notePath,
+                                 const QString &rootPath) const {
+  if (link.isEmpty())
+    return QString();
+  const QString root = QDir::cleanPath(rootPath);
+  const QString noteDir = dirOf(QDir::cleanPath(notePath));
+
+  if (link.contains(QLatin1Char('/'))) {
+    for (const QString &base : {root, noteDir}) {
+      const QString path = QDir::cleanPath(base + QLatin1Char('/') + link);
+      if (m_paths.contains(path))
+        return path;
+    }
+  }
+
+  const QString fileName = nameOf(link);
+  QStringList paths = candidates(fileName);
+  if (paths.isEmpty() && fileName.startsWith(QLatin1String("Pasted image ")))
+    paths = candidates(fileName.mid(13));
+  if (paths.size() <= 1)
+    return paths.value(0);
+
+  if (link.contains(QLatin1Char('/'))) {
+    // Keep the files whose folders match the ones written in the link
+    const QString suffix = QLatin1Char('/') + link;
+    QStringList matching;
+    for (const QString &path : std::as_const(paths)) {
+      if (path.endsWith(suffix, Qt::CaseInsensitive))
+        matching.append(path);
+    }
+    if (!matching.isEmpty())
+      paths = matching;
+  }
+
+  const QString preferred[] = {
+      noteDir,
+      noteDir + QLatin1String("/attachments"),
+      root + QLatin1String("/attachments"),
+      noteDir + QLatin1String("/images"),
+      root + QLatin1String("/images"),
+      noteDir + QLatin1String("/assets"),
+      root + QLatin1String("/assets"),
+      root,
+  };
+  for (const QString &dir : preferred) {
+    for (const QString &path : std::as_const(paths)) {
+      if (dirOf(path) == dir)
+        return path;
+    }
+  }
+
+  // Nearest to the note: most leading folders in common, then shallowest
+  auto shared = [&noteDir](const QString &path) {
+    const QString dir = dirOf(path);
+    qsizetype common = 0;
+    int folders = 0;
+    while (common < dir.size() && common < noteDir.size() &&
+           dir[common] == noteDir[common]) {
+      if (dir[common] == u'/')
+        folders++;
+      common++;
+    }
+    return folders;
+  };
+  auto nearer = [&shared](const QString &a, const QString &b) {
+    int sharedA = shared(a), sharedB = shared(b);
+    if (sharedA != sharedB)
+      return sharedA > sharedB;
+    return a.count(QLatin1Char('/')) < b.count(QLatin1Char('/'));
+  };
+  return *std::min_element(paths.cbegin(), paths.cend(), nearer);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Every non-note file of the vault (images, PDFs, ...) by file
+ * name, so embeds like ![[diagram.png]] resolve without touching the disk.
+ *
+ * Filled from the same directory walk as the notes and kept current from
+ * the watcher's change sets. Lookups by name are case-insensitive; an
+ * exact-case name wins over one differing only in case.
+ */
+class AttachmentIndex {
+public:
+  void reset(const QStringList &paths);
+  void clear();
+  void add(const QString &path);
+  bool remove(const QString &path);
+  /** @brief Drops @p dirPath and everything under it. */
+  bool removeTree(const QString &dirPath);
+  void renameTree(const QString &from, const QString &to);
+
+  int size() const { return int(m_paths.size()); }
+  bool contains(const QString &path) const { return m_paths.contains(path); }
+
+  /**
+   * @brief Path of the attachment @p link (a name or a "folder/name" path)
+   * embedded in the note at @p notePath, or empty if there is none.
+   *
+   * A link with folders is tried relative to the vault, then to the note.
+   * Otherwise files of that name are preferred in this order: the note's
+   * folder; attachments/, images/ and assets/ (each next to the note, then
+   * at the vault root); the vault root; then the one sharing the most
+   * folders with the note. A "Pasted image " prefix is dropped if nothing
+   * has the full name.
+   */
+  QString resolve(const QString &link, const QString &notePath,
+                  const QString &rootPath) const;
+
+private:
+  static QString nameOf(const QString &path) {
+    return path.mid(path.lastIndexOf(QLatin1Char('/')) + 1);
+  }
+  static QString dirOf(const QString &path) {
+    return path.left(path.lastIndexOf(QLatin1Char('/')));
+  }
+  QStringList candidates(const QString &fileName) const;
+
+  QSet<QString> m_paths;
+  QHash<QString, QStringList> m_byName; // case-folded file name -> paths
+};
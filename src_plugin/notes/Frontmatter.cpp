@@ -0,0 +1,297 @@
+#include "Frontmatter.h"
+#include <cstring>
+
+namespace {
+constexpr char kBom[] = "\xEF\xBB\xBF";
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+QByteArrayView rightTrimmed(QByteArrayView s) {
+  while (!s.isEmpty() && isSpace(s.back()))
+    s.chop(1);
+  return s;
+}
+
+QByteArrayView trimmed(QByteArrayView s) {
+  while (!s.isEmpty() && isSpace(s.front()))
+    s = s.sliced(1);
+  return rightTrimmed(s);
+}
+
+bool equals(QByteArrayView a, QByteArrayView b) {
+  return a.size() == b.size() &&
+         std::memcmp(a.data(), b.data(), size_t(a.size())) == 0;
+}
+
+bool isFence(QByteArrayView line) {
+  return equals(rightTrimmed(line), QByteArrayView("---"));
+}
+
+QByteArray quoted(const QByteArray &utf8) {
+  QByteArray out;
+  out.reserve(utf8.size() + 2);
+  out.append('"');
+  for (char c : utf8) {
+    if (c == '"' || c == '\\')
+      out.append('\\');
+    if (c == '\n') {
+      out.append("\\n");
+      continue;
+    }
+    out.append(c);
+  }
+  out.append('"');
+  return out;
+}
+} // namespace
+
+Frontmatter Frontmatter::parse(const QByteArray &utf8) {
+  Frontmatter fm;
+  fm.m_data = utf8;
+  const char *data = utf8.constData();
+  const qsizetype size = utf8.size();
+
+  auto lineEnd = [data, size](qsizetype from) -> qsizetype {
+    const void *nl = std::memchr(data + from, '\n', size_t(size - from));
+    return nl ? static_cast<const char *>(nl) - data : size;
+  };
+
+  qsizetype pos = utf8.startsWith(kBom) ? 3 : 0;
+  qsizetype eol = lineEnd(pos);
+  if (!isFence(QByteArrayView(data + pos, eol - pos)) || eol == size)
+    return fm;
+  pos = eol + 1;
+
+  int current = -1; // field the following indented lines belong to
+  while (pos < size) {
+    eol = lineEnd(pos);
+    const qsizetype next = qMin(eol + 1, size);
+    const QByteArrayView line(data + pos, eol - pos);
+    const QByteArrayView content = trimmed(line);
+
+    if (isFence(line)) {
+      fm.m_closeStart = pos;
+      fm.m_bodyOffset = next;
+      fm.m_valid = true;
+      return fm;
+    }
+
+    if (content.isEmpty() || content.front() == '#') {
+      // Blank and comment lines belong to no field
+    } else if (isSpace(line.front()) || line.front() == '-') {
+      if (current >= 0) {
+        Field &field = fm.m_fields[current];
+        if (field.kind == Kind::Scalar && field.valueLength == 0 &&
+            content.front() == '-') {
+          field.kind = Kind::BlockList;
+          field.valueStart = pos;
+        }
+        if (field.kind == Kind::BlockList)
+          field.valueLength = eol - field.valueStart;
+        field.end = next;
+      }
+    } else {
+      current = -1;
+      const void *colon = std::memchr(line.data(), ':', size_t(line.size()));
+      if (colon) {
+        const qsizetype colonPos = static_cast<const char *>(colon) - data;
+        const QByteArrayView key =
+            rightTrimmed(QByteArrayView(data + pos, colonPos - pos));
+        const QByteArrayView value =
+            trimmed(QByteArrayView(data + colonPos + 1, eol - colonPos - 1));
+
+        Field field;
+        field.keyStart = pos;
+        field.keyLength = key.size();
+        field.valueStart = value.data() - data;
+        field.valueLength = value.size();
+        field.lineStart = pos;
+        field.end = next;
+        field.kind = !value.isEmpty() && value.front() == '['
+                         ? Kind::InlineList
+                         : Kind::Scalar;
+        fm.m_fields.append(field);
+        current = int(fm.m_fields.size()) - 1;
+      }
+    }
+    pos = next;
+  }
+
+  // No closing line: not frontmatter after all
+  fm.m_fields.clear();
+  return fm;
+}
+
+int Frontmatter::findField(QByteArrayView key) const {
+  for (int i = 0; i < m_fields.size(); ++i) {
+    const Field &field = m_fields[i];
+    if (equals(QByteArrayView(m_data).sliced(field.keyStart, field.keyLength),
+               key))
+      return i;
+  }
+  return -1;
+}
+
+QString Frontmatter::value(QByteArrayView key, const QString &fallback) const {
+  int i = findField(key);
+  if (i < 0 || m_fields[i].kind != Kind::Scalar)
+    return fallback;
+  QString value = unquote(valueOf(m_fields[i]));
+  return value.isEmpty() ? fallback : value;
+}
+
+QStringList Frontmatter::list(QByteArrayView key) const {
+  QStringList items;
+  int i = findField(key);
+  if (i < 0)
+    return items;
+
+  const Field &field = m_fields[i];
+  switch (field.kind) {
+  case Kind::Scalar:
+    if (field.valueLength > 0)
+      items.append(unquote(valueOf(field)));
+    break;
+  case Kind::InlineList:
+    appendInlineItems(valueOf(field), items);
+    break;
+  case Kind::BlockList:
+    appendBlockItems(valueOf(field), items);
+    break;
+  }
+  items.removeAll(QString());
+  return items;
+}
+
+bool Frontmatter::boolean(QByteArrayView key, bool fallback) const {
+  const QString value = this->value(key).toLower();
+  if (value == QLatin1String("true") || value == QLatin1String("yes") ||
+      value == QLatin1String("on"))
+    return true;
+  if (value == QLatin1String("false") || value == QLatin1String("no") ||
+      value == QLatin1String("off"))
+    return false;
+  return fallback;
+}
+
+QString Frontmatter::unquote(QByteArrayView raw) {
+  raw = trimmed(raw);
+  if (raw.size() >= 2 && raw.front() == '"' && raw.back() == '"') {
+    QByteArray out;
+    out.reserve(raw.size());
+    for (qsizetype i = 1; i < raw.size() - 1; ++i) {
+      char c = raw[i];
+      if (c == '\\' && i + 1 < raw.size() - 1) {
+        c = raw[++i];
+        if (c == 'n')
+          c = '\n';
+        else if (c == 't')
+          c = '\t';
+      }
+      out.append(c);
+    }
+    return QString::fromUtf8(out);
+  }
+  if (raw.size() >= 2 && raw.front() == '\'' && raw.back() == '\'') {
+    // The only escape in single quotes is a doubled quote
+    QByteArray out = raw.sliced(1, raw.size() - 2).toByteArray();
+    out.replace("''", "'");
+    return QString::fromUtf8(out);
+  }
+  return QString::fromUtf8(raw);
+}
+
+void Frontmatter::appendInlineItems(QByteArrayView raw, QStringList &items) {
+  QByteArrayView inner = raw.sliced(1); // past '['
+  if (!inner.isEmpty() && inner.back() == ']')
+    inner.chop(1);
+
+  // Split at commas outside quotes
+  char quote = 0;
+  qsizetype start = 0;
+  for (qsizetype i = 0; i <= inner.size(); ++i) {
+    if (i < inner.size()) {
+      const char c = inner[i];
+      if (quote) {
+        if (quote == '"' && c == '\\')
+          ++i;
+        else if (c == quote)
+          quote = 0;
+        continue;
+      }
+      if (c == '"' || c == '\'') {
+        quote = c;
+        continue;
+      }
+      if (c != ',')
+        continue;
+    }
+    items.append(unquote(inner.sliced(start, i - start)));
+    start = i + 1;
+  }
+}
+
+void Frontmatter::appendBlockItems(QByteArrayView raw, QStringList &items) {
+  qsizetype pos = 0;
+  while (pos < raw.size()) {
+    const void *nl =
+        std::memchr(raw.data() + pos, '\n', size_t(raw.size() - pos));
+    const qsizetype eol =
+        nl ? static_cast<const char *>(nl) - raw.data() : raw.size();
+    const QByteArrayView line = trimmed(raw.sliced(pos, eol - pos));
+    // Deeper, non-item lines belong to nested values we do not interpret
+    if (!line.isEmpty() && line.front() == '-')
+      items.append(unquote(line.sliced(1)));
+    pos = eol + 1;
+  }
+}
+
+QByteArray Frontmatter::setField(const QByteArray &utf8, QByteArrayView key,
+                                 const QByteArray &yamlValue) {
+  QByteArray line = key.toByteArray();
+  line.append(": ").append(yamlValue).append('\n');
+
+  const Frontmatter fm = parse(utf8);
+  QByteArray out = utf8;
+  if (!fm.isValid()) {
+    out.insert(utf8.startsWith(kBom) ? 3 : 0,
+               QByteArray("---\n") + line + QByteArray("---\n"));
+    return out;
+  }
+
+  int i = fm.findField(key);
+  if (i >= 0) {
+    const Field &field = fm.m_fields[i];
+    out.replace(field.lineStart, field.end - field.lineStart, line);
+  } else {
+    out.insert(fm.m_closeStart, line);
+  }
+  return out;
+}
+
+QByteArray Frontmatter::scalar(const QString &value) {
+  const QByteArray utf8 = value.toUtf8();
+  // '#' is left plain on purpose: colors are written as "color: #624a73"
+  static const char kIndicators[] = "[]{},&*!|>'\"%@`";
+  const bool plain =
+      !utf8.isEmpty() && !isSpace(utf8.front()) && !isSpace(utf8.back()) &&
+      !std::strchr(kIndicators, utf8.front()) && !utf8.startsWith("- ") &&
+      !utf8.contains(": ") && !utf8.contains(" #") && !utf8.contains('\n');
+  return plain ? utf8 : quoted(utf8);
+}
+
+QByteArray Frontmatter::inlineList(const QStringList &items) {
+  QByteArray out("[");
+  for (int i = 0; i < items.size(); ++i) {
+    if (i > 0)
+      out.append(", ");
+    QByteArray item = scalar(items[i]);
+    // Separators of the list itself must not appear unquoted
+    if (!item.startsWith('"') &&
+        (item.contains(',') || item.contains('[') || item.contains(']')))
+      item = quoted(items[i].toUtf8());
+    out.append(item);
+  }
+  out.append(']');
+  return out;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Single-pass parser for the YAML subset used in note frontmatter.
+ *
+ * A frontmatter block starts with a "---" line at the very top of the note
+ * and ends at the next "---" line. Inside, top-level "key: value" lines are
+ * fields, and a value is a scalar (plain, 'single' or "double" quoted), an
+ * inline list ("[a, 'b, c']") or a block list of "- item" lines below the
+ * key. Anything else (nested maps, multi-line strings) is kept verbatim but
+ * not interpreted.
+ *
+ * The parser walks the UTF-8 bytes as read from disk once and only records
+ * byte offsets; values are decoded to QString when asked for. The same
+ * offsets let setField() rewrite one field while every other byte of the
+ * note stays as written.
+ */
+class Frontmatter {
+public:
+  static Frontmatter parse(const QByteArray &utf8);
+
+  bool isValid() const { return m_valid; }
+  /** @brief Byte offset of the body: just past the closing line, or 0. */
+  qsizetype bodyOffset() const { return m_bodyOffset; }
+
+  bool contains(QByteArrayView key) const { return findField(key) >= 0; }
+  /** @brief Unquoted scalar; @p fallback if missing, empty or a list. */
+  QString value(QByteArrayView key, const QString &fallback = QString()) const;
+  /** @brief Items of a list field; a scalar yields a one-item list. */
+  QStringList list(QByteArrayView key) const;
+  /** @brief true/yes/on or false/no/off, case-insensitive. */
+  bool boolean(QByteArrayView key, bool fallback = false) const;
+
+  /**
+   * @brief @p utf8 with @p key set to @p yamlValue (see scalar() and
+   * inlineList()). An existing field is replaced in place, block list lines
+   * included; a new one goes last in the block, and a note without
+   * frontmatter gets a block holding just this field.
+   */
+  static QByteArray setField(const QByteArray &utf8, QByteArrayView key,
+                             const QByteArray &yamlValue);
+
+  // Values formatted for setField(), quoted only where needed
+  static QByteArray scalar(const QString &value);
+  static QByteArray inlineList(const QStringList &items);
+
+private:
+  enum class Kind : quint8 { Scalar, InlineList, BlockList };
+
+  struct Field {
+    qsizetype keyStart = 0;
+    qsizetype keyLength = 0;
+    // Scalars and inline lists: the value on the key line, trimmed.
+    // Block lists: every line below the key.
+    qsizetype valueStart = 0;
+    qsizetype valueLength = 0;
+    qsizetype lineStart = 0; // whole field, continuation lines included
+    qsizetype end = 0;
+    Kind kind = Kind::Scalar;
+  };
+
+  int findField(QByteArrayView key) const;
+  QByteArrayView valueOf(const Field &field) const {
+    return QByteArrayView(m_data).sliced(field.valueStart, field.valueLength);
+  }
+  static QString unquote(QByteArrayView raw);
+  static void appendInlineItems(QByteArrayView raw, QStringList &items);
+  static void appendBlockItems(QByteArrayView raw, QStringList &items);
+
+  QByteArray m_data; // shared with the caller's buffer
+  QVector<Field> m_fields;
+  qsizetype m_closeStart = 0; // start of the closing "---" line
+  qsizetype m_bodyOffset = 0;
+  bool m_valid = false;
+};
@@ -0,0 +1,77 @@
+#include "FuzzyMatcher.h"
+
+namespace {
+constexpr int kMatch = 16;
+constexpr int kPrefixBonus = 32;
+constexpr int kBoundaryBonus = 20;
+constexpr int kConsecutiveBonus = 12;
+constexpr int kGapPenalty = 3;
+constexpr int kMaxGapPenalty = 24;
+constexpr int kSubstringBonus = 40;
+
+bool isBoundary(QChar c) { return !c.isLetterOrNumber(); }
+} // namespace
+
+quint64 FuzzyMatcher::charMask(QStringView key) {
+  quint64 mask = 0;
+  for (QChar c : key) {
+    if (!c.isSpace())
+      mask |= quint64(1) << (c.unicode() & 63);
+  }
+  return mask;
+}
+
+int FuzzyMatcher::score(QStringView pattern, QStringView text) {
+  // Spaces only separate the pattern's words and need not appear in text
+  qsizetype m = 0;
+  for (QChar c : pattern) {
+    if (!c.isSpace())
+      ++m;
+  }
+  const qsizetype n = text.size();
+  if (m == 0)
+    return 0;
+  if (m > n)
+    return -1;
+
+  // Greedy left-to-right alignment; boundaries and runs are scored as met
+  int score = 0;
+  qsizetype pi = 0, matched = 0, previous = -1, first = -1;
+  for (qsizetype ti = 0; ti < n && matched < m; ++ti) {
+    while (pattern[pi].isSpace())
+      ++pi;
+    if (text[ti] != pattern[pi])
+      continue;
+
+    int bonus = kMatch;
+    if (ti == 0)
+      bonus += kPrefixBonus;
+    else if (isBoundary(text[ti - 1]))
+      bonus += kBoundaryBonus;
+
+    if (previous >= 0 && previous == ti - 1)
+      bonus += kConsecutiveBonus;
+    else if (previous >= 0)
+      score -= int(qMin<qsizetype>((ti - previous - 1) * kGapPenalty,
+                                   kMaxGapPenalty));
+
+    score += bonus;
+    if (first < 0)
+      first = ti;
+    previous = ti;
+    ++pi;
+    ++matched;
+  }
+  if (matched < m)
+    return -1;
+
+  // Whole-pattern hits, spaces included, beat scattered ones; a prefix hit
+  // beats both
+  qsizetype at = text.indexOf(pattern);
+  if (at >= 0)
+    score += kSubstringBonus + (at == 0 ? kSubstringBonus : 0);
+
+  score -= int(qMin<qsizetype>(first, 8));
+  score -= int((n - m) / 4);
+  return qMax(score, 0);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QString>
+#include <QStringView>
+
+/**
+ * @brief Fuzzy subsequence scoring for title and tag search.
+ *
+ * Both sides are expected to be search keys (NotesStore::searchKey), i.e.
+ * case-folded with diacritics stripped. A candidate matches when the
+ * pattern's characters appear in it in order; the score rewards matches at
+ * the start, after word boundaries and in runs, and penalizes gaps and
+ * long candidates, so "mtg nts" ranks "Meeting notes" above "My tangents".
+ */
+class FuzzyMatcher {
+public:
+  /**
+   * @brief Score of @p text for @p pattern, or -1 if it does not match.
+   * Whitespace in @p pattern separates words: it need not appear in
+   * @p text, but a hit of the whole pattern, spaces included, scores best.
+   */
+  static int score(QStringView pattern, QStringView text);
+
+  /**
+   * @brief 64-bit set of the non-space characters in @p key. A candidate
+   * can only match if its mask covers the pattern's, which rejects most
+   * candidates with one AND over a contiguous array before any scoring.
+   */
+  static quint64 charMask(QStringView key);
+
+  static bool maskCovers(quint64 candidate, quint64 pattern) {
+    return (candidate & pattern) == pattern;
+  }
+};
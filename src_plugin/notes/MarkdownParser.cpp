@@ -1,5 +1,6 @@
 #include "MarkdownParser.h"
 #include "md4c/src/md4c.h"
+#include <QByteArrayView>
 #include <QDebug>
 #include <QRegularExpression>
 #include <QStack>
@@ -19,8 +20,85 @@ struct ParseContext {
   QVector<QVector<QString>> tableRows;
   QVector<QString> currentTableRow;
   QString currentCellBuffer;
+
+  // Source spans: text md4c hands over points into the source, so the
+  // first and last text of a block locate its lines
+  const char *source = nullptr; // the whole document
+  qsizetype windowBegin = 0;    // the part being parsed
+  qsizetype windowEnd = 0;
+  qsizetype firstText = -1; // of the block being read, offsets in source
+  qsizetype lastText = -1;
+  qsizetype spanEnd = 0; // where the span of the last block ended
+  char fenceChar = 0;    // of the fenced code block being read
+  bool inHtml = false;   // raw HTML is dropped, its text belongs to no block
 };
 
+static bool isBlankLine(QByteArrayView line) {
+  return line.trimmed().isEmpty();
+}
+
+// Sets the source span of a finished top-level block and appends it
+static void appendBlock(ParseContext *ctx, NoteBlock block) {
+  const char *src = ctx->source;
+  const qsizetype limit = ctx->windowEnd;
+  auto lineStart = [ctx, src](qsizetype pos) {
+    while (pos > ctx->windowBegin && src[pos - 1] != '\n')
+      --pos;
+    return pos;
+  };
+  auto lineEnd = [src, limit](qsizetype pos) {
+    while (pos < limit && src[pos] != '\n')
+      ++pos;
+    return pos < limit ? pos + 1 : limit;
+  };
+  auto line = [src, &lineEnd](qsizetype pos) {
+    return QByteArrayView(src + pos, lineEnd(pos) - pos);
+  };
+
+  qsizetype begin = ctx->spanEnd;
+  if (ctx->firstText >= 0 && !ctx->fenceChar) {
+    begin = qMax(begin, lineStart(ctx->firstText));
+  } else {
+    // A fence line, or a block without text (a divider, an empty item):
+    // the next line that is not blank
+    while (begin < limit && isBlankLine(line(begin)))
+      begin = lineEnd(begin);
+  }
+
+  qsizetype end = lineEnd(ctx->lastText >= 0 ? ctx->lastText : begin);
+  const QByteArrayView first = line(begin);
+  const qsizetype fenceAt = ctx->fenceChar ? first.indexOf(ctx->fenceChar) : -1;
+  if (fenceAt >= 0) {
+    // Through the closing fence, a run of the fence character at least as
+    // long as the opening one; unclosed, the block runs to the end
+    qsizetype run = 0;
+    while (fenceAt + run < first.size() &&
+           first[fenceAt + run] == ctx->fenceChar)
+      ++run;
+    end = lineEnd(begin);
+    while (end < limit) {
+      const QByteArrayView fence = line(end).trimmed();
+      end = lineEnd(end);
+      if (fence.size() >= run &&
+          fence.count(ctx->fenceChar) == fence.size())
+        break;
+    }
+  } else if (block.type == BlockType::Heading && end < limit &&
+             !first.trimmed().startsWith('#')) {
+    const QByteArrayView underline = line(end).trimmed();
+    const char c = underline.isEmpty() ? 0 : underline.front();
+    if ((c == '=' || c == '-') && underline.count(c) == underline.size())
+      end = lineEnd(end);
+  }
+
+  block.sourceBegin = int(begin);
+  block.sourceEnd = int(qMax(end, begin));
+  ctx->spanEnd = block.sourceEnd;
+  ctx->firstText = ctx->lastText = -1;
+  ctx->fenceChar = 0;
+  ctx->blocks.append(std::move(block));
+}
+
 // MD4C Callbacks
 static int enter_block_callback(MD_BLOCKTYPE type, void *detail,
                                 void *userdata) {
@@ -61,6 +139,7 @@ static int enter_block_callback(MD_BLOCKTYPE type, void *detail,
       newBlock.language =
           QString::fromUtf8(c_detail->lang.text, c_detail->lang.size);
     }
+    ctx->fenceChar = c_detail->fence_char;
     break;
   }
   case MD_BLOCK_QUOTE:
@@ -121,6 +200,10 @@ static int enter_block_callback(MD_BLOCKTYPE type, void *detail,
     ctx->currentCellBuffer.clear();
     ctx->inBlock = false;
     break;
+  case MD_BLOCK_HTML:
+    ctx->inHtml = true;
+    ctx->inBlock = false;
+    break;
   case MD_BLOCK_P:
     // Skip paragraph blocks inside tables - cell content is handled separately
     if (ctx->inTable) {
@@ -153,6 +236,11 @@ static int leave_block_callback(MD_BLOCKTYPE type, void *detail,
     return 0;
   }
 
+  if (type == MD_BLOCK_HTML) {
+    ctx->inHtml = false;
+    return 0;
+  }
+
   // Table cell/row/table ending handling
   if (type == MD_BLOCK_TH || type == MD_BLOCK_TD) {
     // End of a cell - add cell content to the current row
@@ -195,7 +283,7 @@ static int leave_block_callback(MD_BLOCKTYPE type, void *detail,
       }
       tableBlock.metadata["rows"] = rowsVariant;
 
-      ctx->blocks.append(tableBlock);
+      appendBlock(ctx, tableBlock);
       qDebug() << "MarkdownParser: Table block appended with metadata";
     }
     ctx->inTable = false;
@@ -238,7 +326,7 @@ static int leave_block_callback(MD_BLOCKTYPE type, void *detail,
           }
         }
 
-        ctx->blocks.append(ctx->currentBlock);
+        appendBlock(ctx, ctx->currentBlock);
         ctx->inBlock = false;
       }
     }
@@ -347,7 +435,7 @@ static int leave_block_callback(MD_BLOCKTYPE type, void *detail,
     }
     // If it is Embed/Image, we already set the content to the inner text
 
-    ctx->blocks.append(ctx->currentBlock);
+    appendBlock(ctx, ctx->currentBlock);
 
     ctx->currentTextBuffer.clear();
     ctx->inBlock = false;
@@ -427,6 +515,17 @@ static int text_callback(MD_TEXTTYPE type, const MD_CHAR *text, MD_SIZE size,
   ParseContext *ctx = static_cast<ParseContext *>(userdata);
   QString textStr = QString::fromUtf8(text, static_cast<int>(size));
 
+  // Line breaks and the like come from md4c's own strings, not the source
+  const quintptr at = quintptr(text);
+  if (!ctx->inHtml && size > 0 &&
+      at >= quintptr(ctx->source + ctx->windowBegin) &&
+      at < quintptr(ctx->source + ctx->windowEnd)) {
+    const qsizetype offset = qsizetype(at - quintptr(ctx->source));
+    if (ctx->firstText < 0)
+      ctx->firstText = offset;
+    ctx->lastText = offset + size - 1;
+  }
+
   // If we're in a table, append to the cell buffer instead
   if (ctx->inTable) {
     ctx->currentCellBuffer.append(textStr);
@@ -437,7 +536,17 @@ static int text_callback(MD_TEXTTYPE type, const MD_CHAR *text, MD_SIZE size,
 }
 
 QVector<NoteBlock> MarkdownParser::parse(const QString &markdown) {
+  const QByteArray data = markdown.toUtf8();
+  return parse(data, 0, data.size());
+}
+
+QVector<NoteBlock> MarkdownParser::parse(const QByteArray &source,
+                                         qsizetype offset, qsizetype length) {
   ParseContext ctx;
+  ctx.source = source.constData();
+  ctx.windowBegin = offset;
+  ctx.windowEnd = offset + length;
+  ctx.spanEnd = offset;
 
   MD_PARSER parser = {
       0, // abi_version
@@ -451,8 +560,7 @@ QVector<NoteBlock> MarkdownParser::parse(const QString &markdown) {
       nullptr // debug_log
   };
 
-  QByteArray data = markdown.toUtf8();
-  md_parse(data.constData(), data.size(), &parser, &ctx);
+  md_parse(ctx.source + offset, MD_SIZE(length), &parser, &ctx);
 
   return ctx.blocks;
 }
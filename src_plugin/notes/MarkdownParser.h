@@ -14,6 +14,18 @@ public:
    * @return A vector of NoteBlock objects.
    */
   static QVector<NoteBlock> parse(const QString &markdown);
+
+  /**
+   * @brief Parses @p length bytes of the UTF-8 @p source from @p offset,
+   * which must start a line.
+   *
+   * Each block's source span is set as byte offsets into @p source: from
+   * the start of the line its text begins on through the end of the line
+   * it ends on, fences of fenced code and a setext underline included.
+   * Blank lines between blocks belong to neither.
+   */
+  static QVector<NoteBlock> parse(const QByteArray &source, qsizetype offset,
+                                  qsizetype length);
 };
 
 #endif // MARKDOWNPARSER_H
@@ -29,6 +29,12 @@ struct NoteBlock {
   int level = 0;    // For Headings (1-6)
   QString language; // For Code blocks
 
+  // UTF-8 byte range of the markdown the block was read from (see
+  // MarkdownParser::parse()). Equal ends mean the block has no markdown,
+  // like an empty paragraph added in the editor.
+  int sourceBegin = -1;
+  int sourceEnd = -1;
+
   // UI Helpers
   int heightHint = 0;
 };
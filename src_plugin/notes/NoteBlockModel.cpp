@@ -1,13 +1,155 @@
 #include "NoteBlockModel.h"
 #include "MarkdownFormatter.h"
 #include "MarkdownParser.h"
+#include "NotesIndex.h"
 #include <QtConcurrent>
+#include <algorithm>
+#include <utility>
+
+namespace {
+bool isPlaceholder(const NoteBlock &block) {
+  return block.sourceBegin == block.sourceEnd;
+}
+
+bool isListBlock(const NoteBlock &block) {
+  return block.type == BlockType::List || block.type == BlockType::TaskList;
+}
+
+// Same as far as the view can tell, whatever the spans
+bool sameBlock(const NoteBlock &a, const NoteBlock &b) {
+  return a.type == b.type && a.level == b.level && a.content == b.content &&
+         a.language == b.language && a.metadata == b.metadata;
+}
+
+// "- x", "* x", "+ x", "1. x" or "1) x": a list item, which a blank line
+// before it does not part from the list above
+bool isListItem(QByteArrayView line) {
+  qsizetype at = 0;
+  while (at < line.size() && at < 3 && line[at] == ' ')
+    ++at;
+  if (at < line.size() &&
+      (line[at] == '-' || line[at] == '*' || line[at] == '+')) {
+    ++at;
+  } else {
+    const qsizetype digits = at;
+    while (at < line.size() && line[at] >= '0' && line[at] <= '9')
+      ++at;
+    if (at == digits || at - digits > 9 || at >= line.size() ||
+        (line[at] != '.' && line[at] != ')'))
+      return false;
+    ++at;
+  }
+  return at == line.size() || line[at] == ' ' || line[at] == '\t' ||
+         line[at] == '\r' || line[at] == '\n';
+}
+
+// The markdown of one block as getMarkdown() writes it, with the blank
+// line that follows it
+QString blockMarkdown(const NoteBlock &block) {
+  QString result;
+  // Reconstruct based on type
+  switch (block.type) {
+  case BlockType::Heading:
+    result.append(QString(block.level, '#') + " " + block.content + "\n\n");
+    break;
+  case BlockType::Code: {
+    // Trim content to prevent newline accumulation
+    QString codeContent = block.content;
+    // Remove leading/trailing newlines only (preserve internal whitespace)
+    while (codeContent.startsWith('\n') || codeContent.startsWith('\r')) {
+      codeContent = codeContent.mid(1);
+    }
+    while (codeContent.endsWith('\n') || codeContent.endsWith('\r')) {
+      codeContent.chop(1);
+    }
+    result.append("```" + block.language + "\n" + codeContent + "\n```\n\n");
+  } break;
+  case BlockType::Quote: {
+    QStringList lines = block.content.split('\n');
+    for (const QString &line : lines) {
+      result.append("> " + line + "\n");
+    }
+    result.append("\n");
+  } break;
+  case BlockType::Callout: {
+    result.append("> [!" +
+                  block.metadata["calloutType"].toString().toUpper() + "] " +
+                  block.metadata["title"].toString() + "\n");
+    QStringList lines = block.content.split('\n');
+    for (const QString &line : lines) {
+      result.append("> " + line + "\n");
+    }
+    result.append("\n");
+  } break;
+  case BlockType::TaskList: {
+    QString mark = " ";
+    if (block.metadata.contains("taskStatus")) {
+      mark = block.metadata["taskStatus"].toString();
+    } else {
+      mark = block.metadata["checked"].toBool() ? "x" : " ";
+    }
+    result.append(QString("- [%1] %2\n").arg(mark).arg(block.content));
+  } break;
+  case BlockType::Embed:
+    // Reconstruct ![[Note#Section]]
+    result.append(QString("![[%1]]\n\n").arg(block.content));
+    break;
+  case BlockType::Image:
+
+    // Identify if it was likely an obsidian link (no path separation) or md
+    // link
+    result.append(QString("![[%1]]\n\n").arg(block.content));
+    break;
+  case BlockType::List: {
+    // Check metadata for ordered vs unordered
+    bool isOrdered = block.metadata["listType"].toString() == "ordered";
+    if (isOrdered) {
+      // We could track index, but for now simple reconstruction:
+      result.append("1. " + block.content + "\n");
+    } else {
+      result.append("* " + block.content + "\n");
+    }
+  } break;
+  case BlockType::ThematicBreak:
+    result.append("---\n\n");
+    break;
+  case BlockType::Table: {
+    // Reconstruct markdown table from metadata rows
+    QVariantList rows = block.metadata["rows"].toList();
+    for (int i = 0; i < rows.size(); ++i) {
+      QVariantList cells = rows[i].toList();
+      result.append("|");
+      for (const QVariant &cell : cells) {
+        result.append(" " + cell.toString() + " |");
+      }
+      result.append("\n");
+      // Add separator row after header (first row)
+      if (i == 0 && !cells.isEmpty()) {
+        result.append("|");
+        for (int j = 0; j < cells.size(); ++j) {
+          result.append(" --- |");
+        }
+        result.append("\n");
+      }
+    }
+    result.append("\n");
+  } break;
+  default:
+    result.append(block.content + "\n\n");
+    break;
+  }
+  return result;
+}
+} // namespace
 
 NoteBlockModel::NoteBlockModel(QObject *parent)
     : QAbstractListModel(parent),
-      m_watcher(new QFutureWatcher<QVector<NoteBlock>>(this)) {
+      m_watcher(new QFutureWatcher<QVector<NoteBlock>>(this)),
+      m_noteWatcher(new QFutureWatcher<ParsedNoteCache::Entry>(this)) {
   connect(m_watcher, &QFutureWatcher<QVector<NoteBlock>>::finished, this,
           &NoteBlockModel::onParseFinished);
+  connect(m_noteWatcher, &QFutureWatcher<ParsedNoteCache::Entry>::finished,
+          this, &NoteBlockModel::onNoteParsed);
 }
 
 int NoteBlockModel::rowCount(const QModelIndex &parent) const {
@@ -80,25 +222,121 @@ QHash<int, QByteArray> NoteBlockModel::roleNames() const {
   return roles;
 }
 
-void NoteBlockModel::loadMarkdown(const QString &content) {
+void NoteBlockModel::cancelLoad() {
   if (m_watcher->isRunning()) {
     m_watcher->cancel();
     m_watcher->waitForFinished();
   }
+  if (m_noteWatcher->isRunning()) {
+    m_noteWatcher->cancel();
+    m_noteWatcher->waitForFinished();
+  }
+}
+
+void NoteBlockModel::loadMarkdown(const QString &content) {
+  cancelLoad();
 
   m_loading = true;
   emit loadingChanged();
 
+  const QByteArray source = content.toUtf8();
+  if (reloadIncrementally(source)) {
+    m_loading = false;
+    emit loadingChanged();
+    return;
+  }
+
   // Run parser in background thread
   // Note: In strict QtConcurrent, we accept by value to avoid race conditions
   // on 'content'
-  m_watcher->setFuture(QtConcurrent::run(
-      [content]() { return MarkdownParser::parse(content); }));
+  m_loadSource = source;
+  m_watcher->setFuture(QtConcurrent::run([source]() {
+    return MarkdownParser::parse(source, 0, source.size());
+  }));
+}
+
+bool NoteBlockModel::reloadIncrementally(const QByteArray &source) {
+  if (m_blocks.isEmpty())
+    return false;
+
+  // The one stretch that differs, between the common prefix and suffix
+  const qsizetype common = qMin(source.size(), m_source.size());
+  qsizetype prefix = 0;
+  while (prefix < common && source[prefix] == m_source[prefix])
+    ++prefix;
+  qsizetype suffix = 0;
+  while (suffix < common - prefix &&
+         source[source.size() - 1 - suffix] ==
+             m_source[m_source.size() - 1 - suffix])
+    ++suffix;
+  const qsizetype end = m_source.size() - suffix;
+  const qsizetype length = source.size() - suffix - prefix;
+  if (end - prefix + length > kIncrementalReloadBytes)
+    return false;
+  if (end == prefix && length == 0)
+    return true; // unchanged
+
+  // The rows around it: the last starting at or before it through the
+  // first ending at or after it
+  auto firstAfter = std::upper_bound(
+      m_blocks.cbegin(), m_blocks.cend(), prefix,
+      [](qsizetype pos, const NoteBlock &b) { return pos < b.sourceBegin; });
+  const int first = qMax(0, int(firstAfter - m_blocks.cbegin()) - 1);
+  auto lastEnding = std::lower_bound(
+      m_blocks.cbegin(), m_blocks.cend(), end,
+      [](const NoteBlock &b, qsizetype pos) { return b.sourceEnd < pos; });
+  const int last = qBound(first, int(lastEnding - m_blocks.cbegin()),
+                          int(m_blocks.size()) - 1);
+
+  reparse(first, last, prefix, end, source.mid(prefix, length));
+  return true;
+}
+
+void NoteBlockModel::loadNote(const QString &path) {
+  cancelLoad();
+
+  m_loading = true;
+  emit loadingChanged();
+
+  const QString notePath = NotesIndex::normalizePath(path);
+  ParsedNoteCache *cache = ParsedNoteCache::instance();
+  if (ParsedNoteCache::Entry note = cache->lookup(notePath)) {
+    showNote(note);
+    return;
+  }
+
+  m_noteWatcher->setFuture(QtConcurrent::run(
+      [cache, notePath]() { return cache->parse(notePath); }));
+}
+
+void NoteBlockModel::onNoteParsed() {
+  showNote(m_noteWatcher->result());
+}
+
+void NoteBlockModel::showNote(const ParsedNoteCache::Entry &note) {
+  beginResetModel();
+  m_blocks = note ? note->blocks : QVector<NoteBlock>();
+  m_source = note ? note->body().toUtf8() : QByteArray();
+  endResetModel();
+
+  const QString color = note ? note->color : QString();
+  if (m_color != color) {
+    m_color = color;
+    emit colorChanged();
+  }
+
+  m_loading = false;
+  emit loadingChanged();
+
+  // Read ahead only now, so the shown note never waits behind its links
+  if (note)
+    ParsedNoteCache::instance()->prefetchLinks(note->path);
 }
 
 void NoteBlockModel::onParseFinished() {
   beginResetModel();
   m_blocks = m_watcher->result();
+  m_source = std::exchange(m_loadSource, QByteArray());
   endResetModel();
 
   m_loading = false;
@@ -109,6 +347,16 @@ void NoteBlockModel::updateBlock(int row, const QString &text) {
   if (row < 0 || row >= m_blocks.size())
     return;
 
+  applyUpdate(row, text);
+
+  // Keep the markdown in step for the next reparse around it
+  QByteArray markdown = blockMarkdown(m_blocks[row]).toUtf8();
+  while (markdown.endsWith('\n'))
+    markdown.chop(1);
+  writeSource(row, markdown);
+}
+
+void NoteBlockModel::applyUpdate(int row, const QString &text) {
   QString finalContent = text;
 
   // Check if this is a paragraph being converted to a code block
@@ -231,56 +479,220 @@ void NoteBlockModel::insertBlock(int row, const QString &typeString,
   else
     block.type = BlockType::Paragraph;
 
+  // Placed right after the block before it, with no markdown yet
+  block.sourceBegin = block.sourceEnd = row > 0 ? m_blocks[row - 1].sourceEnd
+                                                : 0;
   m_blocks.insert(row, block);
   endInsertRows();
+
+  QByteArray markdown = blockMarkdown(block).toUtf8();
+  while (markdown.endsWith('\n'))
+    markdown.chop(1);
+  writeSource(row, markdown);
 }
 
 void NoteBlockModel::replaceBlock(int row, const QString &text) {
   if (row < 0 || row >= m_blocks.size())
     return;
 
-  // Parse the new text
-  // We use the static parse method directly
-  QVector<NoteBlock> newBlocks = MarkdownParser::parse(text);
-
-  if (newBlocks.isEmpty()) {
-    // If text is empty or meaningless, maybe we should just remove the block?
-    // Or replace with empty paragraph?
-    // Let's assume empty text -> empty paragraph
-    NoteBlock emptyBlock;
-    emptyBlock.type = BlockType::Paragraph;
-    emptyBlock.content = "";
-    newBlocks.append(emptyBlock);
-  }
-
-  // Optimize for 1-to-1 replacement (common case)
-  if (newBlocks.size() == 1) {
-    m_blocks[row] = newBlocks.first();
-    QVector<int> roles = {TypeRole, ContentRole, LevelRole, MetadataRole,
-                          LanguageRole};
+  if (text.trimmed().isEmpty()) {
+    // An empty paragraph to type into; it has no markdown
+    writeSource(row, QByteArray());
+    NoteBlock &block = m_blocks[row];
+    block.type = BlockType::Paragraph;
+    block.content.clear();
+    block.metadata.clear();
+    block.level = 0;
+    block.language.clear();
+    QVector<int> roles = {TypeRole,     ContentRole,  LevelRole,
+                          MetadataRole, LanguageRole, FormattedContentRole};
     emit dataChanged(createIndex(row, 0), createIndex(row, 0), roles);
     return;
   }
 
-  // Remove old block
-  beginRemoveRows(QModelIndex(), row, row);
-  m_blocks.removeAt(row);
-  endRemoveRows();
+  QByteArray markdown = text.toUtf8();
+  if (!markdown.endsWith('\n'))
+    markdown.append('\n');
+  const NoteBlock &block = m_blocks[row];
+  if (isPlaceholder(block))
+    markdown = padded(row, markdown, nullptr);
+  reparse(row, row, block.sourceBegin, block.sourceEnd, markdown);
+}
 
-  // Insert new blocks
-  if (!newBlocks.isEmpty()) {
-    beginInsertRows(QModelIndex(), row, row + newBlocks.size() - 1);
-    for (int i = 0; i < newBlocks.size(); ++i) {
-      m_blocks.insert(row + i, newBlocks[i]);
+void NoteBlockModel::reparse(int first, int last, qsizetype begin,
+                             qsizetype end, const QByteArray &text) {
+  m_source.replace(begin, end - begin, text);
+  shiftSpans(last + 1, text.size() - (end - begin));
+
+  // Back to a block that nothing before it can read differently
+  int lo = first;
+  while (lo > 0 && (isPlaceholder(m_blocks[lo]) ||
+                    !isCleanCut(m_blocks[lo].sourceBegin)))
+    --lo;
+  const qsizetype windowBegin = lo > 0 ? m_blocks[lo].sourceBegin : 0;
+
+  // On until a block after the edit reads exactly as before, from which
+  // on nothing changed. Each miss takes in twice as many blocks, so an
+  // unterminated fence that swallows the rest of the note costs a few
+  // parses, not one per block.
+  int next = last + 1;
+  int step = 1;
+  qsizetype windowEnd = 0;
+  QVector<NoteBlock> blocks;
+  for (;;) {
+    while (next < m_blocks.size() && isPlaceholder(m_blocks[next]))
+      ++next;
+    windowEnd =
+        next < m_blocks.size() ? m_blocks[next].sourceEnd : m_source.size();
+    blocks =
+        MarkdownParser::parse(m_source, windowBegin, windowEnd - windowBegin);
+    if (next >= m_blocks.size())
+      break;
+    const NoteBlock &check = m_blocks[next];
+    if (!blocks.isEmpty() && blocks.last().sourceBegin == check.sourceBegin &&
+        blocks.last().sourceEnd == check.sourceEnd &&
+        sameBlock(blocks.last(), check)) {
+      blocks.removeLast();
+      break;
     }
+    next = qMin(next + step, int(m_blocks.size()));
+    step *= 2;
+  }
+  const int hi = next - 1;
+
+  // Empty paragraphs around the edit have no markdown to be read from
+  int at = 0;
+  for (int row = lo; row <= hi; ++row) {
+    if ((row >= first && row <= last) || !isPlaceholder(m_blocks[row]))
+      continue;
+    while (at < blocks.size() &&
+           blocks[at].sourceBegin < m_blocks[row].sourceBegin)
+      ++at;
+    blocks.insert(at++, m_blocks[row]);
+  }
+
+  // Rows that read the same keep their delegates: only their spans move
+  const int oldCount = hi - lo + 1;
+  const int newCount = blocks.size();
+  int head = 0;
+  while (head < oldCount && head < newCount &&
+         sameBlock(m_blocks[lo + head], blocks[head])) {
+    m_blocks[lo + head].sourceBegin = blocks[head].sourceBegin;
+    m_blocks[lo + head].sourceEnd = blocks[head].sourceEnd;
+    ++head;
+  }
+  int tail = 0;
+  while (tail < oldCount - head && tail < newCount - head &&
+         sameBlock(m_blocks[hi - tail], blocks[newCount - 1 - tail])) {
+    m_blocks[hi - tail].sourceBegin = blocks[newCount - 1 - tail].sourceBegin;
+    m_blocks[hi - tail].sourceEnd = blocks[newCount - 1 - tail].sourceEnd;
+    ++tail;
+  }
+
+  const int row = lo + head;
+  const int changed = qMin(oldCount, newCount) - head - tail;
+  for (int i = 0; i < changed; ++i)
+    m_blocks[row + i] = blocks[head + i];
+  if (changed > 0) {
+    QVector<int> roles = {TypeRole,     ContentRole,  LevelRole,
+                          MetadataRole, LanguageRole, FormattedContentRole};
+    emit dataChanged(createIndex(row, 0), createIndex(row + changed - 1, 0),
+                     roles);
+  }
+  if (newCount > oldCount) {
+    const int from = row + changed;
+    const int count = newCount - oldCount;
+    beginInsertRows(QModelIndex(), from, from + count - 1);
+    m_blocks.insert(from, count, NoteBlock());
+    for (int i = 0; i < count; ++i)
+      m_blocks[from + i] = blocks[head + changed + i];
     endInsertRows();
+  } else if (oldCount > newCount) {
+    const int from = row + changed;
+    const int count = oldCount - newCount;
+    beginRemoveRows(QModelIndex(), from, from + count - 1);
+    m_blocks.remove(from, count);
+    endRemoveRows();
+  }
+}
+
+void NoteBlockModel::writeSource(int row, QByteArray markdown) {
+  NoteBlock &block = m_blocks[row];
+  const qsizetype begin = block.sourceBegin;
+  const qsizetype length = block.sourceEnd - begin;
+  const qsizetype size = markdown.isEmpty() ? 0 : markdown.size() + 1;
+  qsizetype lead = 0;
+  if (!markdown.isEmpty()) {
+    markdown.append('\n');
+    if (length == 0)
+      markdown = padded(row, markdown, &lead);
   }
+
+  m_source.replace(begin, length, markdown);
+  block.sourceBegin = int(begin + lead);
+  block.sourceEnd = int(begin + lead + size);
+  shiftSpans(row + 1, markdown.size() - length);
+}
+
+QByteArray NoteBlockModel::padded(int row, QByteArray markdown,
+                                  qsizetype *lead) const {
+  // Markdown put where a block had none gets blank lines around it, so it
+  // does not run into its neighbours; not between items of one list,
+  // which a blank line would make a loose list
+  const qsizetype at = m_blocks[row].sourceBegin;
+  const bool item = isListItem(QByteArrayView(markdown));
+  const bool listBefore = item && row > 0 && isListBlock(m_blocks[row - 1]);
+  const bool listAfter =
+      item && row + 1 < m_blocks.size() && isListBlock(m_blocks[row + 1]);
+
+  QByteArray before;
+  if (at > 0 && m_source[at - 1] != '\n')
+    before.append('\n');
+  if (at > 0 && !listBefore &&
+      (before.size() > 0 || at < 2 || m_source[at - 2] != '\n'))
+    before.append('\n');
+  if (at < m_source.size() && m_source[at] != '\n' && !listAfter)
+    markdown.append('\n');
+  if (lead)
+    *lead = before.size();
+  return before + markdown;
+}
+
+void NoteBlockModel::shiftSpans(int row, qsizetype delta) {
+  if (delta == 0)
+    return;
+  for (int i = row; i < m_blocks.size(); ++i) {
+    m_blocks[i].sourceBegin += int(delta);
+    m_blocks[i].sourceEnd += int(delta);
+  }
+}
+
+bool NoteBlockModel::isCleanCut(qsizetype pos) const {
+  if (pos <= 0)
+    return true;
+  if (pos >= m_source.size() || m_source[pos - 1] != '\n')
+    return false;
+
+  // The line before must be blank...
+  for (qsizetype at = pos - 1; at > 0 && m_source[at - 1] != '\n'; --at) {
+    const char c = m_source[at - 1];
+    if (c != ' ' && c != '\t' && c != '\r')
+      return false;
+  }
+  // ...and this one neither indented nor another item of a list above
+  qsizetype eol = m_source.indexOf('\n', pos);
+  if (eol < 0)
+    eol = m_source.size();
+  const QByteArrayView line(m_source.constData() + pos, eol - pos);
+  return !line.isEmpty() && line[0] != ' ' && line[0] != '\t' &&
+         !isListItem(line);
 }
 
 void NoteBlockModel::removeBlock(int row) {
   if (row < 0 || row >= m_blocks.size())
     return;
 
+  writeSource(row, QByteArray());
   beginRemoveRows(QModelIndex(), row, row);
   m_blocks.removeAt(row);
   endRemoveRows();
@@ -288,99 +700,8 @@ void NoteBlockModel::removeBlock(int row) {
 
 QString NoteBlockModel::getMarkdown() const {
   QString result;
-  for (const NoteBlock &block : m_blocks) {
-    // Reconstruct based on type
-    switch (block.type) {
-    case BlockType::Heading:
-      result.append(QString(block.level, '#') + " " + block.content + "\n\n");
-      break;
-    case BlockType::Code: {
-      // Trim content to prevent newline accumulation
-      QString codeContent = block.content;
-      // Remove leading/trailing newlines only (preserve internal whitespace)
-      while (codeContent.startsWith('\n') || codeContent.startsWith('\r')) {
-        codeContent = codeContent.mid(1);
-      }
-      while (codeContent.endsWith('\n') || codeContent.endsWith('\r')) {
-        codeContent.chop(1);
-      }
-      result.append("```" + block.language + "\n" + codeContent + "\n```\n\n");
-    } break;
-    case BlockType::Quote: {
-      QStringList lines = block.content.split('\n');
-      for (const QString &line : lines) {
-        result.append("> " + line + "\n");
-      }
-      result.append("\n");
-    } break;
-    case BlockType::Callout: {
-      result.append("> [!" +
-                    block.metadata["calloutType"].toString().toUpper() + "] " +
-                    block.metadata["title"].toString() + "\n");
-      QStringList lines = block.content.split('\n');
-      for (const QString &line : lines) {
-        result.append("> " + line + "\n");
-      }
-      result.append("\n");
-    } break;
-    case BlockType::TaskList: {
-      QString mark = " ";
-      if (block.metadata.contains("taskStatus")) {
-        mark = block.metadata["taskStatus"].toString();
-      } else {
-        mark = block.metadata["checked"].toBool() ? "x" : " ";
-      }
-      result.append(QString("- [%1] %2\n").arg(mark).arg(block.content));
-    } break;
-    case BlockType::Embed:
-      // Reconstruct ![[Note#Section]]
-      result.append(QString("![[%1]]\n\n").arg(block.content));
-      break;
-    case BlockType::Image:
-
-      // Identify if it was likely an obsidian link (no path separation) or md
-      // link
-      result.append(QString("![[%1]]\n\n").arg(block.content));
-      break;
-    case BlockType::List: {
-      // Check metadata for ordered vs unordered
-      bool isOrdered = block.metadata["listType"].toString() == "ordered";
-      if (isOrdered) {
-        // We could track index, but for now simple reconstruction:
-        result.append("1. " + block.content + "\n");
-      } else {
-        result.append("* " + block.content + "\n");
-      }
-    } break;
-    case BlockType::ThematicBreak:
-      result.append("---\n\n");
-      break;
-    case BlockType::Table: {
-      // Reconstruct markdown table from metadata rows
-      QVariantList rows = block.metadata["rows"].toList();
-      for (int i = 0; i < rows.size(); ++i) {
-        QVariantList cells = rows[i].toList();
-        result.append("|");
-        for (const QVariant &cell : cells) {
-          result.append(" " + cell.toString() + " |");
-        }
-        result.append("\n");
-        // Add separator row after header (first row)
-        if (i == 0 && !cells.isEmpty()) {
-          result.append("|");
-          for (int j = 0; j < cells.size(); ++j) {
-            result.append(" --- |");
-          }
-          result.append("\n");
-        }
-      }
-      result.append("\n");
-    } break;
-    default:
-      result.append(block.content + "\n\n");
-      break;
-    }
-  }
+  for (const NoteBlock &block : m_blocks)
+    result.append(blockMarkdown(block));
   return result.trimmed();
 }
 
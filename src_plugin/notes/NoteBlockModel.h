@@ -2,16 +2,30 @@
 #define NOTEBLOCKMODEL_H
 
 #include "NoteBlock.h"
+#include "ParsedNoteCache.h"
 #include <QAbstractListModel>
 #include <QFutureWatcher>
 #include <QVariant>
 #include <QVector>
 #include <QtQml>
 
+/**
+ * @brief The blocks of the note being edited, for the editor's list view.
+ *
+ * The model keeps the markdown the blocks were read from, each block
+ * holding its span in it. An edit replaces one block's markdown and
+ * reparses just that stretch: from the closest block before it that
+ * starts a fresh context (see isCleanCut()) up to the first block after it
+ * that reads as before, so an edit that opens a code fence or joins a list
+ * reaches as far as it must, and no further. Only rows that changed are
+ * signalled.
+ */
 class NoteBlockModel : public QAbstractListModel {
   Q_OBJECT
   QML_ELEMENT
   Q_PROPERTY(bool loading READ loading NOTIFY loadingChanged)
+  // Frontmatter color of the note shown by loadNote()
+  Q_PROPERTY(QString color READ color NOTIFY colorChanged)
 
 public:
   enum NoteBlockRoles {
@@ -32,11 +46,28 @@ public:
   QHash<int, QByteArray> roleNames() const override;
 
   bool loading() const { return m_loading; }
+  QString color() const { return m_color; }
 
+  /**
+   * @brief Shows @p content, parsed in the background. Reloading the
+   * document shown with a small change (say, after it changed on disk)
+   * reparses just the change.
+   */
   Q_INVOKABLE void loadMarkdown(const QString &content);
+  /**
+   * @brief Shows the note at @p path, from ParsedNoteCache at once if it
+   * was parsed recently, otherwise parsed in the background and cached.
+   * Once it is shown, the notes it links to are read ahead.
+   */
+  Q_INVOKABLE void loadNote(const QString &path);
   Q_INVOKABLE void updateBlock(int index, const QString &text);
   Q_INVOKABLE void insertBlock(int index, const QString &type,
                                const QString &content);
+  /**
+   * @brief Replaces the markdown of block @p index with @p text, which may
+   * read as several blocks or none, and reparses the blocks it affects.
+   * Empty text leaves an empty paragraph.
+   */
   Q_INVOKABLE void replaceBlock(int index, const QString &text);
   Q_INVOKABLE void removeBlock(int index);
   Q_INVOKABLE QString getMarkdown() const;
@@ -44,15 +75,47 @@ public:
 
 signals:
   void loadingChanged();
+  void colorChanged();
 
 private slots:
   void onParseFinished();
+  void onNoteParsed();
 
 private:
+  // Changes up to this size reload in place instead of parsing afresh
+  static constexpr qsizetype kIncrementalReloadBytes = 64 * 1024;
+
+  void cancelLoad();
+  void showNote(const ParsedNoteCache::Entry &note);
+  void applyUpdate(int row, const QString &text);
+  bool reloadIncrementally(const QByteArray &source);
+
+  /**
+   * @brief Replaces bytes [@p begin, @p end) of the source, which rows
+   * @p first to @p last were read from, with @p text and reparses them
+   * with as much context as the edit needs.
+   */
+  void reparse(int first, int last, qsizetype begin, qsizetype end,
+               const QByteArray &text);
+  /** @brief Replaces the markdown of @p row without reparsing. */
+  void writeSource(int row, QByteArray markdown);
+  QByteArray padded(int row, QByteArray markdown, qsizetype *lead) const;
+  void shiftSpans(int row, qsizetype delta);
+  /**
+   * @brief Whether parsing may start at @p pos, the start of a block, and
+   * read the rest as the whole document does: the document start, or a
+   * line at column 0 after a blank line that is not a list item.
+   */
+  bool isCleanCut(qsizetype pos) const;
+
   QVector<NoteBlock> m_blocks;
+  QByteArray m_source;     // the markdown m_blocks' spans point into
+  QByteArray m_loadSource; // of the loadMarkdown() being parsed
   bool m_loading = false;
   bool m_darkMode = true; // Theme for formatted content
   QFutureWatcher<QVector<NoteBlock>> *m_watcher;
+  QFutureWatcher<ParsedNoteCache::Entry> *m_noteWatcher;
+  QString m_color;
 };
 
 #endif // NOTEBLOCKMODEL_H
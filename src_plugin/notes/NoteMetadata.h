@@ -0,0 +1,25 @@
+#pragma once
+
+#include "NoteOutline.h"
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Lightweight metadata structure - NO content stored
+ */
+struct NoteMetadata {
+  QString filePath;
+  QString title;
+  QStringList tags;
+  QStringList aliases; // Other names [[links]] may use for the note
+  QStringList links;   // Notes the body links to (see NotesStore::linkTarget)
+  QDateTime lastModified;
+  qint64 fileSize = 0;
+  bool isPinned = false;
+  bool isFolder = false;
+  bool hasTasks = false; // Body has an open "- [ ]" task
+  QString color;
+  QString preview; // Start of the body as plain text (see extractPreview)
+  NoteOutline outline; // Headings and ^block-ids with their byte ranges
+};
@@ -0,0 +1,187 @@
+#include "NoteOutline.h"
+#include <cctype>
+
+namespace {
+bool isSpace(char c) { return c == ' ' || c == '\t'; }
+
+// Length of the ``` or ~~~ run opening a fence on @p line, or 0
+qsizetype fenceRun(QByteArrayView line, char *fenceChar) {
+  qsizetype indent = 0;
+  while (indent < line.size() && indent < 3 && line[indent] == ' ')
+    ++indent;
+  if (indent >= line.size() || (line[indent] != '`' && line[indent] != '~'))
+    return 0;
+  const char c = line[indent];
+  qsizetype run = 0;
+  while (indent + run < line.size() && line[indent + run] == c)
+    ++run;
+  if (run < 3)
+    return 0;
+  *fenceChar = c;
+  return run;
+}
+
+// Start of a trailing "^id" marker on @p line (already right-trimmed), or -1
+qsizetype blockMarker(QByteArrayView line) {
+  qsizetype caret = line.size() - 1;
+  while (caret >= 0 && (std::isalnum(uchar(line[caret])) ||
+                        line[caret] == '-' || line[caret] == '_'))
+    --caret;
+  if (caret < 0 || line[caret] != '^' || caret == line.size() - 1)
+    return -1;
+  if (caret > 0 && !isSpace(line[caret - 1]))
+    return -1; // "x^2" is not a marker
+  return caret;
+}
+} // namespace
+
+NoteOutline NoteOutline::parse(const QByteArray &data, qsizetype bodyOffset) {
+  NoteOutline outline;
+  QVector<int> open; // headings whose section has not ended yet
+  char fence = 0;
+  qsizetype fenceLength = 0;
+  qsizetype blockBegin = -1; // start of the block being read
+  qsizetype blockEnd = 0;    // end of its last line so far
+  qsizetype lastBegin = -1;  // the block before a blank line
+  qsizetype lastEnd = 0;
+
+  auto addAnchor = [&outline](QString name, qsizetype begin, qsizetype end,
+                              int level) {
+    outline.anchors.append({std::move(name), quint32(begin), quint32(end),
+                            quint8(level)});
+  };
+
+  const qsizetype size = data.size();
+  qsizetype pos = qBound(qsizetype(0), bodyOffset, size);
+  while (pos < size) {
+    qsizetype eol = data.indexOf('\n', pos);
+    if (eol < 0)
+      eol = size;
+    const qsizetype next = eol < size ? eol + 1 : size;
+    QByteArrayView line(data.constData() + pos, eol - pos);
+    while (!line.isEmpty() && (line.back() == '\r' || isSpace(line.back())))
+      line.chop(1);
+    const qsizetype lineEnd = pos + line.size();
+
+    char c = 0;
+    qsizetype run = 0;
+    if (fence) {
+      // Only a run at least as long as the opening one closes the fence
+      run = fenceRun(line, &c);
+      if (c == fence && run >= fenceLength &&
+          line.trimmed().size() == run) {
+        fence = 0;
+      }
+      blockEnd = lineEnd;
+      pos = next;
+      continue;
+    }
+    if ((run = fenceRun(line, &c)) > 0) {
+      fence = c;
+      fenceLength = run;
+      if (blockBegin < 0)
+        blockBegin = pos;
+      blockEnd = lineEnd;
+      pos = next;
+      continue;
+    }
+
+    if (line.trimmed().isEmpty()) {
+      if (blockBegin >= 0) {
+        lastBegin = blockBegin;
+        lastEnd = blockEnd;
+      }
+      blockBegin = -1;
+      pos = next;
+      continue;
+    }
+
+    qsizetype hashes = 0;
+    while (hashes < line.size() && hashes < 6 && line[hashes] == '#')
+      ++hashes;
+    if (hashes > 0 && hashes < line.size() && isSpace(line[hashes])) {
+      // Ends every open section of the same or a deeper level
+      while (!open.isEmpty() && outline.anchors[open.last()].level >= hashes)
+        outline.anchors[open.takeLast()].end = quint32(pos);
+      open.append(int(outline.anchors.size()));
+      addAnchor(QString::fromUtf8(line.mid(hashes).trimmed()), next, size,
+                int(hashes));
+      blockBegin = lastBegin = -1;
+      pos = next;
+      continue;
+    }
+
+    const qsizetype marker = blockMarker(line);
+    if (marker < 0) {
+      if (blockBegin < 0)
+        blockBegin = pos;
+      blockEnd = lineEnd;
+    } else if (line.left(marker).trimmed().isEmpty()) {
+      // "^id" alone names the block right above it, blank line or not
+      const QString id = QString::fromUtf8(line.mid(marker + 1));
+      if (blockBegin >= 0)
+        addAnchor(id, blockBegin, blockEnd, 0);
+      else if (lastBegin >= 0)
+        addAnchor(id, lastBegin, lastEnd, 0);
+      blockBegin = lastBegin = -1;
+    } else {
+      qsizetype end = marker;
+      while (end > 0 && isSpace(line[end - 1]))
+        --end;
+      addAnchor(QString::fromUtf8(line.mid(marker + 1)), pos, pos + end, 0);
+      if (blockBegin < 0)
+        blockBegin = pos;
+      blockEnd = lineEnd;
+    }
+    pos = next;
+  }
+  return outline;
+}
+
+const NoteOutline::Anchor *NoteOutline::heading(QStringView name) const {
+  const QStringView wanted = name.trimmed();
+  for (const Anchor &anchor : anchors) {
+    if (anchor.level > 0 &&
+        QStringView(anchor.name).compare(wanted, Qt::CaseInsensitive) == 0)
+      return &anchor;
+  }
+  return nullptr;
+}
+
+const NoteOutline::Anchor *NoteOutline::block(QStringView id) const {
+  for (const Anchor &anchor : anchors) {
+    if (anchor.level == 0 && anchor.name == id)
+      return &anchor;
+  }
+  return nullptr;
+}
+
+QString NoteOutline::toString() const {
+  QString text;
+  for (const Anchor &anchor : anchors) {
+    text += QString::number(anchor.level) + QLatin1Char(' ') +
+            QString::number(anchor.begin) + QLatin1Char(' ') +
+            QString::number(anchor.end) + QLatin1Char(' ') + anchor.name +
+            QLatin1Char('\n');
+  }
+  return text;
+}
+
+NoteOutline NoteOutline::fromString(const QString &text) {
+  NoteOutline outline;
+  for (QStringView line : QStringView(text).split(u'\n', Qt::SkipEmptyParts)) {
+    // The name comes last and may itself contain spaces
+    const qsizetype first = line.indexOf(u' ');
+    const qsizetype second = line.indexOf(u' ', first + 1);
+    const qsizetype third = line.indexOf(u' ', second + 1);
+    if (first < 0 || second < 0 || third < 0)
+      continue;
+    Anchor anchor;
+    anchor.level = quint8(line.left(first).toUInt());
+    anchor.begin = line.mid(first + 1, second - first - 1).toUInt();
+    anchor.end = line.mid(second + 1, third - second - 1).toUInt();
+    anchor.name = line.mid(third + 1).toString();
+    outline.anchors.append(anchor);
+  }
+  return outline;
+}
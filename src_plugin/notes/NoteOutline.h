@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+/**
+ * @brief Where a note's headings and ^block-ids are, as byte ranges of
+ * its file.
+ *
+ * Built while the index reads a note anyway, so embedding a section
+ * ([[Note#Heading]]) or a block ([[Note#^id]]) reads just that range.
+ * Ranges are only valid for the file size and modification time they were
+ * taken at, i.e. those of the note's NotesStore entry.
+ */
+struct NoteOutline {
+  struct Anchor {
+    QString name;      // heading text, or block ID without the '^'
+    quint32 begin = 0; // first byte of the content
+    quint32 end = 0;   // one past its last byte
+    quint8 level = 0;  // 1-6 for headings, 0 for blocks
+  };
+
+  QVector<Anchor> anchors; // in file order
+
+  /**
+   * @brief Scans the note bytes from @p bodyOffset (past the frontmatter).
+   *
+   * A heading's range is its section: from the line after it up to the
+   * next heading of the same or a higher level, nested headings included.
+   * A block is the line ending in " ^id", without the marker; an ID on a
+   * line of its own names the paragraph, list or fenced block just above
+   * it. Fenced code is skipped.
+   */
+  static NoteOutline parse(const QByteArray &data, qsizetype bodyOffset);
+
+  /** @brief First heading named @p name (case-insensitive), or null. */
+  const Anchor *heading(QStringView name) const;
+  /** @brief Block with ID @p id, or null. */
+  const Anchor *block(QStringView id) const;
+
+  bool isEmpty() const { return anchors.isEmpty(); }
+
+  /** @brief One "level begin end name" line per anchor, for the cache. */
+  QString toString() const;
+  static NoteOutline fromString(const QString &text);
+};
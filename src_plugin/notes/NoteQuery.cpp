@@ -0,0 +1,618 @@
+#include "NoteQuery.h"
+#include <QDate>
+#include <QDir>
+#include <algorithm>
+#include <limits>
+
+namespace {
+struct Token {
+  enum Type : quint8 { Word, Open, Close, And, Or, Not };
+  Type type = Word;
+  QString field; // lowercased, empty for plain text
+  QString text;
+};
+
+bool isKnownField(const QString &field) {
+  return field == QLatin1String("tag") || field == QLatin1String("path") ||
+         field == QLatin1String("title") || field == QLatin1String("has") ||
+         field == QLatin1String("modified");
+}
+
+// Reads a "quoted" run starting at @p at (the opening quote); a missing
+// closing quote runs to the end
+QString readQuoted(const QString &text, qsizetype &at) {
+  qsizetype end = text.indexOf(QLatin1Char('"'), at + 1);
+  if (end < 0)
+    end = text.size();
+  QString quoted = text.mid(at + 1, end - at - 1);
+  at = qMin(end + 1, text.size());
+  return quoted;
+}
+
+QVector<Token> tokenize(const QString &text) {
+  QVector<Token> tokens;
+  const qsizetype n = text.size();
+  qsizetype i = 0;
+  while (i < n) {
+    const QChar c = text[i];
+    if (c.isSpace()) {
+      ++i;
+      continue;
+    }
+    if (c == u'(' || c == u')') {
+      tokens.append({c == u'(' ? Token::Open : Token::Close, {}, {}});
+      ++i;
+      continue;
+    }
+    if (c == u'-' && i + 1 < n && !text[i + 1].isSpace()) {
+      tokens.append({Token::Not, {}, {}});
+      ++i;
+      continue;
+    }
+    if (c == u'"') {
+      tokens.append({Token::Word, {}, readQuoted(text, i)});
+      continue;
+    }
+
+    // A word runs to whitespace or a parenthesis; field:"a b" is one word
+    const qsizetype start = i;
+    while (i < n && !text[i].isSpace() && text[i] != u'(' &&
+           text[i] != u')' && !(text[i] == u'"' && text[i - 1] == u':'))
+      ++i;
+    if (i < n && text[i] == u'"') {
+      const QString field = text.mid(start, i - 1 - start).toLower();
+      const QString value = readQuoted(text, i);
+      if (isKnownField(field))
+        tokens.append({Token::Word, field, value});
+      else
+        tokens.append({Token::Word, {}, field + QLatin1Char(':') + value});
+      continue;
+    }
+
+    const QString word = text.mid(start, i - start);
+    if (word == QLatin1String("AND")) {
+      tokens.append({Token::And, {}, {}});
+    } else if (word == QLatin1String("OR")) {
+      tokens.append({Token::Or, {}, {}});
+    } else if (word == QLatin1String("NOT")) {
+      tokens.append({Token::Not, {}, {}});
+    } else if (word.size() > 1 && word.startsWith(QLatin1Char('#'))) {
+      tokens.append({Token::Word, QStringLiteral("tag"), word.mid(1)});
+    } else {
+      const qsizetype colon = word.indexOf(QLatin1Char(':'));
+      const QString field = colon > 0 ? word.left(colon).toLower() : QString();
+      if (isKnownField(field))
+        tokens.append({Token::Word, field, word.mid(colon + 1)});
+      else
+        tokens.append({Token::Word, {}, word});
+    }
+  }
+  return tokens;
+}
+
+// [from, to) for "2024-01-31", ">2024-01-31", "<=7d" and the like; relative
+// values count days ("7d") or weeks ("2w") back from today
+bool parseDateRange(QStringView value, qint64 &from, qint64 &to) {
+  QStringView op;
+  for (const char *candidate : {">=", "<=", ">", "<", "="}) {
+    if (value.startsWith(QLatin1String(candidate))) {
+      op = value.left(qsizetype(qstrlen(candidate)));
+      value = value.mid(op.size());
+      break;
+    }
+  }
+
+  QDate date;
+  if (value.size() > 1 && (value.back() == u'd' || value.back() == u'w')) {
+    bool ok = false;
+    const int count = value.chopped(1).toInt(&ok);
+    if (ok && count >= 0)
+      date = QDate::currentDate().addDays(
+          -qint64(count) * (value.back() == u'w' ? 7 : 1));
+  } else {
+    date = QDate::fromString(value.toString(), Qt::ISODate);
+  }
+  if (!date.isValid())
+    return false;
+
+  const qint64 dayStart = date.startOfDay().toMSecsSinceEpoch();
+  const qint64 dayEnd = date.addDays(1).startOfDay().toMSecsSinceEpoch();
+  from = std::numeric_limits<qint64>::min();
+  to = std::numeric_limits<qint64>::max();
+  if (op == QLatin1String(">")) {
+    from = dayEnd;
+  } else if (op == QLatin1String(">=")) {
+    from = dayStart;
+  } else if (op == QLatin1String("<")) {
+    to = dayStart;
+  } else if (op == QLatin1String("<=")) {
+    to = dayEnd;
+  } else {
+    from = dayStart;
+    to = dayEnd;
+  }
+  return true;
+}
+
+// "project/alpha" falls under "project"; @p key is lowercased
+bool isTagOrNested(const QString &tag, const QString &key) {
+  return tag.startsWith(key, Qt::CaseInsensitive) &&
+         (tag.size() == key.size() || tag[key.size()] == u'/');
+}
+
+void appendNotesUnder(const NotesStore &store, const QString &dirPath,
+                      QVector<NoteId> &out) {
+  for (NoteId id : store.children(dirPath)) {
+    if (store.isFolder(id))
+      appendNotesUnder(store, store.path(id), out);
+    else
+      out.append(id);
+  }
+}
+
+QVector<NoteId> sortedUnion(const QVector<NoteId> &a,
+                            const QVector<NoteId> &b) {
+  QVector<NoteId> out;
+  out.reserve(a.size() + b.size());
+  std::set_union(a.cbegin(), a.cend(), b.cbegin(), b.cend(),
+                 std::back_inserter(out));
+  return out;
+}
+} // namespace
+
+// Recursive descent over the tokens; -1 stands for "no node" (an empty
+// group, a dangling NOT) and is dropped by the caller
+class NoteQuery::Parser {
+public:
+  Parser(NoteQuery &query, QVector<Token> tokens, const QString &rootPath)
+      : m_query(query), m_tokens(std::move(tokens)),
+        m_rootPath(QDir::cleanPath(rootPath)) {}
+
+  int parseOr(int depth) {
+    QVector<int> parts{parseAnd(depth)};
+    while (m_pos < m_tokens.size() && m_tokens[m_pos].type == Token::Or) {
+      ++m_pos;
+      parts.append(parseAnd(depth));
+    }
+    return combine(Kind::Or, parts);
+  }
+
+private:
+  int parseAnd(int depth) {
+    QVector<int> parts;
+    while (m_pos < m_tokens.size()) {
+      const Token::Type type = m_tokens[m_pos].type;
+      if (type == Token::Or || (type == Token::Close && depth > 0))
+        break;
+      if (type == Token::And || type == Token::Close) {
+        ++m_pos; // a stray ')' at the top level is ignored
+        continue;
+      }
+      parts.append(parseUnary(depth));
+    }
+    return combine(Kind::And, parts);
+  }
+
+  int parseUnary(int depth) {
+    if (m_pos >= m_tokens.size())
+      return -1;
+    const Token &token = m_tokens[m_pos];
+    switch (token.type) {
+    case Token::Not: {
+      ++m_pos;
+      const int operand = parseUnary(depth);
+      if (operand < 0)
+        return -1;
+      Node node;
+      node.kind = Kind::Not;
+      node.children.append(operand);
+      return m_query.add(node);
+    }
+    case Token::Open: {
+      ++m_pos;
+      const int inner = parseOr(depth + 1);
+      if (m_pos < m_tokens.size() && m_tokens[m_pos].type == Token::Close)
+        ++m_pos;
+      return inner;
+    }
+    case Token::Word:
+      ++m_pos;
+      return leaf(token);
+    default:
+      return -1; // operator without an operand
+    }
+  }
+
+  int combine(Kind kind, QVector<int> parts) {
+    parts.removeAll(-1);
+    if (parts.size() <= 1)
+      return parts.isEmpty() ? -1 : parts.first();
+    Node node;
+    node.kind = kind;
+    node.children = std::move(parts);
+    return m_query.add(node);
+  }
+
+  int leaf(const Token &token) {
+    Node node;
+    const QString &text = token.text;
+    if (token.field.isEmpty()) {
+      if (text.isEmpty())
+        return -1;
+      node.kind = Kind::Text;
+      node.value = text.toCaseFolded();
+      node.key = NotesStore::searchKey(text);
+    } else if (token.field == QLatin1String("tag")) {
+      node.kind = Kind::Tag;
+      node.value = text.startsWith(QLatin1Char('#')) ? text.mid(1) : text;
+      node.value = node.value.toLower();
+      if (node.value.isEmpty())
+        return -1;
+    } else if (token.field == QLatin1String("path")) {
+      if (text.isEmpty())
+        return -1;
+      // "dir/" keeps its slash so it does not match "dir2/"
+      node.kind = Kind::Path;
+      node.value = QDir::cleanPath(QDir::isAbsolutePath(text)
+                                       ? text
+                                       : m_rootPath + QLatin1Char('/') + text);
+      if (text.endsWith(QLatin1Char('/')) &&
+          !node.value.endsWith(QLatin1Char('/')))
+        node.value += QLatin1Char('/');
+    } else if (token.field == QLatin1String("title")) {
+      node.kind = Kind::Title;
+      node.key = NotesStore::searchKey(text);
+      if (node.key.isEmpty())
+        return -1;
+    } else if (token.field == QLatin1String("has")) {
+      const QString what = text.toLower();
+      if (what == QLatin1String("task") || what == QLatin1String("tasks") ||
+          what == QLatin1String("todo"))
+        node.kind = Kind::Task;
+    } else if (token.field == QLatin1String("modified")) {
+      if (parseDateRange(text, node.from, node.to))
+        node.kind = Kind::Modified;
+    }
+    return m_query.add(node);
+  }
+
+  NoteQuery &m_query;
+  QVector<Token> m_tokens;
+  QString m_rootPath;
+  qsizetype m_pos = 0;
+};
+
+struct NoteQuery::Context {
+  const NotesStore &store;
+  const TextCandidates &textCandidates;
+  QVector<NoteId> notes;
+  bool notesListed = false;
+
+  // Every note (no folders), sorted
+  const QVector<NoteId> &allNotes() {
+    if (!notesListed) {
+      notes.reserve(store.size());
+      for (NoteId id = 0; id < store.idLimit(); ++id) {
+        if (store.isAlive(id) && !store.isFolder(id))
+          notes.append(id);
+      }
+      notesListed = true;
+    }
+    return notes;
+  }
+};
+
+NoteQuery NoteQuery::parse(const QString &text, const QString &rootPath) {
+  NoteQuery query;
+  Parser parser(query, tokenize(text), rootPath);
+  query.m_root = parser.parseOr(0);
+  return query;
+}
+
+int NoteQuery::add(Node node) {
+  m_nodes.append(std::move(node));
+  return int(m_nodes.size()) - 1;
+}
+
+bool NoteQuery::needsText() const {
+  // Nodes the parser dropped are unreachable, so walk from the root
+  QVector<int> stack;
+  if (m_root >= 0)
+    stack.append(m_root);
+  while (!stack.isEmpty()) {
+    const Node &node = m_nodes[stack.takeLast()];
+    if (node.kind == Kind::Text)
+      return true;
+    stack.append(node.children);
+  }
+  return false;
+}
+
+QStringList NoteQuery::textTerms() const {
+  QStringList terms;
+  QVector<int> stack;
+  if (m_root >= 0)
+    stack.append(m_root);
+  while (!stack.isEmpty()) {
+    const Node &node = m_nodes[stack.takeLast()];
+    if (node.kind == Kind::Text && !terms.contains(node.value))
+      terms.append(node.value);
+    if (node.kind != Kind::Not)
+      stack.append(node.children);
+  }
+  return terms;
+}
+
+QVector<NoteId>
+NoteQuery::candidates(const NotesStore &store,
+                      const TextCandidates &textCandidates) const {
+  if (m_root < 0)
+    return {};
+  Context context{store, textCandidates, {}, false};
+  Result result = evaluate(m_root, context);
+  return result.all ? context.allNotes() : result.ids;
+}
+
+NoteQuery::Result NoteQuery::evaluate(int index, Context &context) const {
+  const Node &node = m_nodes[index];
+  const NotesStore &store = context.store;
+  Result result;
+
+  switch (node.kind) {
+  case Kind::And:
+    return evaluateAnd(node, context);
+
+  case Kind::Or:
+    for (int child : node.children) {
+      Result part = evaluate(child, context);
+      result.exact = result.exact && part.exact;
+      if (part.all)
+        result.all = true;
+      else if (!result.all)
+        result.ids = sortedUnion(result.ids, part.ids);
+    }
+    if (result.all)
+      result.ids.clear();
+    return result;
+
+  case Kind::Not: {
+    Result part = evaluate(node.children.first(), context);
+    if (!part.exact) {
+      // The complement of a superset says nothing; matches() decides
+      result.all = true;
+      result.exact = false;
+    } else if (!part.all) {
+      const QVector<NoteId> &notes = context.allNotes();
+      std::set_difference(notes.cbegin(), notes.cend(), part.ids.cbegin(),
+                          part.ids.cend(), std::back_inserter(result.ids));
+    }
+    return result;
+  }
+
+  case Kind::Tag:
+    result.ids = store.notesUnderTag(node.value);
+    return result;
+
+  case Kind::Path:
+    if (node.value.endsWith(QLatin1Char('/')) &&
+        store.hasDirectory(node.value.chopped(1))) {
+      appendNotesUnder(store, node.value.chopped(1), result.ids);
+      std::sort(result.ids.begin(), result.ids.end());
+      return result;
+    }
+    break; // not a folder as written: compare path prefixes
+
+  case Kind::Text: {
+    // Body candidates from the trigram index, plus notes matching by title
+    QVector<NoteId> titled;
+    for (NoteId id : context.allNotes()) {
+      if (store.titleKey(id).contains(node.key))
+        titled.append(id);
+    }
+    result.ids = sortedUnion(context.textCandidates(node.value), titled);
+    result.exact = false;
+    return result;
+  }
+
+  case Kind::Nothing:
+    return result;
+
+  case Kind::Title:
+  case Kind::Task:
+  case Kind::Modified:
+    break;
+  }
+
+  // Attribute filters: one pass over a column
+  for (NoteId id : context.allNotes()) {
+    if (test(index, store, id) == Truth::True)
+      result.ids.append(id);
+  }
+  return result;
+}
+
+NoteQuery::Result NoteQuery::evaluateAnd(const Node &node,
+                                         Context &context) const {
+  QVector<int> order = node.children;
+  std::stable_sort(order.begin(), order.end(),
+                   [this, &context](int a, int b) {
+                     return estimate(a, context) < estimate(b, context);
+                   });
+
+  Result running;
+  running.all = true;
+  for (int child : order) {
+    if (!running.all && running.ids.size() <= estimate(child, context)) {
+      // Fewer notes left than the part would fetch: check them one by one
+      qsizetype kept = 0;
+      for (NoteId id : std::as_const(running.ids)) {
+        const Truth truth = test(child, context.store, id);
+        if (truth == Truth::False)
+          continue;
+        if (truth == Truth::Unknown)
+          running.exact = false;
+        running.ids[kept++] = id;
+      }
+      running.ids.resize(kept);
+    } else {
+      Result part = evaluate(child, context);
+      running.exact = running.exact && part.exact;
+      if (part.all)
+        continue;
+      if (running.all) {
+        running.ids = std::move(part.ids);
+        running.all = false;
+      } else {
+        QVector<NoteId> both;
+        std::set_intersection(running.ids.cbegin(), running.ids.cend(),
+                              part.ids.cbegin(), part.ids.cend(),
+                              std::back_inserter(both));
+        running.ids.swap(both);
+      }
+    }
+
+    if (!running.all && running.ids.isEmpty()) {
+      running.exact = true; // nothing left to verify
+      break;
+    }
+  }
+  return running;
+}
+
+int NoteQuery::estimate(int index, const Context &context) const {
+  // Notes a part fetches when evaluated on its own; filters cost a scan
+  const Node &node = m_nodes[index];
+  const int notes = context.store.size();
+  switch (node.kind) {
+  case Kind::Nothing:
+    return 0;
+  case Kind::Tag:
+    return context.store.tagUseCount(node.value);
+  case Kind::Path:
+    return node.value.endsWith(QLatin1Char('/')) &&
+                   context.store.hasDirectory(node.value.chopped(1))
+               ? notes / 4
+               : notes;
+  case Kind::Text:
+    return notes / 2;
+  case Kind::And: {
+    int smallest = notes;
+    for (int child : node.children)
+      smallest = qMin(smallest, estimate(child, context));
+    return smallest;
+  }
+  case Kind::Or: {
+    qint64 sum = 0;
+    for (int child : node.children)
+      sum += estimate(child, context);
+    return int(qMin<qint64>(sum, notes));
+  }
+  case Kind::Not:
+  case Kind::Title:
+  case Kind::Task:
+  case Kind::Modified:
+    return notes;
+  }
+  return notes;
+}
+
+NoteQuery::Truth NoteQuery::test(int index, const NotesStore &store,
+                                 NoteId id) const {
+  const Node &node = m_nodes[index];
+  auto truth = [](bool value) { return value ? Truth::True : Truth::False; };
+
+  switch (node.kind) {
+  case Kind::And:
+  case Kind::Or: {
+    // And: any False decides; Or: any True decides
+    const Truth decisive = node.kind == Kind::And ? Truth::False : Truth::True;
+    bool unknown = false;
+    for (int child : node.children) {
+      const Truth part = test(child, store, id);
+      if (part == decisive)
+        return decisive;
+      unknown = unknown || part == Truth::Unknown;
+    }
+    if (unknown)
+      return Truth::Unknown;
+    return node.kind == Kind::And ? Truth::True : Truth::False;
+  }
+  case Kind::Not: {
+    const Truth part = test(node.children.first(), store, id);
+    if (part == Truth::Unknown)
+      return part;
+    return truth(part == Truth::False);
+  }
+  case Kind::Text:
+    return store.titleKey(id).contains(node.key) ? Truth::True
+                                                 : Truth::Unknown;
+  case Kind::Tag:
+    for (quint32 tagId : store.tagIds(id)) {
+      if (isTagOrNested(store.tagName(tagId), node.value))
+        return Truth::True;
+    }
+    return Truth::False;
+  case Kind::Path:
+    return truth(store.path(id).startsWith(node.value, Qt::CaseInsensitive));
+  case Kind::Title:
+    return truth(store.titleKey(id).contains(node.key));
+  case Kind::Task:
+    return truth(store.hasTasks(id));
+  case Kind::Modified:
+    return truth(store.mtimeMs(id) >= node.from &&
+                 store.mtimeMs(id) < node.to);
+  case Kind::Nothing:
+    return Truth::False;
+  }
+  return Truth::False;
+}
+
+bool NoteQuery::matches(const NoteMetadata &meta,
+                        const QString &foldedText) const {
+  if (m_root < 0 || meta.isFolder)
+    return false;
+  return matches(m_root, meta, NotesStore::searchKey(meta.title), foldedText);
+}
+
+bool NoteQuery::matches(int index, const NoteMetadata &meta,
+                        const QString &titleKey,
+                        const QString &foldedText) const {
+  const Node &node = m_nodes[index];
+  switch (node.kind) {
+  case Kind::And:
+    for (int child : node.children) {
+      if (!matches(child, meta, titleKey, foldedText))
+        return false;
+    }
+    return true;
+  case Kind::Or:
+    for (int child : node.children) {
+      if (matches(child, meta, titleKey, foldedText))
+        return true;
+    }
+    return false;
+  case Kind::Not:
+    return !matches(node.children.first(), meta, titleKey, foldedText);
+  case Kind::Text:
+    return foldedText.contains(node.value) || titleKey.contains(node.key);
+  case Kind::Tag:
+    for (const QString &tag : meta.tags) {
+      if (isTagOrNested(tag, node.value))
+        return true;
+    }
+    return false;
+  case Kind::Path:
+    return meta.filePath.startsWith(node.value, Qt::CaseInsensitive);
+  case Kind::Title:
+    return titleKey.contains(node.key);
+  case Kind::Task:
+    return meta.hasTasks;
+  case Kind::Modified: {
+    const qint64 ms = meta.lastModified.toMSecsSinceEpoch();
+    return ms >= node.from && ms < node.to;
+  }
+  case Kind::Nothing:
+    return false;
+  }
+  return false;
+}
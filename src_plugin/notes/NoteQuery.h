@@ -0,0 +1,100 @@
+#pragma once
+
+#include "NoteMetadata.h"
+#include "NotesStore.h"
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+/**
+ * @brief A parsed search query over the notes of one vault.
+ *
+ * Syntax: bare words and "quoted phrases" match the title or the body;
+ * tag:name (or #name, nested tags included), path:dir/ (vault-relative
+ * prefix), title:text, has:task (an open "- [ ]" task) and
+ * modified:>2024-01-31 (also <, >=, <=, = or a relative "7d" / "2w")
+ * filter on metadata. Terms next to each other must all match; AND, OR,
+ * NOT (or a leading '-') and parentheses combine them, NOT binding tightest
+ * and OR loosest. Unknown fields are searched as text and unbalanced
+ * parentheses are forgiven.
+ *
+ * Evaluation has two stages. candidates() answers everything the index can
+ * on the GUI thread: tag postings, the folder tree, titles, task flags and
+ * dates are exact, and body terms are narrowed with the trigram index. An
+ * AND visits its parts cheapest first, smallest posting list first, and
+ * once the running set is smaller than what a part would fetch, the part
+ * is checked per note instead. Whatever the index could not decide is left
+ * to matches(), which sees the note text and runs off the GUI thread.
+ */
+class NoteQuery {
+public:
+  /** @brief Parses @p text; path: filters are relative to @p rootPath. */
+  static NoteQuery parse(const QString &text, const QString &rootPath);
+
+  bool isEmpty() const { return m_root < 0; }
+  /** @brief Whether candidates() may hold notes only matches() can rule out. */
+  bool needsText() const;
+  /** @brief Case-folded text terms outside NOT, for highlighting. */
+  QStringList textTerms() const;
+
+  /** @brief Sorted IDs of notes whose body may contain a case-folded term. */
+  using TextCandidates = std::function<QVector<NoteId>(const QString &term)>;
+
+  /**
+   * @brief Sorted IDs of the notes that can match; exactly the matches
+   * unless needsText(). Folders never match.
+   */
+  QVector<NoteId> candidates(const NotesStore &store,
+                             const TextCandidates &textCandidates) const;
+
+  /** @brief Whether @p meta matches, given its case-folded text. */
+  bool matches(const NoteMetadata &meta, const QString &foldedText) const;
+
+private:
+  enum class Kind : quint8 {
+    And,
+    Or,
+    Not,
+    Text,     // value: case-folded term, key: title search key
+    Tag,      // value: lowercased tag
+    Path,     // value: absolute path prefix
+    Title,    // key: title search key
+    Task,
+    Modified, // [from, to) in ms since epoch
+    Nothing   // filters that cannot match, e.g. "has:unknown"
+  };
+
+  struct Node {
+    Kind kind = Kind::Nothing;
+    QString value;
+    QString key;
+    qint64 from = 0;
+    qint64 to = 0;
+    QVector<int> children; // indexes into m_nodes
+  };
+
+  // Index-stage answer for one note: Unknown needs the text
+  enum class Truth : quint8 { False, True, Unknown };
+
+  // Index-stage result: sorted IDs, or every note when all is set
+  struct Result {
+    QVector<NoteId> ids;
+    bool all = false;
+    bool exact = true;
+  };
+
+  struct Context;
+  class Parser;
+
+  int add(Node node);
+  Result evaluate(int node, Context &context) const;
+  Result evaluateAnd(const Node &node, Context &context) const;
+  int estimate(int node, const Context &context) const;
+  Truth test(int node, const NotesStore &store, NoteId id) const;
+  bool matches(int node, const NoteMetadata &meta, const QString &titleKey,
+               const QString &foldedText) const;
+
+  QVector<Node> m_nodes;
+  int m_root = -1;
+};
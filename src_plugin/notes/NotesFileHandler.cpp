@@ -1,8 +1,9 @@
 #include "NotesFileHandler.h"
+#include "Frontmatter.h"
+#include "NotesIndex.h"
 #include <QClipboard>
 #include <QDateTime>
 #include <QDir>
-#include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
 #include <QGuiApplication>
@@ -47,53 +48,21 @@ bool NotesFileHandler::saveNote(const QString &filePath, const QString &content,
                                 const QString &color) {
   QString normalizedPath = normalizePath(filePath);
 
-  // Read existing file to preserve frontmatter fields
-  QString existingTags;
-  QString existingPinned;
-
+  // Keep the existing frontmatter (tags, pinned, aliases...) as written and
+  // only set the color
+  QByteArray head;
   QFile readFile(normalizedPath);
   if (readFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    QTextStream in(&readFile);
-    QString existingContent = in.readAll();
+    const QByteArray existing = readFile.readAll();
     readFile.close();
-
-    // Parse existing frontmatter to preserve tags and pinned
-    if (existingContent.startsWith(QLatin1String("---"))) {
-      int endIndex = existingContent.indexOf(QLatin1String("---"), 3);
-      if (endIndex > 0) {
-        QString frontmatter = existingContent.mid(3, endIndex - 3);
-
-        // Extract tags
-        QRegularExpression tagsRegex(
-            QStringLiteral("tags:\\s*\\[([^\\]]*)\\]"));
-        QRegularExpressionMatch tagsMatch = tagsRegex.match(frontmatter);
-        if (tagsMatch.hasMatch()) {
-          existingTags = QStringLiteral("tags: [") + tagsMatch.captured(1) +
-                         QStringLiteral("]\n");
-        }
-
-        // Extract pinned
-        QRegularExpression pinnedRegex(
-            QStringLiteral("pinned:\\s*(true|false)"));
-        QRegularExpressionMatch pinnedMatch = pinnedRegex.match(frontmatter);
-        if (pinnedMatch.hasMatch()) {
-          existingPinned = QStringLiteral("pinned: ") +
-                           pinnedMatch.captured(1) + QStringLiteral("\n");
-        }
-      }
+    const Frontmatter fm = Frontmatter::parse(existing);
+    if (fm.isValid()) {
+      head = existing.left(fm.bodyOffset());
     }
   }
-
-  // Build content with frontmatter, preserving existing fields
-  QString fileContent =
-      QStringLiteral("---\ncolor: ") + color + QStringLiteral("\n");
-  if (!existingTags.isEmpty()) {
-    fileContent += existingTags;
-  }
-  if (!existingPinned.isEmpty()) {
-    fileContent += existingPinned;
-  }
-  fileContent += QStringLiteral("---\n") + content;
+  QByteArray fileContent =
+      Frontmatter::setField(head, "color", Frontmatter::scalar(color)) +
+      content.toUtf8();
 
   QFile file(normalizedPath);
   if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
@@ -101,8 +70,7 @@ bool NotesFileHandler::saveNote(const QString &filePath, const QString &content,
     return false;
   }
 
-  QTextStream out(&file);
-  out << fileContent;
+  file.write(fileContent);
   file.close();
 
   return true;
@@ -127,31 +95,18 @@ QVariantMap NotesFileHandler::readNote(const QString &filePath) {
     return result;
   }
 
-  QTextStream in(&file);
-  QString content = in.readAll();
+  const QByteArray data = file.readAll();
   file.close();
 
-  // Parse frontmatter
-  if (content.startsWith(QLatin1String("---"))) {
-    int endIndex = content.indexOf(QLatin1String("---"), 3);
-    if (endIndex > 0) {
-      QString frontmatter = content.mid(3, endIndex - 3);
-
-      // Extract color
-      QRegularExpression colorRegex(
-          QStringLiteral("color:\\s*(#[a-fA-F0-9]+)"));
-      QRegularExpressionMatch match = colorRegex.match(frontmatter);
-      if (match.hasMatch()) {
-        result[QStringLiteral("color")] = match.captured(1);
-      }
-
-      // Content after frontmatter
-      result[QStringLiteral("content")] = content.mid(endIndex + 4).trimmed();
-    } else {
-      result[QStringLiteral("content")] = content;
-    }
+  const Frontmatter fm = Frontmatter::parse(data);
+  if (fm.isValid()) {
+    result[QStringLiteral("color")] =
+        fm.value("color", QStringLiteral("#624a73"));
+    // Content after frontmatter
+    result[QStringLiteral("content")] =
+        QString::fromUtf8(data.mid(fm.bodyOffset())).trimmed();
   } else {
-    result[QStringLiteral("content")] = content;
+    result[QStringLiteral("content")] = QString::fromUtf8(data);
   }
 
   qDebug() << "NotesFileHandler::readNote success. Content length:"
@@ -270,48 +225,21 @@ bool NotesFileHandler::updateFrontmatter(const QString &path,
     return false;
   }
 
-  QTextStream in(&file);
-  QString content = in.readAll();
+  QByteArray content = file.readAll();
   file.close();
 
   // Format the value
-  QString valueStr;
+  QByteArray valueStr;
   if (value.typeId() == QMetaType::Bool) {
-    valueStr =
-        value.toBool() ? QStringLiteral("true") : QStringLiteral("false");
+    valueStr = value.toBool() ? "true" : "false";
   } else if (value.typeId() == QMetaType::QStringList) {
-    QStringList list = value.toStringList();
-    valueStr = QStringLiteral("[") + list.join(QStringLiteral(", ")) +
-               QStringLiteral("]");
+    valueStr = Frontmatter::inlineList(value.toStringList());
   } else {
-    valueStr = value.toString();
+    valueStr = Frontmatter::scalar(value.toString());
   }
 
-  // Check if frontmatter exists
-  if (content.startsWith(QLatin1String("---"))) {
-    int endIdx = content.indexOf(QLatin1String("---"), 3);
-    if (endIdx > 0) {
-      QString frontmatter = content.mid(3, endIdx - 3);
-      QString afterFrontmatter = content.mid(endIdx);
-
-      // Check if key already exists
-      QRegularExpression keyRegex(key + QStringLiteral(":\\s*[^\\n]+"));
-      if (keyRegex.match(frontmatter).hasMatch()) {
-        // Replace existing key
-        frontmatter.replace(keyRegex, key + QStringLiteral(": ") + valueStr);
-      } else {
-        // Add new key before closing ---
-        frontmatter +=
-            key + QStringLiteral(": ") + valueStr + QStringLiteral("\n");
-      }
-
-      content = QStringLiteral("---") + frontmatter + afterFrontmatter;
-    }
-  } else {
-    // No frontmatter, create one
-    content = QStringLiteral("---\n") + key + QStringLiteral(": ") + valueStr +
-              QStringLiteral("\n---\n") + content;
-  }
+  // Replaces the key in place, appends it or creates the block
+  content = Frontmatter::setField(content, key.toUtf8(), valueStr);
 
   // Write back
   if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
@@ -320,8 +248,7 @@ bool NotesFileHandler::updateFrontmatter(const QString &path,
     return false;
   }
 
-  QTextStream out(&file);
-  out << content;
+  file.write(content);
   file.close();
 
   return true;
@@ -336,37 +263,11 @@ QStringList NotesFileHandler::getTags(const QString &path) {
     return tags;
   }
 
-  // Read only header for efficiency
-  char buffer[1024];
-  qint64 bytesRead = file.read(buffer, sizeof(buffer));
-  QString header = QString::fromUtf8(buffer, static_cast<int>(bytesRead));
+  // Read only the head for efficiency; a block cut off here parses as none
+  const QByteArray header = file.read(4096);
   file.close();
 
-  if (header.startsWith(QLatin1String("---"))) {
-    int endIdx = header.indexOf(QLatin1String("---"), 3);
-    if (endIdx > 0) {
-      QString frontmatter = header.mid(3, endIdx - 3);
-
-      // Match tags: [tag1, tag2, tag3]
-      QRegularExpression tagsRegex(QStringLiteral("tags:\\s*\\[([^\\]]+)\\]"));
-      QRegularExpressionMatch match = tagsRegex.match(frontmatter);
-
-      if (match.hasMatch()) {
-        QString tagsStr = match.captured(1);
-        const QStringList rawTags = tagsStr.split(QLatin1Char(','));
-        for (const QString &tag : rawTags) {
-          QString cleaned = tag.trimmed();
-          cleaned.remove(QLatin1Char('"'));
-          cleaned.remove(QLatin1Char('\''));
-          if (!cleaned.isEmpty()) {
-            tags.append(cleaned);
-          }
-        }
-      }
-    }
-  }
-
-  return tags;
+  return Frontmatter::parse(header).list("tags");
 }
 
 QString NotesFileHandler::saveClipboardImage(const QString &folderPath) {
@@ -388,6 +289,8 @@ QString NotesFileHandler::saveClipboardImage(const QString &folderPath) {
       }
 
       if (image.save(fullPath, "PNG")) {
+        // Resolvable at once, before the watcher reports the new file
+        NotesIndex::instance()->addAttachment(normalizePath(fullPath));
         return fileName;
       }
     }
@@ -401,210 +304,83 @@ QString NotesFileHandler::findImage(const QString &imageName,
   QString normalizedRoot = normalizePath(rootPath);
   QString normalizedNotePath = normalizePath(notePath);
 
-  // Get the folder containing the note
-  QFileInfo noteInfo(normalizedNotePath);
-  QString noteFolder = noteInfo.absolutePath();
-
-  // List of places to check (in order of preference)
-  QStringList searchPaths;
-
-  // 1. Same folder as the note
-  searchPaths << noteFolder + QStringLiteral("/") + imageName;
-
-  // 2. Attachments folder (common Obsidian pattern)
-  searchPaths << noteFolder + QStringLiteral("/attachments/") + imageName;
-  searchPaths << normalizedRoot + QStringLiteral("/attachments/") + imageName;
-
-  // 3. Images folder (common pattern)
-  searchPaths << noteFolder + QStringLiteral("/images/") + imageName;
-  searchPaths << normalizedRoot + QStringLiteral("/images/") + imageName;
-
-  // 4. Assets folder (another common pattern)
-  searchPaths << noteFolder + QStringLiteral("/assets/") + imageName;
-  searchPaths << normalizedRoot + QStringLiteral("/assets/") + imageName;
-
-  // 5. Root folder
-  searchPaths << normalizedRoot + QStringLiteral("/") + imageName;
-
-  // Check each path
-  for (const QString &path : std::as_const(searchPaths)) {
+  // The index knows every file of the vault; no disk access needed
+  NotesIndex *index = NotesIndex::instance();
+  if (index->hasAttachmentIndex(normalizedRoot))
+    return index->resolveAttachment(imageName, normalizedNotePath);
+
+  // Until the first scan of this vault finishes, probe the usual places
+  QString noteFolder = QFileInfo(normalizedNotePath).absolutePath();
+  const QString candidates[] = {
+      noteFolder + QStringLiteral("/") + imageName,
+      noteFolder + QStringLiteral("/attachments/") + imageName,
+      normalizedRoot + QStringLiteral("/attachments/") + imageName,
+      noteFolder + QStringLiteral("/images/") + imageName,
+      normalizedRoot + QStringLiteral("/images/") + imageName,
+      noteFolder + QStringLiteral("/assets/") + imageName,
+      normalizedRoot + QStringLiteral("/assets/") + imageName,
+      normalizedRoot + QStringLiteral("/") + imageName,
+  };
+  for (const QString &path : candidates) {
     if (QFile::exists(path)) {
       return QDir::cleanPath(path);
     }
   }
 
-  // If not found in common locations, do a recursive search (expensive but
-  // thorough)
-  QDirIterator it(normalizedRoot, QStringList() << imageName, QDir::Files,
-                  QDirIterator::Subdirectories);
-  if (it.hasNext()) {
-    return QDir::cleanPath(it.next());
-  }
-
-  // FALLBACK: Try without "Pasted image " prefix (common Obsidian naming issue)
-  if (imageName.startsWith(QStringLiteral("Pasted image "))) {
-    QString altName = imageName.mid(13); // Remove "Pasted image " (13 chars)
-
-    // Try direct path first
-    QString altPath = noteFolder + QStringLiteral("/") + altName;
-    if (QFile::exists(altPath)) {
-      return QDir::cleanPath(altPath);
-    }
-
-    // Recursive search with alternate name
-    QDirIterator altIt(normalizedRoot, QStringList() << altName, QDir::Files,
-                       QDirIterator::Subdirectories);
-    if (altIt.hasNext()) {
-      return QDir::cleanPath(altIt.next());
-    }
-  }
-
   // Not found
   return QString();
 }
 
 QString NotesFileHandler::extractSection(const QString &notePath,
                                          const QString &sectionName) {
-  qDebug() << "NotesFileHandler::extractSection called for path:" << notePath
-           << "section:" << sectionName;
-  QString normalizedPath = normalizePath(notePath);
-
-  QFile file(normalizedPath);
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    qWarning()
-        << "NotesFileHandler: Failed to read file for section extraction:"
-        << normalizedPath;
-    return QString();
-  }
-
-  QTextStream in(&file);
-  QString content = in.readAll();
-  file.close();
-
-  // Skip frontmatter if present
-  if (content.startsWith(QLatin1String("---"))) {
-    int endIndex = content.indexOf(QLatin1String("---"), 3);
-    if (endIndex > 0) {
-      content = content.mid(endIndex + 4);
-    }
-  }
-
-  // Parse the markdown to find headings
-  // We use a simple line-by-line approach for efficiency
-  QStringList lines = content.split(QLatin1Char('\n'));
-
-  int startLine = -1;
-  int startLevel = 0;
-  QString sectionContent;
-
-  // Normalize search term
-  QString searchTerm = sectionName.trimmed();
-  qDebug() << "NotesFileHandler::extractSection - normalized search term:"
-           << searchTerm;
-
-  for (int i = 0; i < lines.size(); ++i) {
-    QString line = lines[i];
-
-    // Check if this line is a heading (# Title, ## Title, etc.)
-    QRegularExpression headingRegex(QStringLiteral("^(#{1,6})\\s+(.*)$"));
-    QRegularExpressionMatch match = headingRegex.match(line);
-
-    if (match.hasMatch()) {
-      int level = match.captured(1).length();
-      QString headingText = match.captured(2).trimmed();
-
-      // Debug log for headings found
-      // qDebug() << "NotesFileHandler::extractSection - Found heading:" <<
-      // headingText << "Level:" << level;
-
-      if (startLine < 0) {
-        // Looking for the target heading
-        if (headingText.compare(searchTerm, Qt::CaseInsensitive) == 0) {
-          qDebug() << "NotesFileHandler::extractSection - Found Match!"
-                   << headingText;
-          startLine = i + 1; // Start collecting from next line
-          startLevel = level;
-        }
-      } else {
-        // Already found target, check if this heading ends the section
-        if (level <= startLevel) {
-          // This heading is at same or higher level - stop here
-          qDebug()
-              << "NotesFileHandler::extractSection - Ending section at heading:"
-              << headingText;
-          break;
-        }
-        // Otherwise include this heading in the section content
-        sectionContent += line + QLatin1Char('\n');
-      }
-    } else if (startLine >= 0) {
-      // We're collecting content after the target heading
-      sectionContent += line + QLatin1Char('\n');
-    }
-  }
-
-  if (sectionContent.isEmpty()) {
-    if (startLine >= 0) {
-      qDebug() << "NotesFileHandler::extractSection - Section found but empty "
-                  "content.";
-    } else {
-      qDebug() << "NotesFileHandler::extractSection - Section NOT found.";
-    }
-  } else {
-    qDebug() << "NotesFileHandler::extractSection - Content extracted, length:"
-             << sectionContent.length();
-  }
-
-  return sectionContent.trimmed();
+  QString content = readAnchor(notePath, sectionName, false);
+  if (content.isEmpty())
+    qDebug() << "NotesFileHandler::extractSection - Section" << sectionName
+             << "not found or empty in" << notePath;
+  return content;
 }
 
 QString NotesFileHandler::extractBlock(const QString &notePath,
                                        const QString &blockId) {
+  return readAnchor(notePath, blockId, true);
+}
+
+QString NotesFileHandler::readAnchor(const QString &notePath,
+                                     const QString &name, bool isBlock) {
   QString normalizedPath = normalizePath(notePath);
 
   QFile file(normalizedPath);
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    qWarning() << "NotesFileHandler: Failed to read file for block extraction:"
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << "NotesFileHandler: Failed to read file for embed:"
                << normalizedPath;
     return QString();
   }
 
-  QTextStream in(&file);
-  QString content = in.readAll();
-  file.close();
-
-  // Skip frontmatter if present
-  if (content.startsWith(QLatin1String("---"))) {
-    int endIndex = content.indexOf(QLatin1String("---"), 3);
-    if (endIndex > 0) {
-      content = content.mid(endIndex + 4);
-    }
+  // The indexed ranges hold as long as the file is the one indexed;
+  // otherwise (edited since, or outside the vault) the note is parsed here
+  QFileInfo info(normalizedPath);
+  NoteOutline outline;
+  QByteArray data;
+  const bool indexed = NotesIndex::instance()->lookupOutline(
+      normalizedPath, info.size(), info.lastModified().toMSecsSinceEpoch(),
+      outline);
+  if (!indexed) {
+    data = file.readAll();
+    outline = NoteOutline::parse(data, Frontmatter::parse(data).bodyOffset());
   }
 
-  // Search for line/paragraph ending with ^blockId
-  // Pattern: any content followed by ^blockId at end of line
-  QString searchPattern = QStringLiteral("\\^") +
-                          QRegularExpression::escape(blockId) +
-                          QStringLiteral("\\s*$");
-  QRegularExpression blockRegex(searchPattern,
-                                QRegularExpression::MultilineOption);
-
-  QStringList lines = content.split(QLatin1Char('\n'));
-
-  for (int i = 0; i < lines.size(); ++i) {
-    QString line = lines[i];
-
-    if (blockRegex.match(line).hasMatch()) {
-      // Found the block - return the content without the ^blockId marker
-      QString result = line;
-      result.replace(QRegularExpression(QStringLiteral("\\s*\\^") +
-                                        QRegularExpression::escape(blockId) +
-                                        QStringLiteral("\\s*$")),
-                     QString());
-      return result.trimmed();
-    }
-  }
+  const NoteOutline::Anchor *anchor =
+      isBlock ? outline.block(name) : outline.heading(name);
+  if (!anchor)
+    return QString();
 
-  // Block not found
-  return QString();
+  QByteArray bytes;
+  if (!indexed)
+    bytes = data.mid(anchor->begin, anchor->end - anchor->begin);
+  else if (file.seek(anchor->begin))
+    bytes = file.read(anchor->end - anchor->begin);
+
+  QString content = QString::fromUtf8(bytes);
+  content.remove(QLatin1Char('\r'));
+  return content.trimmed();
 }
@@ -123,8 +123,9 @@ public:
 
   /**
    * @brief Finds an image file within the notes vault.
-   * Searches in common Obsidian locations: same folder, attachments, images
-   * subfolders.
+   * Resolved in memory from NotesIndex's attachment index, preferring the
+   * note's folder and the usual attachments/images/assets folders; before
+   * the vault's first scan finishes only those folders are probed.
    * @param imageName The image filename (e.g., "Pasted image
    * 20260101211933.png").
    * @param notePath The path to the note containing the image reference.
@@ -138,7 +139,8 @@ public:
   /**
    * @brief Extracts a section from a markdown file by heading name.
    * Finds the heading matching sectionName and returns all content
-   * until the next heading of same or higher level.
+   * until the next heading of same or higher level. Indexed notes are read
+   * only over the section's byte range (see NoteOutline).
    * @param notePath The full path to the note file.
    * @param sectionName The heading text to find (without # prefix).
    * @return The content under that heading, or empty string if not found.
@@ -148,7 +150,9 @@ public:
 
   /**
    * @brief Extracts a block by block ID from a markdown file.
-   * Searches for lines ending with ^blockId pattern.
+   * The block is the line ending with ^blockId, or the paragraph or list
+   * above a line holding only ^blockId. Indexed notes are read only over
+   * the block's byte range.
    * @param notePath The full path to the note file.
    * @param blockId The block ID (without ^ prefix).
    * @return The block content, or empty string if not found.
@@ -157,6 +161,8 @@ public:
                                    const QString &blockId);
 
 private:
+  QString readAnchor(const QString &notePath, const QString &name,
+                     bool isBlock);
   QString sanitizeFileName(const QString &name);
   QString normalizePath(const QString &path);
 };
@@ -1,9 +1,13 @@
 #include "NotesIndex.h"
+#include "FuzzyMatcher.h"
+#include "Frontmatter.h"
+#include "NotesIndexCache.h"
+#include "VaultWalker.h"
 #include <QDebug>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
-#include <QRegularExpression>
+#include <QSet>
 #include <QTimer>
 #include <QtConcurrent>
 
@@ -23,22 +27,54 @@ NotesIndex *NotesIndex::create(QQmlEngine *qmlEngine, QJSEngine *jsEngine) {
 }
 
 NotesIndex::NotesIndex(QObject *parent)
-    : QObject(parent), m_fsWatcher(new QFileSystemWatcher(this)),
-      m_watcher(new QFutureWatcher<QVector<NoteMetadata>>(this)) {
+    : QObject(parent), m_watcher(new VaultWatcher(this)),
+      m_indexer(new NotesIndexer(this)), m_cacheTimer(new QTimer(this)),
+      m_trigramWatcher(new QFutureWatcher<bool>(this)),
+      m_trigramSaveTimer(new QTimer(this)) {
   qCritical() << "NotesIndex::NotesIndex (Constructor) - Instance created:"
               << this;
 
-  connect(m_watcher, &QFutureWatcher<QVector<NoteMetadata>>::finished, this,
+  connect(m_indexer, &NotesIndexer::discovered, this,
+          &NotesIndex::onScanDiscovered);
+  connect(m_indexer, &NotesIndexer::batchReady, this,
+          &NotesIndex::onScanBatch);
+  connect(m_indexer, &NotesIndexer::attachmentsFound, this,
+          &NotesIndex::onScanAttachments);
+  connect(m_indexer, &NotesIndexer::finished, this,
           &NotesIndex::onScanFinished);
-  connect(m_fsWatcher, &QFileSystemWatcher::directoryChanged, this,
-          &NotesIndex::onDirectoryChanged);
+  connect(m_watcher, &VaultWatcher::changed, this,
+          &NotesIndex::onVaultChanged);
+  // Lost events can't be reconstructed; fall back to a (cache-warm) rescan
+  connect(m_watcher, &VaultWatcher::overflowed, this,
+          &NotesIndex::rebuildIndex);
+
+  // Coalesce bursts of edits into one cache rewrite
+  m_cacheTimer->setSingleShot(true);
+  m_cacheTimer->setInterval(2000);
+  connect(m_cacheTimer, &QTimer::timeout, this, &NotesIndex::writeCache);
+  connect(m_trigramWatcher, &QFutureWatcher<bool>::finished, this,
+          &NotesIndex::onTrigramsUpdated);
+  // The trigram index is several times the size of the cache; rewrite it
+  // less eagerly
+  m_trigramSaveTimer->setSingleShot(true);
+  m_trigramSaveTimer->setInterval(10000);
+  connect(m_trigramSaveTimer, &QTimer::timeout, this,
+          &NotesIndex::writeTrigrams);
 }
 
 NotesIndex::~NotesIndex() {
-  if (m_watcher->isRunning()) {
-    m_watcher->cancel();
-    m_watcher->waitForFinished();
+  m_indexer->cancel();
+  if (m_cacheTimer->isActive()) {
+    m_cacheTimer->stop();
+    writeCache();
   }
+  m_cacheWrite.waitForFinished();
+  m_trigramCancel = true;
+  m_trigramWatcher->waitForFinished();
+  m_trigramLoad.waitForFinished();
+  m_trigramSave.waitForFinished();
+  if (!m_trigramRoot.isEmpty() && m_trigrams.isDirty())
+    m_trigrams.save(m_trigramRoot);
 }
 
 void NotesIndex::setRootPath(const QString &path) {
@@ -66,145 +102,384 @@ void NotesIndex::rebuildIndex() {
     return;
   }
 
-  if (m_watcher->isRunning()) {
+  if (m_indexer->isRunning()) {
     qDebug() << "NotesIndex::rebuildIndex - canceling previous scan";
-    m_watcher->cancel();
-    m_watcher->waitForFinished();
   }
 
   m_indexing = true;
   qDebug() << "NotesIndex: Rebuilding index for path:" << m_rootPath;
   emit indexingChanged();
 
-  // Count files first for progress
-  QString rootPath = m_rootPath;
-  qDebug() << "NotesIndex::rebuildIndex - starting async scan for:" << rootPath;
-  m_watcher->setFuture(QtConcurrent::run([rootPath]() {
-    qDebug() << "NotesIndex: Async scan starting in thread for:" << rootPath;
-    QVector<NoteMetadata> results;
-    QDirIterator it(rootPath, {"*.md"}, QDir::Files,
-                    QDirIterator::Subdirectories);
-
-    while (it.hasNext()) {
-      QString filePath = QDir::cleanPath(it.next()); // Normalize path
-      NoteMetadata meta = parseFileHeader(filePath);
-      meta.filePath = filePath; // Ensure meta has normalized path
-      results.append(meta);
-    }
+  m_scanResults.clear();
+  m_scanAttachments.clear();
+  m_deferredChanges.clear();
+  m_indexProgress = 0;
+  m_totalFiles = 0;
+  emit indexProgressChanged();
+  emit totalFilesChanged();
 
-    // Also add folders
-    QDirIterator dirIt(rootPath, QDir::Dirs | QDir::NoDotAndDotDot,
-                       QDirIterator::Subdirectories);
-    while (dirIt.hasNext()) {
-      QString dirPath = QDir::cleanPath(dirIt.next()); // Normalize path
-      NoteMetadata meta;
-      meta.filePath = dirPath;
-      meta.title = QFileInfo(dirPath).fileName();
-      meta.isFolder = true;
-      meta.lastModified = QFileInfo(dirPath).lastModified();
-      meta.color = QStringLiteral("#FFB900");
-      results.append(meta);
-    }
+  // Watch before scanning so nothing changed during the scan is missed
+  m_watcher->start(m_rootPath);
+
+  // The scan's parsers fill the trigram index as they read notes; a pass
+  // still running is superseded by the one after the scan
+  m_trigramCancel = true;
+  if (m_trigramRoot != m_rootPath) {
+    // Flush the previous vault's index, then load this one's
+    m_trigramsReady = false;
+    m_trigramSaveTimer->stop();
+    TrigramIndex *trigrams = &m_trigrams;
+    QFuture<bool> pass = m_trigramWatcher->future();
+    QFuture<bool> save = m_trigramSave;
+    m_trigramLoad = QtConcurrent::run(
+        [trigrams, pass, save, from = m_trigramRoot, to = m_rootPath]() {
+          pass.waitForFinished();
+          save.waitForFinished();
+          if (!from.isEmpty() && trigrams->isDirty())
+            trigrams->save(from);
+          trigrams->clear();
+          trigrams->load(to);
+        });
+    m_trigramRoot = m_rootPath;
+  }
 
-    qDebug() << "NotesIndex: Async scan completed, found" << results.size()
-             << "items";
-    return results;
-  }));
+  m_scanTimer.start();
+  m_scanGeneration =
+      m_indexer->start(m_rootPath, &m_trigrams, m_trigramLoad);
 }
 
-void NotesIndex::onScanFinished() {
-  qDebug() << "NotesIndex::onScanFinished called";
-  QVector<NoteMetadata> results = m_watcher->result();
-  qDebug() << "NotesIndex::onScanFinished - processing" << results.size()
+void NotesIndex::onScanDiscovered(int generation, int totalFiles) {
+  if (generation != m_scanGeneration)
+    return;
+  // Grows while the enumerator is still walking
+  m_totalFiles = totalFiles;
+  emit totalFilesChanged();
+}
+
+void NotesIndex::onScanBatch(int generation,
+                             const QVector<NoteMetadata> &batch) {
+  if (generation != m_scanGeneration)
+    return; // from a cancelled scan
+
+  m_scanResults += batch;
+  if (!batch.isEmpty() && !batch.first().isFolder) {
+    m_indexProgress += batch.size();
+    emit indexProgressChanged();
+  }
+}
+
+void NotesIndex::onScanAttachments(int generation,
+                                   const QStringList &paths) {
+  if (generation == m_scanGeneration)
+    m_scanAttachments += paths;
+}
+
+void NotesIndex::onScanFinished(int generation,
+                                const NotesIndexer::Stats &stats) {
+  if (generation != m_scanGeneration)
+    return;
+
+  qDebug() << "NotesIndex::onScanFinished - processing" << m_scanResults.size()
            << "results";
-  processIndexResults(results);
+  processIndexResults(m_scanResults);
+  m_scanResults = QVector<NoteMetadata>();
+  m_attachments.reset(m_scanAttachments);
+  m_scanAttachments = QStringList();
+  m_attachmentsRoot = m_rootPath;
+
+  // Changes seen while scanning may or may not be in the results; applying
+  // them again is harmless
+  const auto deferred = std::exchange(m_deferredChanges, {});
+  for (const VaultWatcher::ChangeSet &changes : deferred) {
+    applyChanges(changes);
+  }
 
+  m_totalFiles = stats.notes;
+  m_indexProgress = stats.notes;
+  emit totalFilesChanged();
+  emit indexProgressChanged();
+
+  qint64 elapsed = qMax<qint64>(1, m_scanTimer.elapsed());
+  qDebug() << "NotesIndex: opened" << (stats.cacheLoaded ? "warm" : "cold")
+           << "in" << elapsed << "ms -" << stats.notes << "notes,"
+           << stats.folders << "folders," << stats.attachments
+           << "attachments," << stats.reused << "cached,"
+           << stats.parsed << "parsed," << (stats.notes * 1000 / elapsed)
+           << "notes/s";
+  if (stats.parsed > 0) {
+    qDebug() << "NotesIndex: per parsed note" << stats.parseNs / stats.parsed
+             << "ns total," << stats.frontmatterNs / stats.parsed
+             << "ns frontmatter";
+  }
   m_indexing = false;
   emit indexingChanged();
+  if (stats.cacheDirty) {
+    scheduleCacheWrite();
+  }
+  // scheduleTrigramUpdate() bails out while indexing
+  scheduleTrigramUpdate();
+  announceTagChanges();
   emit indexReady();
-  qDebug() << "NotesIndex::onScanFinished - index ready, titleToPath size:"
-           << m_titleToPath.size();
+  qDebug() << "NotesIndex::onScanFinished - index ready, entries:"
+           << m_store.size();
 }
 
 void NotesIndex::processIndexResults(const QVector<NoteMetadata> &results) {
-  // Clear existing indices
-  m_index.clear();
-  m_tagIndex.clear();
-  m_backlinks.clear();
-  m_titleToPath.clear();
+  // Rebuild every structure from the scan, links included
+  m_store.clear();
+  m_store.reserve(results.size());
+  m_store.beginBulkLoad();
+  for (const NoteMetadata &meta : results) {
+    m_store.insert(meta);
+  }
+  m_store.endBulkLoad();
 
-  m_totalFiles = results.size();
-  emit totalFilesChanged();
+  announceTagChanges();
+  emit indexUpdated();
+}
 
-  int progress = 0;
-  for (const NoteMetadata &meta : results) {
-    m_index.insert(meta.filePath, meta);
-    m_titleToPath.insert(meta.title, meta.filePath);
+void NotesIndex::scheduleCacheWrite() {
+  if (!m_rootPath.isEmpty())
+    m_cacheTimer->start();
+}
 
-    // Build tag index
-    for (const QString &tag : meta.tags) {
-      m_tagIndex.insert(tag.toLower(), meta.filePath);
-    }
+void NotesIndex::writeCache() {
+  if (m_rootPath.isEmpty() || m_indexing)
+    return;
 
-    progress++;
-    if (progress % 100 == 0) {
-      m_indexProgress = progress;
-      emit indexProgressChanged();
-    }
+  // Only one writer at a time; the previous one is normally long done
+  m_cacheWrite.waitForFinished();
+
+  QVector<NoteMetadata> snapshot;
+  snapshot.reserve(m_store.size());
+  for (NoteId id = 0; id < m_store.idLimit(); ++id) {
+    if (m_store.isAlive(id) && !m_store.isFolder(id))
+      snapshot.append(m_store.metadata(id));
   }
 
-  m_indexProgress = m_totalFiles;
-  emit indexProgressChanged();
+  QString rootPath = m_rootPath;
+  m_cacheWrite = QtConcurrent::run([rootPath, snapshot]() {
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = NotesIndexCache::write(rootPath, snapshot);
+    qDebug() << "NotesIndex: cache" << (ok ? "written" : "write failed")
+             << "for" << snapshot.size() << "notes in" << timer.elapsed()
+             << "ms";
+    return ok;
+  });
+}
 
-  // Now scan for WikiLinks and build backlinks
-  // This is done separately since we need all titles indexed first
-  for (const NoteMetadata &meta : results) {
-    if (meta.isFolder)
+void NotesIndex::scheduleTrigramUpdate() {
+  if (m_rootPath.isEmpty() || m_indexing)
+    return;
+  if (m_trigramWatcher->isRunning()) {
+    m_trigramRerun = true; // pick this change up once the current pass ends
+    return;
+  }
+
+  // The store is only touched here; the worker gets a plain snapshot
+  QVector<TrigramIndex::Source> notes;
+  notes.reserve(m_store.size());
+  for (NoteId id = 0; id < m_store.idLimit(); ++id) {
+    if (m_store.isAlive(id) && !m_store.isFolder(id))
+      notes.append(
+          {m_store.path(id), m_store.fileSize(id), m_store.mtimeMs(id)});
+  }
+
+  m_trigramCancel = false;
+  m_trigramRerun = false;
+
+  // Notes the scan or readNote() indexed are current; only the rest are
+  // read. Saving is left to m_trigramSaveTimer
+  TrigramIndex *trigrams = &m_trigrams;
+  const std::atomic<bool> *cancelled = &m_trigramCancel;
+  m_trigramWatcher->setFuture(QtConcurrent::run(
+      [trigrams, notes, cancelled, loaded = m_trigramLoad]() {
+        loaded.waitForFinished();
+        return trigrams->update(notes, cancelled);
+      }));
+}
+
+void NotesIndex::onTrigramsUpdated() {
+  if (m_indexing)
+    return; // superseded; the scan schedules the next pass
+  if (m_trigramRerun) {
+    scheduleTrigramUpdate();
+    return;
+  }
+  m_trigramsReady = true;
+  if (m_trigrams.isDirty())
+    m_trigramSaveTimer->start();
+
+  TrigramIndex::Stats stats = m_trigrams.stats();
+  if (stats.indexed > 0) {
+    qint64 elapsed = qMax<qint64>(1, stats.elapsedMs);
+    qDebug() << "NotesIndex: trigram index" << stats.documents << "notes,"
+             << stats.trigrams << "trigrams," << stats.postings << "postings,"
+             << "~" << stats.memoryBytes / 1024 << "KiB; read"
+             << stats.indexed << "notes (" << stats.indexedBytes / 1024
+             << "KiB) in" << elapsed << "ms,"
+             << (stats.indexedBytes / 1024 * 1000 / elapsed) << "KiB/s";
+  }
+}
+
+void NotesIndex::writeTrigrams() {
+  if (m_trigramRoot.isEmpty() || m_indexing)
+    return; // the pass after the scan re-arms the timer
+  if (m_trigramSave.isRunning()) {
+    m_trigramSaveTimer->start();
+    return;
+  }
+
+  TrigramIndex *trigrams = &m_trigrams;
+  m_trigramSave = QtConcurrent::run(
+      [trigrams, rootPath = m_trigramRoot]() {
+        return trigrams->save(rootPath);
+      });
+}
+
+void NotesIndex::onVaultChanged(const VaultWatcher::ChangeSet &changes) {
+  if (m_indexing) {
+    m_deferredChanges.append(changes);
+    return;
+  }
+  applyChanges(changes);
+}
+
+void NotesIndex::applyChanges(const VaultWatcher::ChangeSet &changes) {
+  QStringList touched;
+
+  for (const QString &path : changes.removed) {
+    m_attachments.removeTree(path);
+    if (dropTree(path))
+      touched.append(path);
+  }
+
+  for (const auto &rename : changes.renamed) {
+    const QString &from = rename.first;
+    const QString &to = rename.second;
+    QFileInfo info(to);
+    if (info.isFile() && !VaultWalker::isNoteName(info.fileName())) {
+      // An attachment; a note renamed to another extension leaves too
+      m_attachments.remove(from);
+      m_attachments.add(to);
+      if (dropEntry(from))
+        touched.append(from);
       continue;
+    }
+    m_attachments.remove(from);
+    if (info.isDir())
+      m_attachments.renameTree(from, to);
+    NoteId fromId = m_store.find(from);
+    if (fromId != NotesStore::kInvalid && m_store.isFolder(fromId)) {
+      renameTree(from, to);
+    } else {
+      dropEntry(from);
+      dropEntry(to); // replaced by the rename
+      if (info.isFile())
+        insertEntry(readNote(to));
+      else if (info.isDir())
+        insertEntry(folderMetadata(to, info.fileName(),
+                                   info.lastModified().toMSecsSinceEpoch()));
+    }
+    touched << from << to;
+  }
 
-    // Re-read header to get WikiLinks
-    QFile file(meta.filePath);
-    if (file.open(QIODevice::ReadOnly)) {
-      char buffer[2048];
-      qint64 bytesRead = file.read(buffer, sizeof(buffer));
-      QString content = QString::fromUtf8(buffer, static_cast<int>(bytesRead));
-      file.close();
-
-      QStringList links = parseWikiLinks(content);
-      for (const QString &linkedTitle : links) {
-        m_backlinks[linkedTitle].append(meta.filePath);
+  for (const QStringList *paths : {&changes.added, &changes.modified}) {
+    for (const QString &path : *paths) {
+      QFileInfo info(path);
+      if (info.isDir()) {
+        if (m_store.find(path) == NotesStore::kInvalid) {
+          insertEntry(folderMetadata(path, info.fileName(),
+                                     info.lastModified().toMSecsSinceEpoch()));
+          touched.append(path);
+        }
+        continue;
       }
+      if (!info.isFile())
+        continue; // already gone again
+      if (!VaultWalker::isNoteName(info.fileName())) {
+        m_attachments.add(path);
+        continue;
+      }
+
+      // Saves from the app were applied by updateEntry() already
+      NoteId id = m_store.find(path);
+      if (id != NotesStore::kInvalid && m_store.fileSize(id) == info.size() &&
+          m_store.mtimeMs(id) == info.lastModified().toMSecsSinceEpoch())
+        continue;
+
+      insertEntry(readNote(path));
+      touched.append(path);
     }
   }
 
-  // Watch root directory
-  watchDirectory(m_rootPath);
+  if (touched.isEmpty())
+    return;
 
-  emit indexUpdated();
+  qDebug() << "NotesIndex: applied watcher batch," << touched.size()
+           << "entries changed";
+  scheduleCacheWrite();
+  scheduleTrigramUpdate();
+  announceTagChanges();
+  emit entriesChanged(touched);
 }
 
-void NotesIndex::watchDirectory(const QString &path) {
-  if (!m_fsWatcher->directories().contains(path)) {
-    m_fsWatcher->addPath(path);
-  }
+void NotesIndex::insertEntry(const NoteMetadata &meta) {
+  m_store.insert(meta);
+}
 
-  // Watch subdirectories
-  QDirIterator it(path, QDir::Dirs | QDir::NoDotAndDotDot);
-  while (it.hasNext()) {
-    QString subDir = it.next();
-    if (!m_fsWatcher->directories().contains(subDir)) {
-      m_fsWatcher->addPath(subDir);
-    }
+bool NotesIndex::dropEntry(const QString &path) {
+  return m_store.remove(m_store.find(path));
+}
+
+QVector<NoteId> NotesIndex::subtree(NoteId root) const {
+  // Walk the folder tree rather than every ID; parents come before their
+  // children
+  QVector<NoteId> ids{root};
+  for (int i = 0; i < ids.size(); ++i) {
+    if (m_store.isFolder(ids[i]))
+      ids += m_store.children(m_store.path(ids[i]));
   }
+  return ids;
 }
 
-void NotesIndex::onDirectoryChanged(const QString &path) {
-  Q_UNUSED(path);
-  // Don't do a full rebuild on every change - it causes race conditions
-  // with updateEntry() calls. The filesystem watcher fires when files are
-  // saved, but updateEntry() is already called explicitly after saves.
-  // Only emit a signal so views can refresh if needed.
-  emit indexUpdated();
+bool NotesIndex::dropTree(const QString &dirPath) {
+  NoteId id = m_store.find(dirPath);
+  if (id == NotesStore::kInvalid)
+    return false; // e.g. an attachment: nothing indexed under it
+  if (!m_store.isFolder(id))
+    return m_store.remove(id); // a note; no need to look for children
+
+  // Collect first, as removing edits the children lists
+  const QVector<NoteId> ids = subtree(id);
+  bool dropped = false;
+  for (int i = ids.size() - 1; i >= 0; --i)
+    dropped |= m_store.remove(ids[i]);
+  return dropped;
+}
+
+void NotesIndex::renameTree(const QString &from, const QString &to) {
+  NoteId id = m_store.find(from);
+  if (id == NotesStore::kInvalid)
+    return;
+
+  const QVector<NoteId> ids = subtree(id);
+  QVector<NoteMetadata> moved;
+  moved.reserve(ids.size());
+  for (NoteId each : ids)
+    moved.append(m_store.metadata(each));
+  for (int i = ids.size() - 1; i >= 0; --i)
+    m_store.remove(ids[i]);
+
+  // Contents are unchanged; only paths (and the folder's own name) move.
+  // Parents are inserted before their children
+  for (NoteMetadata &meta : moved) {
+    if (meta.filePath == from)
+      meta.title = QFileInfo(to).fileName();
+    meta.filePath = to + meta.filePath.mid(from.size());
+    insertEntry(meta);
+  }
 }
 
 void NotesIndex::updateEntry(const QString &path) {
@@ -215,80 +490,43 @@ void NotesIndex::updateEntry(const QString &path) {
     return;
   }
 
-  QString normalizedPath = path;
-  if (normalizedPath.startsWith(QLatin1String("file:///"))) {
-    normalizedPath = QUrl(normalizedPath).toLocalFile();
-  }
   // Ensure path consistency (separators and absolute path)
-  normalizedPath =
-      QDir::cleanPath(QFileInfo(normalizedPath).absoluteFilePath());
+  QString normalizedPath = normalizePath(path);
 
   if (QFileInfo::exists(normalizedPath)) {
-    NoteMetadata meta = parseFileHeader(normalizedPath);
+    NoteMetadata meta = readNote(normalizedPath);
     // Ensure the metadata also stores the normalized path
     meta.filePath = normalizedPath;
+    insertEntry(meta);
 
-    // Remove old tag entries
-    if (m_index.contains(normalizedPath)) {
-      const NoteMetadata &oldMeta = m_index[normalizedPath];
-      for (const QString &tag : oldMeta.tags) {
-        m_tagIndex.remove(tag.toLower(), normalizedPath);
-      }
-      m_titleToPath.remove(oldMeta.title);
-    }
-
-    // Update index
-    m_index.insert(normalizedPath, meta);
-    m_titleToPath.insert(meta.title, normalizedPath);
-
-    // Update tag index
-    for (const QString &tag : meta.tags) {
-      m_tagIndex.insert(tag.toLower(), normalizedPath);
-    }
-
+    scheduleCacheWrite();
+    scheduleTrigramUpdate();
+    announceTagChanges();
     emit entryUpdated(normalizedPath);
-    emit indexUpdated();
+    emit entriesChanged({normalizedPath});
   }
 }
 
 void NotesIndex::removeEntry(const QString &path) {
-  QString normalizedPath = path;
-  if (normalizedPath.startsWith(QLatin1String("file:///"))) {
-    normalizedPath = QUrl(normalizedPath).toLocalFile();
-  }
-  normalizedPath =
-      QDir::cleanPath(QFileInfo(normalizedPath).absoluteFilePath());
-
-  if (m_index.contains(normalizedPath)) {
-    const NoteMetadata &meta = m_index[normalizedPath];
-
-    // Remove from tag index
-    for (const QString &tag : meta.tags) {
-      m_tagIndex.remove(tag.toLower(), normalizedPath);
-    }
-
-    // Remove from title map
-    m_titleToPath.remove(meta.title);
-
-    // Remove from backlinks (as source)
-    for (auto it = m_backlinks.begin(); it != m_backlinks.end(); ++it) {
-      it.value().removeAll(normalizedPath);
-    }
+  QString normalizedPath = normalizePath(path);
 
-    m_index.remove(normalizedPath);
-    emit indexUpdated();
+  if (dropEntry(normalizedPath)) {
+    scheduleCacheWrite();
+    scheduleTrigramUpdate();
+    announceTagChanges();
+    emit entriesChanged({normalizedPath});
   }
 }
 
 void NotesIndex::clear() {
-  m_index.clear();
-  m_tagIndex.clear();
-  m_backlinks.clear();
-  m_titleToPath.clear();
+  m_store.clear();
+  m_attachments.clear();
+  m_attachmentsRoot.clear();
   m_indexProgress = 0;
   m_totalFiles = 0;
   emit indexProgressChanged();
   emit totalFilesChanged();
+  announceTagChanges();
   emit indexUpdated();
 }
 
@@ -299,115 +537,279 @@ int NotesIndex::indexProgress() const { return m_indexProgress; }
 int NotesIndex::totalFiles() const { return m_totalFiles; }
 
 NoteMetadata NotesIndex::getMetadata(const QString &path) const {
-  QString normalizedPath = path;
-  if (normalizedPath.startsWith(QLatin1String("file:///"))) {
-    normalizedPath = QUrl(normalizedPath).toLocalFile();
-  }
-  normalizedPath =
-      QDir::cleanPath(QFileInfo(normalizedPath).absoluteFilePath());
-  return m_index.value(normalizedPath);
+  QString normalizedPath = normalizePath(path);
+  return m_store.metadata(m_store.find(normalizedPath));
 }
 
 QVector<NoteMetadata>
 NotesIndex::getItemsInFolder(const QString &folderPath) const {
-  QString normalizedPath = folderPath;
-  if (normalizedPath.startsWith(QLatin1String("file:///"))) {
-    normalizedPath = QUrl(normalizedPath).toLocalFile();
-  }
-  normalizedPath =
-      QDir::cleanPath(QFileInfo(normalizedPath).absoluteFilePath());
+  QString normalizedPath = normalizePath(folderPath);
 
   QVector<NoteMetadata> items;
-  QDir dir(normalizedPath);
 
-  if (!dir.exists())
+  // Until the first scan of a vault lands, the tree doesn't know its
+  // folders yet; list names and dates from disk so the view isn't empty
+  // meanwhile. Notes are not opened here, on the GUI thread: tags, colors,
+  // pins and previews arrive with indexReady, which reloads the view
+  if (m_indexing && !m_store.hasDirectory(normalizedPath)) {
+    VaultWalker::listDirectory(
+        normalizedPath, VaultWalker::Notes | VaultWalker::Dirs,
+        [&items](const VaultWalker::Entry &entry) {
+          items.append(entry.isDir ? folderMetadata(entry.path, entry.name,
+                                                    entry.mtimeMs)
+                                   : listedNoteMetadata(entry));
+        });
+
+    // Sort: folders first, then by date
+    std::sort(items.begin(), items.end(),
+              [](const NoteMetadata &a, const NoteMetadata &b) {
+                if (a.isFolder != b.isFolder)
+                  return a.isFolder > b.isFolder;
+                return a.lastModified > b.lastModified;
+              });
     return items;
-
-  // Get direct children only
-  dir.setFilter(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-  const QFileInfoList entries = dir.entryInfoList();
-
-  for (const QFileInfo &info : entries) {
-    QString itemPath = QDir::cleanPath(info.absoluteFilePath());
-
-    if (info.isDir()) {
-      // Create folder metadata on the fly if not indexed
-      NoteMetadata meta;
-      meta.filePath = itemPath;
-      meta.title = info.fileName();
-      meta.isFolder = true;
-      meta.lastModified = info.lastModified();
-      meta.color = QStringLiteral("#FFB900");
-      items.append(meta);
-    } else if (info.suffix().compare(QLatin1String("md"),
-                                     Qt::CaseInsensitive) == 0) {
-      if (m_index.contains(itemPath)) {
-        items.append(m_index.value(itemPath));
-      } else {
-        // Parse on demand if not yet indexed
-        items.append(parseFileHeader(itemPath));
-      }
-    }
   }
 
-  // Sort: pinned first, then folders, then by date
-  std::sort(items.begin(), items.end(),
-            [](const NoteMetadata &a, const NoteMetadata &b) {
-              if (a.isPinned != b.isPinned)
-                return a.isPinned > b.isPinned;
-              if (a.isFolder != b.isFolder)
-                return a.isFolder > b.isFolder;
-              return a.lastModified > b.lastModified;
-            });
+  // Direct children, already in listing order; no disk access
+  QElapsedTimer timer;
+  timer.start();
+  const QVector<NoteId> children = m_store.children(normalizedPath);
+  items.reserve(children.size());
+  for (NoteId id : children) {
+    items.append(m_store.metadata(id));
+  }
+  if (items.size() >= 1000) {
+    qDebug() << "NotesIndex: listed" << items.size() << "items of"
+             << normalizedPath << "in" << timer.nsecsElapsed() / 1000 << "us";
+  }
 
   return items;
 }
 
 QVector<NoteMetadata> NotesIndex::getNotesByTag(const QString &tag) const {
   QVector<NoteMetadata> results;
-  QString lowerTag = tag.toLower();
+  const QVector<NoteId> ids = m_store.notesUnderTag(tag);
+  results.reserve(ids.size());
+  for (NoteId id : ids) {
+    results.append(m_store.metadata(id));
+  }
+  return results;
+}
 
-  const QList<QString> paths = m_tagIndex.values(lowerTag);
-  for (const QString &path : paths) {
-    if (m_index.contains(path)) {
-      results.append(m_index.value(path));
+QVector<NoteMetadata> NotesIndex::searchByTitle(const QString &query) const {
+  // Spaces only separate words, but are kept (collapsed) so that a title
+  // containing the whole query still earns the substring bonus
+  const QString pattern = NotesStore::searchKey(query).simplified();
+  if (pattern.isEmpty())
+    return {};
+  const quint64 mask = FuzzyMatcher::charMask(pattern);
+
+  // Each distinct tag is scored once; tag hits rank below title hits
+  QVector<int> tagScores(m_store.tagKeyCount(), -1);
+  for (int key = 0; key < tagScores.size(); ++key) {
+    if (FuzzyMatcher::maskCovers(m_store.tagSearchMask(key), mask)) {
+      int score = FuzzyMatcher::score(pattern, m_store.tagSearchKey(key));
+      tagScores[key] = score < 0 ? -1 : score * 3 / 4;
     }
   }
 
+  struct Hit {
+    int score;
+    NoteId id;
+  };
+  // Better score, then shorter title, then newer, then lower ID
+  auto ranksBefore = [this](const Hit &a, const Hit &b) {
+    if (a.score != b.score)
+      return a.score > b.score;
+    if (m_store.title(a.id).size() != m_store.title(b.id).size())
+      return m_store.title(a.id).size() < m_store.title(b.id).size();
+    if (m_store.mtimeMs(a.id) != m_store.mtimeMs(b.id))
+      return m_store.mtimeMs(a.id) > m_store.mtimeMs(b.id);
+    return a.id < b.id;
+  };
+
+  // Bounded heap whose front is the weakest hit kept so far
+  std::vector<Hit> heap;
+  heap.reserve(kMaxTitleResults + 1);
+  for (NoteId id = 0; id < m_store.idLimit(); ++id) {
+    if (!m_store.isAlive(id))
+      continue;
+
+    int best = -1;
+    if (FuzzyMatcher::maskCovers(m_store.titleMask(id), mask))
+      best = FuzzyMatcher::score(pattern, m_store.titleKey(id));
+    for (quint32 tagId : m_store.tagIds(id))
+      best = qMax(best, tagScores[m_store.tagKeyOf(tagId)]);
+    if (best < 0)
+      continue;
+
+    Hit hit{best, id};
+    if (int(heap.size()) < kMaxTitleResults) {
+      heap.push_back(hit);
+      std::push_heap(heap.begin(), heap.end(), ranksBefore);
+    } else if (ranksBefore(hit, heap.front())) {
+      std::pop_heap(heap.begin(), heap.end(), ranksBefore);
+      heap.back() = hit;
+      std::push_heap(heap.begin(), heap.end(), ranksBefore);
+    }
+  }
+
+  std::sort(heap.begin(), heap.end(), ranksBefore);
+  QVector<NoteMetadata> results;
+  results.reserve(int(heap.size()));
+  for (const Hit &hit : heap) {
+    results.append(m_store.metadata(hit.id));
+  }
   return results;
 }
 
-QVector<NoteMetadata> NotesIndex::searchByTitle(const QString &query) const {
-  QVector<NoteMetadata> results;
-  QString lowerQuery = query.toLower();
+bool NotesIndex::isContentIndexReady() const {
+  return m_trigramsReady && m_trigramRoot == m_rootPath;
+}
 
-  for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
-    const NoteMetadata &meta = it.value();
-    if (meta.title.toLower().contains(lowerQuery)) {
-      results.append(meta);
+QVector<NoteMetadata>
+NotesIndex::contentCandidates(const QString &query) const {
+  QVector<NoteMetadata> results;
+  if (!isContentIndexReady()) {
+    for (NoteId id = 0; id < m_store.idLimit(); ++id) {
+      if (m_store.isAlive(id) && !m_store.isFolder(id))
+        results.append(m_store.metadata(id));
     }
-    // Also search in tags
-    else {
-      for (const QString &tag : meta.tags) {
-        if (tag.toLower().contains(lowerQuery)) {
-          results.append(meta);
-          break;
-        }
+    return results;
+  }
+
+  const QStringList paths = m_trigrams.candidates(query);
+  results.reserve(paths.size());
+  for (const QString &path : paths) {
+    NoteId id = m_store.find(path);
+    if (id != NotesStore::kInvalid)
+      results.append(m_store.metadata(id));
+  }
+  return results;
+}
+
+QVector<NoteMetadata>
+NotesIndex::queryCandidates(const NoteQuery &query) const {
+  const bool trigramsReady = isContentIndexReady();
+  auto textCandidates = [this, trigramsReady](const QString &term) {
+    QVector<NoteId> ids;
+    if (!trigramsReady) {
+      for (NoteId id = 0; id < m_store.idLimit(); ++id) {
+        if (m_store.isAlive(id) && !m_store.isFolder(id))
+          ids.append(id);
       }
+      return ids;
     }
-  }
+    const QStringList paths = m_trigrams.candidates(term);
+    ids.reserve(paths.size());
+    for (const QString &path : paths) {
+      NoteId id = m_store.find(path);
+      if (id != NotesStore::kInvalid)
+        ids.append(id);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+  };
+
+  const QVector<NoteId> ids = query.candidates(m_store, textCandidates);
 
+  QVector<NoteMetadata> results;
+  results.reserve(ids.size());
+  for (NoteId id : ids) {
+    results.append(m_store.metadata(id));
+  }
   return results;
 }
 
+bool NotesIndex::hasAttachmentIndex(const QString &rootPath) const {
+  return !m_attachmentsRoot.isEmpty() &&
+         m_attachmentsRoot == normalizePath(rootPath);
+}
+
+QString NotesIndex::resolveAttachment(const QString &link,
+                                      const QString &notePath) const {
+  return m_attachments.resolve(link, normalizePath(notePath),
+                               m_attachmentsRoot);
+}
+
+void NotesIndex::addAttachment(const QString &path) {
+  if (!m_attachmentsRoot.isEmpty() &&
+      path.startsWith(m_attachmentsRoot + QLatin1Char('/')))
+    m_attachments.add(path);
+}
+
 QStringList NotesIndex::getBacklinks(const QString &title) const {
-  return m_backlinks.value(title);
+  // Links may use the note's aliases too; titles nobody owns still have
+  // dangling links pointing at them
+  NoteId note = m_store.findByTitle(title);
+  if (note == NotesStore::kInvalid)
+    note = m_store.resolveLink(title);
+  const QVector<NoteId> sources = note != NotesStore::kInvalid
+                                      ? m_store.backlinks(note)
+                                      : m_store.linkSources(title);
+  QStringList paths;
+  paths.reserve(sources.size());
+  for (NoteId id : sources) {
+    paths.append(m_store.path(id));
+  }
+  return paths;
+}
+
+QStringList NotesIndex::getOutgoingLinks(const QString &path) const {
+  QStringList paths;
+  for (NoteId id : m_store.outgoingLinks(m_store.find(normalizePath(path)))) {
+    paths.append(m_store.path(id));
+  }
+  return paths;
+}
+
+QStringList NotesIndex::linkedNotesToPrefetch(const QString &path,
+                                              int maxCount,
+                                              qint64 maxBytes) const {
+  QVector<NoteId> linked =
+      m_store.outgoingLinks(m_store.find(normalizePath(path)));
+  std::sort(linked.begin(), linked.end(), [this](NoteId a, NoteId b) {
+    return m_store.mtimeMs(a) > m_store.mtimeMs(b);
+  });
+
+  QStringList paths;
+  qint64 bytes = 0;
+  for (NoteId id : linked) {
+    if (paths.size() >= maxCount)
+      break;
+    if (bytes + m_store.fileSize(id) > maxBytes)
+      continue; // a smaller note may still fit
+    bytes += m_store.fileSize(id);
+    paths.append(m_store.path(id));
+  }
+  return paths;
 }
 
 QStringList NotesIndex::getAllTags() const {
-  QStringList tags = m_tagIndex.uniqueKeys();
-  tags.sort(Qt::CaseInsensitive);
-  return tags;
+  if (m_allTagsGeneration == m_store.tagGeneration())
+    return m_allTags;
+
+  // Children are kept sorted, so a pre-order walk is already in order
+  const TagTree &tree = m_store.tagTree();
+  m_allTags.clear();
+  QVector<quint32> stack(tree.children(TagTree::kRoot).crbegin(),
+                         tree.children(TagTree::kRoot).crend());
+  while (!stack.isEmpty()) {
+    quint32 node = stack.takeLast();
+    m_allTags.append(tree.tag(node));
+    const QVector<quint32> &children = tree.children(node);
+    for (auto it = children.crbegin(); it != children.crend(); ++it)
+      stack.append(*it);
+  }
+  m_allTagsGeneration = m_store.tagGeneration();
+  return m_allTags;
+}
+
+void NotesIndex::announceTagChanges() {
+  if (m_announcedTagGeneration == m_store.tagGeneration())
+    return;
+  m_announcedTagGeneration = m_store.tagGeneration();
+  emit tagsChanged();
 }
 
 QString NotesIndex::findPathByTitle(const QString &title) const {
@@ -420,169 +822,331 @@ QString NotesIndex::findPathByTitle(const QString &title) const {
 
   qDebug() << "NotesIndex::findPathByTitle looking for:" << title;
 
-  if (m_titleToPath.contains(title)) {
-    QString result = m_titleToPath.value(title);
+  // Exact title first, then the way a [[link]] would resolve: any case,
+  // aliases, and "Note#Heading" or "folder/Note" forms
+  NoteId id = m_store.findByTitle(title);
+  if (id == NotesStore::kInvalid)
+    id = m_store.resolveLink(title);
+  if (id != NotesStore::kInvalid) {
+    QString result = m_store.path(id);
     qDebug() << "NotesIndex::findPathByTitle Found:" << result;
     return result;
   }
 
   qDebug() << "NotesIndex::findPathByTitle - NOT FOUND in index of size:"
-           << m_titleToPath.size();
-  // Debug: print all titles in index if small enough or just summary?
-  // Let's print top 5 to see if index is populated at all
+           << m_store.size();
+  // Print a few titles to see if the index is populated at all
   int count = 0;
-  for (auto it = m_titleToPath.constBegin(); it != m_titleToPath.constEnd();
-       ++it) {
-    if (count++ < 5) {
-      qDebug() << "   Index sample:" << it.key();
-    } else {
-      break;
+  for (NoteId sample = 0; sample < m_store.idLimit() && count < 5; ++sample) {
+    if (m_store.isAlive(sample)) {
+      qDebug() << "   Index sample:" << m_store.title(sample);
+      count++;
     }
   }
 
   return QString();
 }
 
+QString NotesIndex::findPathByBlock(const QString &blockId) const {
+  if (this != s_instance && s_instance != nullptr)
+    return s_instance->findPathByBlock(blockId);
+
+  const QVector<NoteId> notes = m_store.notesWithBlock(blockId);
+  return notes.isEmpty() ? QString() : m_store.path(notes.first());
+}
+
+bool NotesIndex::lookupOutline(const QString &path, qint64 size,
+                               qint64 mtimeMs, NoteOutline &out) const {
+  NoteId id = m_store.find(normalizePath(path));
+  if (id == NotesStore::kInvalid || m_store.isFolder(id) ||
+      m_store.fileSize(id) != size || m_store.mtimeMs(id) != mtimeMs)
+    return false;
+  out = m_store.outline(id);
+  return true;
+}
+
+QString NotesIndex::normalizePath(const QString &path) {
+  // Paths produced by the walker are already absolute and clean; skip the
+  // QUrl/QFileInfo/cleanPath round trip for them
+  if (QDir::isAbsolutePath(path) && !path.contains(QLatin1Char('\\')) &&
+      !path.contains(QLatin1String("//")) &&
+      !path.contains(QLatin1String("/./")) &&
+      !path.contains(QLatin1String("/../")) &&
+      !path.endsWith(QLatin1Char('/')) && !path.endsWith(QLatin1String("/.")) &&
+      !path.endsWith(QLatin1String("/..")))
+    return path;
+
+  QString normalizedPath = path;
+  if (normalizedPath.startsWith(QLatin1String("file:///"))) {
+    normalizedPath = QUrl(normalizedPath).toLocalFile();
+  }
+  return QDir::cleanPath(QFileInfo(normalizedPath).absoluteFilePath());
+}
+
 // Static parsing methods
 
-NoteMetadata NotesIndex::parseFileHeader(const QString &path) {
+NoteMetadata NotesIndex::folderMetadata(const QString &path,
+                                        const QString &name, qint64 mtimeMs) {
+  NoteMetadata meta;
+  meta.filePath = path;
+  meta.title = name;
+  meta.isFolder = true;
+  meta.lastModified = QDateTime::fromMSecsSinceEpoch(mtimeMs);
+  meta.color = QStringLiteral("#FFB900");
+  return meta;
+}
+
+NoteMetadata NotesIndex::listedNoteMetadata(const VaultWalker::Entry &entry) {
+  NoteMetadata meta;
+  meta.filePath = entry.path;
+  meta.title = entry.name.chopped(3); // drop ".md"
+  meta.lastModified = QDateTime::fromMSecsSinceEpoch(entry.mtimeMs);
+  meta.fileSize = entry.size;
+  meta.color = QStringLiteral("#624a73");
+  return meta;
+}
+
+NoteMetadata NotesIndex::readNote(const QString &path) {
+  // While a scan reloads the trigram index, the pass after it reads the note
+  if (m_indexing || m_trigramRoot != m_rootPath)
+    return parseFileHeader(path);
+
+  QVector<quint64> trigrams;
+  NoteMetadata meta = parseFileHeader(path, nullptr, &trigrams);
+  // Nothing extracted may mean the read failed; update() retries those
+  if (!trigrams.isEmpty())
+    m_trigrams.addDocument(
+        {path, meta.fileSize, meta.lastModified.toMSecsSinceEpoch()},
+        trigrams);
+  return meta;
+}
+
+NoteMetadata NotesIndex::parseFileHeader(const QString &path,
+                                         qint64 *frontmatterNs,
+                                         QVector<quint64> *trigrams) {
+  if (trigrams)
+    trigrams->clear();
+  QFileInfo info(path);
   NoteMetadata meta;
   meta.filePath = path;
-  meta.title = QFileInfo(path).completeBaseName();
-  meta.lastModified = QFileInfo(path).lastModified();
+  meta.title = info.completeBaseName();
+  meta.lastModified = info.lastModified();
+  meta.fileSize = info.size();
   meta.isFolder = false;
   meta.color = QStringLiteral("#624a73"); // Default
 
   QFile file(path);
   if (file.open(QIODevice::ReadOnly)) {
-    // Read only first 1024 bytes for efficiency
-    char buffer[1024];
-    qint64 bytesRead = file.read(buffer, sizeof(buffer));
-    QString header = QString::fromUtf8(buffer, static_cast<int>(bytesRead));
+    const QByteArray data = file.readAll();
     file.close();
 
-    // Parse frontmatter
-    if (header.startsWith(QLatin1String("---"))) {
-      int endIdx = header.indexOf(QLatin1String("---"), 3);
-      if (endIdx > 0) {
-        QString fm = header.mid(3, endIdx - 3);
-        meta.color = parseColor(fm);
-        meta.tags = parseTags(fm);
-        meta.isPinned = parsePinned(fm);
-      }
+    // Frontmatter is read straight from the bytes; links can appear
+    // anywhere, so the whole body is decoded once for them
+    QElapsedTimer timer;
+    if (frontmatterNs)
+      timer.start();
+    const Frontmatter fm = Frontmatter::parse(data);
+    if (fm.isValid()) {
+      meta.color = parseColor(fm.value("color"));
+      meta.tags = fm.list("tags");
+      meta.aliases =
+          fm.contains("aliases") ? fm.list("aliases") : fm.list("alias");
+      meta.isPinned = fm.boolean("pinned");
     }
+    if (frontmatterNs)
+      *frontmatterNs += timer.nsecsElapsed();
+
+    const QString content = QString::fromUtf8(data);
+    if (trigrams)
+      *trigrams = TrigramIndex::extract(content);
+    meta.links = parseWikiLinks(content);
+    // Stored with the entry so list views never open the file
+    const qsizetype bodyStart =
+        QString::fromUtf8(data.left(fm.bodyOffset())).size();
+    meta.preview = extractPreview(QStringView(content).mid(bodyStart));
+    meta.hasTasks = hasOpenTask(QStringView(content).mid(bodyStart));
+    meta.outline = NoteOutline::parse(data, fm.bodyOffset());
   }
 
   return meta;
 }
 
-QString NotesIndex::parseColor(const QString &frontmatter) {
-  QRegularExpression colorRegex(QStringLiteral("color:\\s*(#[a-fA-F0-9]+)"));
-  QRegularExpressionMatch match = colorRegex.match(frontmatter);
-  if (match.hasMatch()) {
-    return match.captured(1);
+QString NotesIndex::parseColor(const QString &value) {
+  // "#rgb", "#rrggbb" or "#aarrggbb"
+  bool valid = value.size() > 1 && value.startsWith(QLatin1Char('#'));
+  for (qsizetype i = 1; valid && i < value.size(); ++i) {
+    const char16_t c = value[i].unicode();
+    valid = (c >= u'0' && c <= u'9') || (c >= u'a' && c <= u'f') ||
+            (c >= u'A' && c <= u'F');
   }
-  return QStringLiteral("#624a73");
+  return valid ? value : QStringLiteral("#624a73");
 }
 
-QStringList NotesIndex::parseTags(const QString &frontmatter) {
-  QStringList tags;
-
-  // 1. Try JSON-style array: tags: [tag1, tag2]
-  QRegularExpression jsonTagsRegex(QStringLiteral("tags:\\s*\\[([^\\]]+)\\]"));
-  QRegularExpressionMatch jsonMatch = jsonTagsRegex.match(frontmatter);
-
-  if (jsonMatch.hasMatch()) {
-    QString tagsStr = jsonMatch.captured(1);
-    const QStringList rawTags = tagsStr.split(QLatin1Char(','));
-    for (const QString &tag : rawTags) {
-      QString cleaned = tag.trimmed();
-      cleaned.remove(QLatin1Char('"'));
-      cleaned.remove(QLatin1Char('\''));
-      if (!cleaned.isEmpty()) {
-        tags.append(cleaned);
+namespace {
+// Appends @p text without inline markup: emphasis markers, images and the
+// targets of links are dropped, link texts kept
+void appendPlainInline(QStringView text, QString &out) {
+  const qsizetype n = text.size();
+  for (qsizetype i = 0; i < n; ++i) {
+    const QChar c = text[i];
+    const QChar next = i + 1 < n ? text[i + 1] : QChar();
+
+    if (c == u'[' && next == u'[') {
+      qsizetype end = text.indexOf(QLatin1String("]]"), i + 2);
+      if (end >= 0) {
+        QStringView inner = text.mid(i + 2, end - i - 2);
+        qsizetype pipe = inner.indexOf(u'|');
+        out += pipe >= 0 ? inner.mid(pipe + 1).toString()
+                         : NotesStore::linkTarget(inner);
+        i = end + 1;
+        continue;
       }
     }
-    return tags;
+    if (c == u'[' || (c == u'!' && next == u'[')) {
+      qsizetype open = c == u'!' ? i + 1 : i;
+      qsizetype close = text.indexOf(u']', open + 1);
+      if (close >= 0 && close + 1 < n && text[close + 1] == u'(') {
+        qsizetype end = text.indexOf(u')', close + 2);
+        if (end >= 0) {
+          if (c == u'[')
+            appendPlainInline(text.mid(open + 1, close - open - 1), out);
+          i = end;
+          continue;
+        }
+      }
+    }
+    if (c == u'*' || c == u'`' || c == u'~')
+      continue;
+    if (c == u'=' && next == u'=') {
+      ++i;
+      continue;
+    }
+    out += (c == u'|' || c == u'\t') ? QChar(u' ') : c;
+  }
+}
+
+// Line without its block markers (headings, quotes, list bullets, tasks)
+QStringView stripBlockMarkers(QStringView line) {
+  line = line.trimmed();
+  while (line.startsWith(u'>'))
+    line = line.mid(1).trimmed();
+
+  qsizetype hashes = 0;
+  while (hashes < line.size() && hashes < 6 && line[hashes] == u'#')
+    ++hashes;
+  if (hashes > 0 && hashes < line.size() && line[hashes] == u' ')
+    return line.mid(hashes + 1).trimmed();
+
+  if (line.size() > 1 && (line[0] == u'-' || line[0] == u'*' ||
+                          line[0] == u'+') && line[1] == u' ') {
+    line = line.mid(2).trimmed();
+  } else {
+    qsizetype digits = 0;
+    while (digits < line.size() && line[digits].isDigit())
+      ++digits;
+    if (digits > 0 && digits + 1 < line.size() &&
+        (line[digits] == u'.' || line[digits] == u')') &&
+        line[digits + 1] == u' ')
+      line = line.mid(digits + 2).trimmed();
+  }
+  if (line.size() >= 3 && line[0] == u'[' && line[2] == u']')
+    line = line.mid(3).trimmed(); // task checkbox
+  return line;
+}
+
+bool isRule(QStringView line) {
+  // "---", "***", "```lang" fences and table separators carry no text
+  line = line.trimmed();
+  if (line.startsWith(QLatin1String("```")) ||
+      line.startsWith(QLatin1String("$$")))
+    return true;
+  if (line.size() < 3)
+    return false;
+  for (QChar c : line) {
+    if (c != u'-' && c != u'*' && c != u'_' && c != u'|' && c != u':' &&
+        c != u' ')
+      return false;
   }
+  return true;
+}
+} // namespace
 
-  // 2. Try YAML list style:
-  // tags:
-  //   - tag1
-  //   - tag2
-  // Or simple single line: tags: tag1
+QString NotesIndex::extractPreview(QStringView body, int maxLength) {
+  QString preview;
+  preview.reserve(maxLength + 16);
 
-  // Find "tags:" line
-  QRegularExpression tagsLineRegex(QStringLiteral("^tags:\\s*(.*)$"),
-                                   QRegularExpression::MultilineOption);
-  QRegularExpressionMatch lineMatch = tagsLineRegex.match(frontmatter);
+  qsizetype pos = 0;
+  while (pos < body.size() && preview.size() <= maxLength) {
+    qsizetype eol = body.indexOf(u'\n', pos);
+    if (eol < 0)
+      eol = body.size();
+    QStringView line = body.mid(pos, eol - pos);
+    pos = eol + 1;
 
-  if (lineMatch.hasMatch()) {
-    QString lineValue = lineMatch.captured(1).trimmed();
+    if (isRule(line))
+      continue;
+    line = stripBlockMarkers(line);
+    if (line.isEmpty())
+      continue;
 
-    // If there is value on the same line and it's not a list start
-    if (!lineValue.isEmpty()) {
-      // Single tag: tags: mytag
-      // Or comma separated without brackets (less common but possible): tags:
-      // tag1, tag2 ? For now assume single value if not empty
-      tags.append(lineValue);
-    } else {
-      // Look for subsequent lines starting with "- "
-      // We need to find where "tags:" starts
-      int startOffset = lineMatch.capturedEnd();
-
-      // Split frontmatter into lines starting from tags:
-      QString remaining = frontmatter.mid(startOffset);
-      QTextStream stream(&remaining);
-      QString line;
-      while (stream.readLineInto(&line)) {
-        QString trimmed = line.trimmed();
-        if (trimmed.startsWith(QLatin1String("-"))) {
-          QString tag = trimmed.mid(1).trimmed();
-          tag.remove(QLatin1Char('"'));
-          tag.remove(QLatin1Char('\''));
-          if (!tag.isEmpty()) {
-            tags.append(tag);
-          }
-        } else if (trimmed.contains(QLatin1String(":"))) {
-          // Next key found, stop
-          break;
-        } else if (trimmed.isEmpty()) {
-          continue;
-        } else {
-          // Indentation or continuation? If not starting with -, maybe stop
-          // But YAML is indentation based. For simplicity, we stop if we hit
-          // something that looks like a key or doesn't start with -
-          break;
-        }
-      }
-    }
+    if (!preview.isEmpty())
+      preview += u' ';
+    appendPlainInline(line, preview);
   }
 
-  return tags;
+  preview = preview.simplified();
+  if (preview.size() > maxLength)
+    preview = preview.left(maxLength) + QStringLiteral("...");
+  return preview;
 }
 
-bool NotesIndex::parsePinned(const QString &frontmatter) {
-  QRegularExpression pinnedRegex(QStringLiteral("pinned:\\s*(true|false)"),
-                                 QRegularExpression::CaseInsensitiveOption);
-  QRegularExpressionMatch match = pinnedRegex.match(frontmatter);
-  if (match.hasMatch()) {
-    return match.captured(1).toLower() == QLatin1String("true");
+bool NotesIndex::hasOpenTask(QStringView body) {
+  // "- [ ]", "* [ ]", "+ [ ]" or "1. [ ]" at the start of a line, indented
+  // or quoted
+  for (qsizetype at = body.indexOf(QLatin1String("[ ]")); at >= 0;
+       at = body.indexOf(QLatin1String("[ ]"), at + 3)) {
+    qsizetype start = body.lastIndexOf(u'\n', at) + 1;
+    QStringView prefix = body.mid(start, at - start).trimmed();
+    while (prefix.startsWith(u'>'))
+      prefix = prefix.mid(1).trimmed();
+    if (prefix.size() == 1 &&
+        (prefix[0] == u'-' || prefix[0] == u'*' || prefix[0] == u'+'))
+      return true;
+    if (prefix.size() > 1 && (prefix.back() == u'.' || prefix.back() == u')')) {
+      bool digits = true;
+      for (QChar c : prefix.chopped(1))
+        digits = digits && c.isDigit();
+      if (digits)
+        return true;
+    }
   }
   return false;
 }
 
 QStringList NotesIndex::parseWikiLinks(const QString &content) {
   QStringList links;
-  QRegularExpression wikiRegex(QStringLiteral("\\[\\[([^\\]]+)\\]\\]"));
-  QRegularExpressionMatchIterator it = wikiRegex.globalMatch(content);
-
-  while (it.hasNext()) {
-    QRegularExpressionMatch match = it.next();
-    QString link = match.captured(1).trimmed();
-    if (!link.isEmpty() && !links.contains(link)) {
-      links.append(link);
+  QSet<QString> seen;
+
+  // Plain scan for "[[...]]" on one line; this runs over every full body
+  // during a rebuild, so no regex
+  qsizetype from = 0;
+  while ((from = content.indexOf(QLatin1String("[["), from)) >= 0) {
+    qsizetype end = content.indexOf(QLatin1String("]]"), from + 2);
+    if (end < 0)
+      break;
+
+    QStringView inner = QStringView(content).mid(from + 2, end - from - 2);
+    qsizetype open = inner.lastIndexOf(QLatin1String("[["));
+    if (open >= 0)
+      inner = inner.mid(open + 2);
+    if (!inner.contains(u'\n')) {
+      QString target = NotesStore::linkTarget(inner);
+      if (!target.isEmpty() && !seen.contains(target.toCaseFolded())) {
+        seen.insert(target.toCaseFolded());
+        links.append(target);
+      }
     }
+    from = end + 2;
   }
 
   return links;
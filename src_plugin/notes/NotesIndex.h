@@ -1,36 +1,37 @@
 #pragma once
 
+#include "AttachmentIndex.h"
+#include "NoteMetadata.h"
+#include "NoteQuery.h"
+#include "NotesIndexer.h"
+#include "NotesStore.h"
+#include "TrigramIndex.h"
+#include "VaultWalker.h"
+#include "VaultWatcher.h"
 #include <QDateTime>
-#include <QFileSystemWatcher>
+#include <QElapsedTimer>
 #include <QFutureWatcher>
 #include <QHash>
-#include <QMap>
-#include <QMultiHash>
 #include <QObject>
 #include <QString>
 #include <QStringList>
+#include <QTimer>
 #include <QVector>
 #include <QtQml>
 
-/**
- * @brief Lightweight metadata structure - NO content stored
- */
-struct NoteMetadata {
-  QString filePath;
-  QString title;
-  QStringList tags;
-  QDateTime lastModified;
-  bool isPinned = false;
-  bool isFolder = false;
-  QString color;
-};
-
 /**
  * @brief Singleton index managing metadata for all notes.
  *
- * This class maintains an in-memory index of note metadata using
- * head-only parsing (first 1024 bytes) for memory efficiency.
- * Supports instant lookups by path, tag, and title.
+ * This class maintains an in-memory index of note metadata, stored
+ * column-wise by note ID in a NotesStore. Each note is read once per
+ * change: frontmatter from its head, [[links]] from the whole body, a
+ * short plain-text preview and the byte ranges of its headings and
+ * ^block-ids, so the link graph is complete, list views need no file access
+ * and embeds read only the part they show. Supports instant lookups by
+ * path, tag, title, backlink and block ID. The index is persisted in the
+ * vault (NotesIndexCache) so unchanged notes are not reopened on the next
+ * launch, and kept current by a recursive VaultWatcher whose batched change
+ * sets are applied entry by entry.
  */
 class NotesIndex : public QObject {
   Q_OBJECT
@@ -64,11 +65,86 @@ public:
   Q_INVOKABLE NoteMetadata getMetadata(const QString &path) const;
   Q_INVOKABLE QVector<NoteMetadata>
   getItemsInFolder(const QString &folderPath) const;
+  /** @brief Notes tagged @p tag or a tag nested below it. */
   Q_INVOKABLE QVector<NoteMetadata> getNotesByTag(const QString &tag) const;
+  /**
+   * @brief Fuzzy title and tag search, best matches first (at most
+   * kMaxTitleResults).
+   */
   Q_INVOKABLE QVector<NoteMetadata> searchByTitle(const QString &query) const;
+  /**
+   * @brief Notes linking to the note titled @p title, whether by its title
+   * or one of its aliases.
+   */
   Q_INVOKABLE QStringList getBacklinks(const QString &title) const;
+  /** @brief Existing notes linked from the note at @p path. */
+  Q_INVOKABLE QStringList getOutgoingLinks(const QString &path) const;
+  /**
+   * @brief Notes linked from @p path worth reading ahead: most recently
+   * modified first, at most @p maxCount of them and @p maxBytes together.
+   */
+  QStringList linkedNotesToPrefetch(const QString &path, int maxCount,
+                                    qint64 maxBytes) const;
+  /**
+   * @brief Every tag and tag prefix in tree order ("a", "a/b", "b"). Built
+   * once per tag generation, so repeated reads are free.
+   */
   Q_INVOKABLE QStringList getAllTags() const;
+
+  /**
+   * @brief Notes that may contain @p query in their body, narrowed with the
+   * trigram index (every note until it is ready). Callers verify the text.
+   */
+  QVector<NoteMetadata> contentCandidates(const QString &query) const;
+  /** @brief Whether the trigram index covers the current vault yet. */
+  bool isContentIndexReady() const;
+  /**
+   * @brief Notes that can match @p query, answered from the index (see
+   * NoteQuery::candidates()); callers run NoteQuery::matches() on them if
+   * the query needs the text.
+   */
+  QVector<NoteMetadata> queryCandidates(const NoteQuery &query) const;
   Q_INVOKABLE QString findPathByTitle(const QString &title) const;
+  /** @brief Path of a note defining the block ^@p blockId, or empty. */
+  Q_INVOKABLE QString findPathByBlock(const QString &blockId) const;
+
+  /**
+   * @brief Fills @p out with the heading and block ranges of the note at
+   * @p path if its indexed entry has this @p size and @p mtimeMs, i.e. the
+   * ranges still fit the file.
+   */
+  bool lookupOutline(const QString &path, qint64 size, qint64 mtimeMs,
+                     NoteOutline &out) const;
+
+  /**
+   * @brief Whether attachments of @p rootPath are indexed, i.e. a scan of
+   * that vault has finished.
+   */
+  bool hasAttachmentIndex(const QString &rootPath) const;
+  /**
+   * @brief File an embed like ![[image.png]] in the note at @p notePath
+   * refers to, resolved in memory (see AttachmentIndex::resolve()).
+   */
+  QString resolveAttachment(const QString &link,
+                            const QString &notePath) const;
+  /** @brief Records a file the app just wrote, ahead of the watcher. */
+  void addAttachment(const QString &path);
+
+  /**
+   * @brief Canonical form used as index key: local, absolute, cleaned.
+   * Already-canonical paths are returned without touching QUrl/QFileInfo.
+   */
+  static QString normalizePath(const QString &path);
+
+  /**
+   * @brief The first @p maxLength characters of a note body as plain text:
+   * markdown markers dropped, links reduced to their text, lines joined.
+   * Longer bodies are cut and end in "...". Stops reading once it has
+   * enough, so cost does not grow with the note.
+   */
+  static constexpr int kPreviewLength = 100;
+  static QString extractPreview(QStringView body,
+                                int maxLength = kPreviewLength);
 
 signals:
   void indexingChanged();
@@ -77,19 +153,32 @@ signals:
   void indexReady();
   void indexUpdated();
   void entryUpdated(const QString &path);
+  // Emitted once per applied watcher batch with every path it touched
+  void entriesChanged(const QStringList &paths);
+  // A tag or tag prefix appeared or disappeared (see getAllTags())
+  void tagsChanged();
 
 private slots:
-  void onScanFinished();
-  void onDirectoryChanged(const QString &path);
+  void onScanDiscovered(int generation, int totalFiles);
+  void onScanBatch(int generation, const QVector<NoteMetadata> &batch);
+  void onScanAttachments(int generation, const QStringList &paths);
+  void onScanFinished(int generation, const NotesIndexer::Stats &stats);
+  void onVaultChanged(const VaultWatcher::ChangeSet &changes);
+  void writeCache();
+  void onTrigramsUpdated();
+  void writeTrigrams();
 
 private:
+  friend class NotesIndexer;
+
   static NotesIndex *s_instance;
+  static constexpr int kMaxTitleResults = 500;
 
-  // Core index structures
-  QHash<QString, NoteMetadata> m_index;    // path -> metadata
-  QMultiHash<QString, QString> m_tagIndex; // tag -> paths
-  QMap<QString, QStringList> m_backlinks;  // title -> source paths
-  QMap<QString, QString> m_titleToPath;    // title -> path
+  // Core index structure: ID-based columns plus tag/title/link lookups
+  NotesStore m_store;
+  mutable QStringList m_allTags;
+  mutable quint64 m_allTagsGeneration = ~quint64(0);
+  quint64 m_announcedTagGeneration = 0;
 
   // State
   QString m_rootPath;
@@ -98,16 +187,61 @@ private:
   int m_totalFiles = 0;
 
   // Watchers
-  QFileSystemWatcher *m_fsWatcher = nullptr;
-  QFutureWatcher<QVector<NoteMetadata>> *m_watcher = nullptr;
+  VaultWatcher *m_watcher = nullptr;
+  QVector<VaultWatcher::ChangeSet> m_deferredChanges; // arrived mid-scan
+  NotesIndexer *m_indexer = nullptr;
+  int m_scanGeneration = 0;
+  QVector<NoteMetadata> m_scanResults; // batches of the running scan
+  QStringList m_scanAttachments;
+
+  // Non-note files by name, for resolving embeds without disk access
+  AttachmentIndex m_attachments;
+  QString m_attachmentsRoot; // vault m_attachments was filled from
+  QElapsedTimer m_scanTimer;
+
+  // On-disk cache, rewritten in the background shortly after changes
+  QTimer *m_cacheTimer = nullptr;
+  QFuture<bool> m_cacheWrite;
+
+  // Full-text trigram index, reconciled with the store off the GUI thread
+  TrigramIndex m_trigrams;
+  QFutureWatcher<bool> *m_trigramWatcher = nullptr;
+  std::atomic<bool> m_trigramCancel{false};
+  QString m_trigramRoot; // vault m_trigrams was loaded for
+  QFuture<void> m_trigramLoad; // reload for m_trigramRoot
+  bool m_trigramsReady = false;
+  bool m_trigramRerun = false;
+  // Written to disk in the background once edits settle, and on shutdown
+  QTimer *m_trigramSaveTimer = nullptr;
+  QFuture<bool> m_trigramSave;
 
   // Parsing helpers
-  static NoteMetadata parseFileHeader(const QString &path);
-  static QString parseColor(const QString &frontmatter);
-  static QStringList parseTags(const QString &frontmatter);
-  static bool parsePinned(const QString &frontmatter);
+  // Adds the time spent parsing frontmatter to *frontmatterNs and sets
+  // *trigrams to the note's TrigramIndex::extract(), if given
+  static NoteMetadata parseFileHeader(const QString &path,
+                                      qint64 *frontmatterNs = nullptr,
+                                      QVector<quint64> *trigrams = nullptr);
+  // parseFileHeader() that also hands the note to the trigram index
+  NoteMetadata readNote(const QString &path);
+  static QString parseColor(const QString &value);
   static QStringList parseWikiLinks(const QString &content);
+  static bool hasOpenTask(QStringView body);
+  static NoteMetadata folderMetadata(const QString &path, const QString &name,
+                                     qint64 mtimeMs);
+  // A note as its directory listing describes it, without opening it
+  static NoteMetadata listedNoteMetadata(const VaultWalker::Entry &entry);
 
   void processIndexResults(const QVector<NoteMetadata> &results);
-  void watchDirectory(const QString &path);
+  void applyChanges(const VaultWatcher::ChangeSet &changes);
+
+  // Incremental maintenance of every lookup structure
+  void insertEntry(const NoteMetadata &meta);
+  bool dropEntry(const QString &path);
+  // The entry @p root and everything below it, parents first
+  QVector<NoteId> subtree(NoteId root) const;
+  bool dropTree(const QString &dirPath);
+  void renameTree(const QString &from, const QString &to);
+  void scheduleCacheWrite();
+  void scheduleTrigramUpdate();
+  void announceTagChanges();
 };
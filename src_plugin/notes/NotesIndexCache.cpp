@@ -0,0 +1,173 @@
+#include "NotesIndexCache.h"
+#include <QDebug>
+#include <QDir>
+#include <QSaveFile>
+#include <cstring>
+
+namespace {
+const char kMagic[4] = {'N', 'I', 'D', 'X'};
+
+QString joinList(const QStringList &list) {
+  return list.join(QLatin1Char('\n'));
+}
+} // namespace
+
+NotesIndexCache::~NotesIndexCache() { close(); }
+
+QString NotesIndexCache::cachePath(const QString &rootPath) {
+  return QDir::cleanPath(rootPath) + QStringLiteral("/.notes-index.bin");
+}
+
+void NotesIndexCache::close() {
+  if (m_data) {
+    m_file.unmap(const_cast<uchar *>(m_data));
+    m_data = nullptr;
+  }
+  m_file.close();
+  m_size = 0;
+  m_byPath.clear();
+}
+
+bool NotesIndexCache::open(const QString &rootPath) {
+  close();
+  m_rootPrefix = QDir::cleanPath(rootPath) + QLatin1Char('/');
+
+  m_file.setFileName(cachePath(rootPath));
+  if (!m_file.open(QIODevice::ReadOnly))
+    return false;
+
+  m_size = m_file.size();
+  if (m_size < static_cast<qint64>(sizeof(Header))) {
+    close();
+    return false;
+  }
+
+  m_data = m_file.map(0, m_size);
+  if (!m_data) {
+    close();
+    return false;
+  }
+
+  Header header;
+  std::memcpy(&header, m_data, sizeof(Header));
+  quint64 recordsEnd =
+      sizeof(Header) + quint64(header.count) * sizeof(Record);
+  if (std::memcmp(header.magic, kMagic, 4) != 0 ||
+      header.version != kVersion || recordsEnd > header.stringsOffset ||
+      header.stringsOffset + header.stringsSize > quint64(m_size)) {
+    qDebug() << "NotesIndexCache: ignoring stale or corrupt cache"
+             << m_file.fileName();
+    close();
+    return false;
+  }
+  m_stringsOffset = header.stringsOffset;
+  m_stringsSize = header.stringsSize;
+
+  m_byPath.reserve(header.count);
+  for (quint32 i = 0; i < header.count; ++i) {
+    m_byPath.insert(stringAt(recordAt(i).path), i);
+  }
+  return true;
+}
+
+NotesIndexCache::Record NotesIndexCache::recordAt(quint32 i) const {
+  Record record;
+  std::memcpy(&record, m_data + sizeof(Header) + quint64(i) * sizeof(Record),
+              sizeof(Record));
+  return record;
+}
+
+QString NotesIndexCache::stringAt(const StringRef &ref) const {
+  if (quint64(ref.offset) + ref.length > m_stringsSize)
+    return QString();
+  return QString::fromUtf8(
+      reinterpret_cast<const char *>(m_data + m_stringsOffset + ref.offset),
+      ref.length);
+}
+
+bool NotesIndexCache::lookup(const QString &path, qint64 size, qint64 mtimeMs,
+                             NoteMetadata &out) const {
+  if (!m_data || !path.startsWith(m_rootPrefix))
+    return false;
+
+  auto it = m_byPath.constFind(path.mid(m_rootPrefix.size()));
+  if (it == m_byPath.constEnd())
+    return false;
+
+  Record record = recordAt(it.value());
+  if (record.size != size || record.mtimeMs != mtimeMs)
+    return false;
+
+  out.filePath = path;
+  out.title = stringAt(record.title);
+  out.color = stringAt(record.color);
+  out.tags = stringAt(record.tags).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+  out.links =
+      stringAt(record.links).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+  out.aliases =
+      stringAt(record.aliases).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+  out.preview = stringAt(record.preview);
+  out.outline = NoteOutline::fromString(stringAt(record.outline));
+  out.isPinned = record.flags & Pinned;
+  out.hasTasks = record.flags & HasTasks;
+  out.isFolder = false;
+  out.fileSize = size;
+  out.lastModified = QDateTime::fromMSecsSinceEpoch(mtimeMs);
+  return true;
+}
+
+bool NotesIndexCache::write(const QString &rootPath,
+                            const QVector<NoteMetadata> &entries) {
+  QString rootPrefix = QDir::cleanPath(rootPath) + QLatin1Char('/');
+
+  QVector<Record> records;
+  records.reserve(entries.size());
+  QByteArray strings;
+
+  auto addString = [&strings](const QString &s) {
+    QByteArray utf8 = s.toUtf8();
+    StringRef ref{static_cast<quint32>(strings.size()),
+                  static_cast<quint32>(utf8.size())};
+    strings.append(utf8);
+    return ref;
+  };
+
+  for (const NoteMetadata &meta : entries) {
+    if (meta.isFolder || !meta.filePath.startsWith(rootPrefix))
+      continue;
+
+    Record record{};
+    record.size = meta.fileSize;
+    record.mtimeMs = meta.lastModified.toMSecsSinceEpoch();
+    record.path = addString(meta.filePath.mid(rootPrefix.size()));
+    record.title = addString(meta.title);
+    record.color = addString(meta.color);
+    record.tags = addString(joinList(meta.tags));
+    record.links = addString(joinList(meta.links));
+    record.aliases = addString(joinList(meta.aliases));
+    record.preview = addString(meta.preview);
+    record.outline = addString(meta.outline.toString());
+    record.flags =
+        (meta.isPinned ? Pinned : 0) | (meta.hasTasks ? HasTasks : 0);
+    records.append(record);
+  }
+
+  Header header{};
+  std::memcpy(header.magic, kMagic, 4);
+  header.version = kVersion;
+  header.count = static_cast<quint32>(records.size());
+  header.stringsOffset =
+      sizeof(Header) + quint64(records.size()) * sizeof(Record);
+  header.stringsSize = static_cast<quint64>(strings.size());
+
+  // QSaveFile writes to a temporary file and renames it over the old cache
+  // on commit, so readers never observe a half-written index
+  QSaveFile file(cachePath(rootPath));
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+  file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+  file.write(reinterpret_cast<const char *>(records.constData()),
+             qint64(records.size()) * sizeof(Record));
+  file.write(strings);
+  return file.commit();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "NoteMetadata.h"
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Persistent, memory-mapped snapshot of the note metadata index.
+ *
+ * The cache lives in the vault root and is keyed by vault-relative path.
+ * An entry is only reused when the file's size and modification time still
+ * match, so edits made while the plugin was closed are always reparsed.
+ *
+ * Layout (native endian, all offsets from the start of the file):
+ *   Header | Record[count] | UTF-8 string blob
+ * Records are fixed size so they can be read straight from the mapping;
+ * list fields (tags, aliases, links) are stored as '\n'-joined strings and
+ * the outline in its NoteOutline::toString() form.
+ */
+class NotesIndexCache {
+public:
+  static constexpr quint32 kVersion = 5;
+
+  NotesIndexCache() = default;
+  ~NotesIndexCache();
+
+  NotesIndexCache(const NotesIndexCache &) = delete;
+  NotesIndexCache &operator=(const NotesIndexCache &) = delete;
+
+  /**
+   * @brief Maps the cache of the given vault. Fails (and stays empty) when
+   * the file is missing, truncated or written by another version.
+   */
+  bool open(const QString &rootPath);
+  void close();
+
+  int count() const { return m_byPath.size(); }
+
+  /**
+   * @brief Fills @p out from the cache if @p path is present with the same
+   * size and modification time (ms since epoch).
+   */
+  bool lookup(const QString &path, qint64 size, qint64 mtimeMs,
+              NoteMetadata &out) const;
+
+  /**
+   * @brief Serializes the note entries (folders are skipped) and atomically
+   * replaces the cache file. Safe to call from a worker thread.
+   */
+  static bool write(const QString &rootPath,
+                    const QVector<NoteMetadata> &entries);
+
+  static QString cachePath(const QString &rootPath);
+
+private:
+  struct Header {
+    char magic[4];
+    quint32 version;
+    quint32 count;
+    quint32 reserved;
+    quint64 stringsOffset;
+    quint64 stringsSize;
+  };
+
+  struct StringRef {
+    quint32 offset;
+    quint32 length;
+  };
+
+  struct Record {
+    qint64 size;
+    qint64 mtimeMs;
+    StringRef path; // relative to the vault root
+    StringRef title;
+    StringRef color;
+    StringRef tags;
+    StringRef links;
+    StringRef aliases;
+    StringRef preview;
+    StringRef outline;
+    quint32 flags;
+    quint32 reserved;
+  };
+
+  enum RecordFlags : quint32 { Pinned = 1u << 0, HasTasks = 1u << 1 };
+
+  Record recordAt(quint32 i) const;
+  QString stringAt(const StringRef &ref) const;
+
+  QFile m_file;
+  const uchar *m_data = nullptr;
+  qint64 m_size = 0;
+  quint64 m_stringsOffset = 0;
+  quint64 m_stringsSize = 0;
+  QString m_rootPrefix; // cleaned root + '/'
+  QHash<QString, quint32> m_byPath;
+};
@@ -0,0 +1,190 @@
+#include "NotesIndexer.h"
+#include "NotesIndex.h"
+#include "NotesIndexCache.h"
+#include "TrigramIndex.h"
+#include "VaultWalker.h"
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QSemaphore>
+#include <QThread>
+
+struct NotesIndexer::Job {
+  int generation = 0;
+  QString rootPath;
+  std::atomic<bool> cancelled{false};
+
+  // One permit per batch allowed between the enumerator and the parsers
+  int maxInFlight = 1;
+  QSemaphore inFlight;
+
+  NotesIndexCache cache;
+  TrigramIndex *trigrams = nullptr;
+  QFuture<void> trigramsLoaded;
+  std::atomic<int> reused{0};
+  std::atomic<int> parsed{0};
+  std::atomic<qint64> parseNs{0};
+  std::atomic<qint64> frontmatterNs{0};
+};
+
+NotesIndexer::NotesIndexer(QObject *parent) : QObject(parent) {
+  m_pool.setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+  m_pool.setObjectName(QStringLiteral("NotesIndexer"));
+  m_enumeratorPool.setMaxThreadCount(1);
+}
+
+NotesIndexer::~NotesIndexer() { cancel(); }
+
+int NotesIndexer::start(const QString &rootPath, TrigramIndex *trigrams,
+                        const QFuture<void> &trigramsLoaded) {
+  cancel();
+
+  auto job = std::make_shared<Job>();
+  job->generation = ++m_generation;
+  job->rootPath = QDir::cleanPath(rootPath);
+  job->trigrams = trigrams;
+  job->trigramsLoaded = trigramsLoaded;
+  job->maxInFlight = m_pool.maxThreadCount() * 2;
+  job->inFlight.release(job->maxInFlight);
+
+  m_job = job;
+  m_running = true;
+  m_enumeratorPool.start([this, job]() { runEnumerator(job); });
+  return job->generation;
+}
+
+void NotesIndexer::cancel() {
+  if (m_job) {
+    m_job->cancelled = true;
+    // Queued parser tasks still run, but return at once and release their
+    // permit, so the enumerator's final drain cannot block
+    m_enumeratorPool.waitForDone();
+    m_pool.waitForDone();
+    m_job.reset();
+  }
+  m_running = false;
+}
+
+void NotesIndexer::runEnumerator(std::shared_ptr<Job> job) {
+  Stats stats;
+  stats.cacheLoaded = job->cache.open(job->rootPath);
+
+  QVector<FileEntry> pending;
+  pending.reserve(kBatchSize);
+
+  auto submit = [this, job, &pending]() {
+    if (pending.isEmpty())
+      return;
+    // Blocks while the parsers are saturated (bounded in-flight I/O)
+    job->inFlight.acquire();
+    QVector<FileEntry> batch = std::move(pending);
+    pending = QVector<FileEntry>();
+    pending.reserve(kBatchSize);
+    m_pool.start([this, job, batch]() { runParser(job, batch); });
+  };
+
+  QVector<NoteMetadata> folders;
+  auto flushFolders = [this, job, &folders, &stats]() {
+    if (folders.isEmpty())
+      return;
+    stats.folders += folders.size();
+    emit batchReady(job->generation, folders);
+    folders.clear();
+  };
+
+  QStringList attachments;
+
+  // Each directory is listed once; notes and folders come with their stat
+  VaultWalker::walk(
+      job->rootPath, VaultWalker::All,
+      [&](const VaultWalker::Entry &entry) {
+        if (entry.isDir) {
+          folders.append(NotesIndex::folderMetadata(entry.path, entry.name,
+                                                    entry.mtimeMs));
+          if (folders.size() >= kBatchSize)
+            flushFolders();
+          return;
+        }
+        if (!VaultWalker::isNoteName(entry.name)) {
+          attachments.append(entry.path);
+          return;
+        }
+
+        pending.append({entry.path, entry.size, entry.mtimeMs});
+        stats.notes++;
+        if (pending.size() >= kBatchSize) {
+          submit();
+          emit discovered(job->generation, stats.notes);
+        }
+      },
+      &job->cancelled);
+  flushFolders();
+  submit();
+  emit discovered(job->generation, stats.notes);
+  stats.attachments = int(attachments.size());
+  emit attachmentsFound(job->generation, attachments);
+
+  // Wait for every parser to hand its batch over
+  job->inFlight.acquire(job->maxInFlight);
+  job->inFlight.release(job->maxInFlight);
+
+  if (job->cancelled)
+    return;
+
+  stats.reused = job->reused;
+  stats.parsed = job->parsed;
+  stats.parseNs = job->parseNs;
+  stats.frontmatterNs = job->frontmatterNs;
+  // New, changed or deleted notes make the cache stale
+  stats.cacheDirty = stats.parsed > 0 || job->cache.count() != stats.reused;
+  job->cache.close();
+
+  m_running = false;
+  emit finished(job->generation, stats);
+}
+
+void NotesIndexer::runParser(std::shared_ptr<Job> job,
+                             QVector<FileEntry> files) {
+  if (job->cancelled) {
+    job->inFlight.release();
+    return;
+  }
+
+  QVector<NoteMetadata> batch;
+  batch.reserve(files.size());
+  qint64 parseNs = 0, frontmatterNs = 0;
+  QElapsedTimer timer;
+  QVector<quint64> trigrams;
+  for (const FileEntry &file : std::as_const(files)) {
+    NoteMetadata meta;
+    // Entries whose size and mtime are unchanged come from the cache
+    // without opening the note
+    if (job->cache.lookup(file.path, file.size, file.mtimeMs, meta)) {
+      job->reused++;
+    } else {
+      // The trigram index is (re)loaded while the scan starts; wait for it
+      // before adding to it, and skip notes it already has
+      const TrigramIndex::Source source{file.path, file.size, file.mtimeMs};
+      bool wantTrigrams = false;
+      if (job->trigrams) {
+        job->trigramsLoaded.waitForFinished();
+        wantTrigrams = !job->trigrams->isCurrent(source);
+      }
+      timer.start();
+      meta = NotesIndex::parseFileHeader(file.path, &frontmatterNs,
+                                         wantTrigrams ? &trigrams : nullptr);
+      parseNs += timer.nsecsElapsed();
+      job->parsed++;
+      // Nothing extracted may mean the read failed; update() retries those
+      if (wantTrigrams && !trigrams.isEmpty())
+        job->trigrams->addDocument(source, trigrams);
+    }
+    meta.filePath = file.path;
+    batch.append(meta);
+  }
+  job->parseNs += parseNs;
+  job->frontmatterNs += frontmatterNs;
+
+  emit batchReady(job->generation, batch);
+  job->inFlight.release();
+}
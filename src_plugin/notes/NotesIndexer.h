@@ -0,0 +1,94 @@
+#pragma once
+
+#include "NoteMetadata.h"
+#include <QFuture>
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+class NotesIndexCache;
+class TrigramIndex;
+
+/**
+ * @brief Three-stage background scan feeding NotesIndex.
+ *
+ * 1. One enumerator thread walks the vault directory by directory and cuts
+ *    the notes it finds into batches. Other files are collected as
+ *    attachments on the way.
+ * 2. Batches are parsed in parallel on a dedicated pool. A semaphore bounds
+ *    the batches in flight so the enumerator cannot race ahead of the disk.
+ *    Notes that are read here also go into the trigram index, so it never
+ *    has to open them a second time.
+ * 3. Parsed batches are delivered to the owner's thread through the queued
+ *    batchReady() signal, where they are merged into the index.
+ *
+ * Every scan carries a generation number; cancelled scans stop at the next
+ * batch boundary and their late batches are ignored by the receiver.
+ */
+class NotesIndexer : public QObject {
+  Q_OBJECT
+
+public:
+  struct Stats {
+    int notes = 0;
+    int folders = 0;
+    int attachments = 0;
+    int reused = 0; // served from NotesIndexCache
+    int parsed = 0;
+    qint64 parseNs = 0; // reading and parsing the notes in `parsed`
+    qint64 frontmatterNs = 0;
+    bool cacheLoaded = false;
+    bool cacheDirty = false;
+  };
+
+  explicit NotesIndexer(QObject *parent = nullptr);
+  ~NotesIndexer() override;
+
+  /**
+   * @brief Starts scanning @p rootPath, cancelling any running scan. Parsed
+   * notes are added to @p trigrams, if given, once @p trigramsLoaded has
+   * finished.
+   * @return The generation tagged onto this scan's signals.
+   */
+  int start(const QString &rootPath, TrigramIndex *trigrams = nullptr,
+            const QFuture<void> &trigramsLoaded = {});
+
+  /**
+   * @brief Cancels the running scan and waits for its workers to stop.
+   */
+  void cancel();
+
+  bool isRunning() const { return m_running.load(); }
+  int generation() const { return m_generation.load(); }
+
+signals:
+  void discovered(int generation, int totalFiles);
+  void batchReady(int generation, const QVector<NoteMetadata> &batch);
+  // Paths of the non-note files met during the walk
+  void attachmentsFound(int generation, const QStringList &paths);
+  void finished(int generation, const NotesIndexer::Stats &stats);
+
+private:
+  struct Job;
+  struct FileEntry {
+    QString path;
+    qint64 size = 0;
+    qint64 mtimeMs = 0;
+  };
+
+  void runEnumerator(std::shared_ptr<Job> job);
+  void runParser(std::shared_ptr<Job> job, QVector<FileEntry> files);
+
+  static constexpr int kBatchSize = 64;
+
+  QThreadPool m_pool; // parser stage
+  QThreadPool m_enumeratorPool;
+  std::shared_ptr<Job> m_job;
+  std::atomic<int> m_generation{0};
+  std::atomic<bool> m_running{false};
+};
+
+Q_DECLARE_METATYPE(NotesIndexer::Stats)
@@ -1,31 +1,147 @@
 #include "NotesModel.h"
+#include "Frontmatter.h"
+#include "NoteQuery.h"
 #include "NotesIndex.h"
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QFile>
-#include <QRegularExpression>
-#include <QTextStream>
+#include <QSet>
+#include <QTimer>
 #include <QtConcurrent>
 
+namespace {
+NoteItem toNoteItem(const NoteMetadata &meta) {
+  NoteItem item;
+  item.type = meta.isFolder ? QStringLiteral("folder") : QStringLiteral("note");
+  item.title = meta.title;
+  item.path = meta.filePath;
+  item.date = meta.lastModified.toString(QStringLiteral("yyyy-MM-dd HH:mm"));
+  item.color = meta.color;
+  item.preview = meta.preview;
+  item.tags = meta.tags;
+  item.isPinned = meta.isPinned;
+  item.lastModified = meta.lastModified;
+  return item;
+}
+
+QVector<int> changedRoles(const NoteItem &from, const NoteItem &to) {
+  QVector<int> roles;
+  if (from.type != to.type)
+    roles.append(NotesModel::TypeRole);
+  if (from.title != to.title)
+    roles.append(NotesModel::TitleRole);
+  if (from.date != to.date)
+    roles.append(NotesModel::DateRole);
+  if (from.color != to.color)
+    roles.append(NotesModel::ColorRole);
+  if (from.preview != to.preview)
+    roles.append(NotesModel::PreviewRole);
+  if (from.tags != to.tags)
+    roles.append(NotesModel::TagsRole);
+  if (from.isPinned != to.isPinned)
+    roles.append(NotesModel::IsPinnedRole);
+  if (from.snippet != to.snippet)
+    roles.append(NotesModel::SnippetRole);
+  if (from.matchCount != to.matchCount)
+    roles.append(NotesModel::MatchCountRole);
+  return roles;
+}
+
+// Flags the elements of a longest strictly increasing subsequence of @p seq
+QVector<bool> increasingRun(const QVector<int> &seq) {
+  QVector<int> tails; // per length, index of the smallest tail seen
+  QVector<int> previous(seq.size(), -1);
+  for (int k = 0; k < seq.size(); ++k) {
+    auto it = std::lower_bound(
+        tails.begin(), tails.end(), k,
+        [&seq](int element, int value) { return seq[element] < seq[value]; });
+    int length = int(it - tails.begin());
+    previous[k] = length > 0 ? tails[length - 1] : -1;
+    if (it == tails.end())
+      tails.append(k);
+    else
+      *it = k;
+  }
+
+  QVector<bool> flags(seq.size(), false);
+  for (int k = tails.isEmpty() ? -1 : tails.last(); k >= 0; k = previous[k])
+    flags[k] = true;
+  return flags;
+}
+
+// Context around the first match of @p query in @p text as rich text, the
+// match in bold
+QString searchSnippet(const QString &text, const QString &query) {
+  constexpr qsizetype kBefore = 40;
+  constexpr qsizetype kAfter = 80;
+
+  qsizetype at = text.indexOf(query, 0, Qt::CaseInsensitive);
+  qsizetype length = query.size();
+  if (at < 0) {
+    // Matched only after case folding changed lengths ("ß" vs "ss")
+    at = 0;
+    length = 0;
+  }
+  const qsizetype start = qMax<qsizetype>(0, at - kBefore);
+  const qsizetype end = qMin(text.size(), at + length + kAfter);
+
+  auto escaped = [&text](qsizetype from, qsizetype count) {
+    QString part = text.mid(from, count);
+    part.replace(QLatin1Char('\n'), QLatin1Char(' '));
+    part.replace(QLatin1Char('\r'), QLatin1Char(' '));
+    part.replace(QLatin1Char('\t'), QLatin1Char(' '));
+    return part.toHtmlEscaped();
+  };
+
+  QString snippet;
+  if (start > 0)
+    snippet += QStringLiteral("...");
+  snippet += escaped(start, at - start);
+  if (length > 0) {
+    snippet += QStringLiteral("<b>") + escaped(at, length) +
+               QStringLiteral("</b>");
+  }
+  snippet += escaped(at + length, end - at - length);
+  if (end < text.size())
+    snippet += QStringLiteral("...");
+  return snippet;
+}
+
+int countOccurrences(const QString &folded, const QString &foldedTerm) {
+  int count = 0;
+  if (foldedTerm.isEmpty())
+    return count;
+  for (qsizetype at = folded.indexOf(foldedTerm); at >= 0;
+       at = folded.indexOf(foldedTerm, at + foldedTerm.size()))
+    count++;
+  return count;
+}
+
+// Pinned first, then newest first, as text search results are listed
+void sortByDisplayOrder(QVector<NoteMetadata> &notes) {
+  std::sort(notes.begin(), notes.end(),
+            [](const NoteMetadata &a, const NoteMetadata &b) {
+              if (a.isPinned != b.isPinned)
+                return a.isPinned;
+              return a.lastModified > b.lastModified;
+            });
+}
+} // namespace
+
 NotesModel::NotesModel(QObject *parent)
     : QAbstractListModel(parent),
-      m_watcher(new QFutureWatcher<QVector<NoteItem>>(this)),
-      m_contentSearchWatcher(new QFutureWatcher<QVector<NoteItem>>(this)),
-      m_fsWatcher(new QFileSystemWatcher(this)) {
+      m_watcher(new QFutureWatcher<QVector<NoteItem>>(this)) {
   connect(m_watcher, &QFutureWatcher<QVector<NoteItem>>::finished, this,
           &NotesModel::onScanFinished);
-  connect(m_contentSearchWatcher, &QFutureWatcher<QVector<NoteItem>>::finished,
-          this, &NotesModel::onContentSearchFinished);
-  connect(m_fsWatcher, &QFileSystemWatcher::directoryChanged, this,
-          &NotesModel::onDirectoryChanged);
 
   // Connect to NotesIndex
   connect(NotesIndex::instance(), &NotesIndex::indexReady, this,
           &NotesModel::onIndexReady);
   connect(NotesIndex::instance(), &NotesIndex::indexUpdated, this,
           &NotesModel::onIndexReady);
-  connect(NotesIndex::instance(), &NotesIndex::entryUpdated, this,
-          &NotesModel::onEntryUpdated);
-  connect(NotesIndex::instance(), &NotesIndex::indexUpdated, this,
+  connect(NotesIndex::instance(), &NotesIndex::entriesChanged, this,
+          &NotesModel::onEntriesChanged);
+  connect(NotesIndex::instance(), &NotesIndex::tagsChanged, this,
           &NotesModel::allTagsChanged);
 }
 
@@ -34,10 +150,11 @@ NotesModel::~NotesModel() {
     m_watcher->cancel();
     m_watcher->waitForFinished();
   }
-  if (m_contentSearchWatcher->isRunning()) {
-    m_contentSearchWatcher->cancel();
-    m_contentSearchWatcher->waitForFinished();
-  }
+  // Search workers post to this object, superseded ones included; all of
+  // them must be gone first
+  cancelContentSearch();
+  for (QFuture<void> &future : m_searchFutures)
+    future.waitForFinished();
 }
 
 int NotesModel::rowCount(const QModelIndex &parent) const {
@@ -65,17 +182,18 @@ QVariant NotesModel::data(const QModelIndex &index, int role) const {
   case ColorRole:
     return item.color;
   case PreviewRole:
-    // Lazy load preview if not yet loaded
-    if (item.preview.isEmpty() && item.type == QLatin1String("note")) {
-      // Note: In a real scenario, we might want to make this async
-      // For now, we load it on demand
-      const_cast<NoteItem &>(item).preview = createPreview(item.path);
-    }
+    // Comes from the index; notes it has not parsed yet (listed from disk
+    // during the first scan) stay empty until a delegate asks for them
+    // through requestPreview(), so scrolling never touches the disk
     return item.preview;
   case TagsRole:
     return item.tags;
   case IsPinnedRole:
     return item.isPinned;
+  case SnippetRole:
+    return item.snippet;
+  case MatchCountRole:
+    return item.matchCount;
   default:
     return QVariant();
   }
@@ -85,34 +203,20 @@ QHash<int, QByteArray> NotesModel::roleNames() const {
   return {{TypeRole, "type"},   {TitleRole, "title"},
           {PathRole, "path"},   {DateRole, "date"},
           {ColorRole, "color"}, {PreviewRole, "preview"},
-          {TagsRole, "tags"},   {IsPinnedRole, "isPinned"}};
+          {TagsRole, "tags"},   {IsPinnedRole, "isPinned"},
+          {SnippetRole, "snippet"}, {MatchCountRole, "matchCount"}};
 }
 
 QString NotesModel::currentPath() const { return m_currentPath; }
 
 void NotesModel::setCurrentPath(const QString &path) {
-  QString normalizedPath = path;
-  if (normalizedPath.startsWith(QLatin1String("file:///"))) {
-    normalizedPath = QUrl(normalizedPath).toLocalFile();
-  }
-  normalizedPath =
-      QDir::cleanPath(QFileInfo(normalizedPath).absoluteFilePath());
+  QString normalizedPath = NotesIndex::normalizePath(path);
 
   if (m_currentPath != normalizedPath) {
-    // Remove old path from watcher
-    if (!m_currentPath.isEmpty() &&
-        m_fsWatcher->directories().contains(m_currentPath)) {
-      m_fsWatcher->removePath(m_currentPath);
-    }
-
+    // Changes on disk arrive through NotesIndex::entriesChanged
     m_currentPath = normalizedPath;
     emit currentPathChanged();
 
-    // Add new path to watcher
-    if (!m_currentPath.isEmpty() && QDir(m_currentPath).exists()) {
-      m_fsWatcher->addPath(m_currentPath);
-    }
-
     // Clear search mode when changing paths
     if (m_isSearchMode) {
       m_isSearchMode = false;
@@ -130,12 +234,7 @@ void NotesModel::setCurrentPath(const QString &path) {
 QString NotesModel::rootPath() const { return m_rootPath; }
 
 void NotesModel::setRootPath(const QString &path) {
-  QString normalizedPath = path;
-  if (normalizedPath.startsWith(QLatin1String("file:///"))) {
-    normalizedPath = QUrl(normalizedPath).toLocalFile();
-  }
-  normalizedPath =
-      QDir::cleanPath(QFileInfo(normalizedPath).absoluteFilePath());
+  QString normalizedPath = NotesIndex::normalizePath(path);
 
   if (m_rootPath != normalizedPath) {
     m_rootPath = normalizedPath;
@@ -169,6 +268,10 @@ void NotesModel::setFilterString(const QString &filter) {
     emit filterStringChanged();
 
     if (!filter.isEmpty()) {
+      if (!m_query.isEmpty()) {
+        m_query.clear();
+        emit queryChanged();
+      }
       m_isSearchMode = true;
       emit isSearchModeChanged();
 
@@ -188,6 +291,10 @@ void NotesModel::setFilterTag(const QString &tag) {
     emit filterTagChanged();
 
     if (!tag.isEmpty()) {
+      if (!m_query.isEmpty()) {
+        m_query.clear();
+        emit queryChanged();
+      }
       m_isSearchMode = true;
       emit isSearchModeChanged();
       loadFromIndex();
@@ -197,6 +304,29 @@ void NotesModel::setFilterTag(const QString &tag) {
   }
 }
 
+QString NotesModel::query() const { return m_query; }
+
+void NotesModel::setQuery(const QString &query) {
+  if (m_query == query)
+    return;
+  m_query = query;
+  emit queryChanged();
+
+  if (query.trimmed().isEmpty()) {
+    clearFilters();
+    return;
+  }
+  if (!m_filterString.isEmpty() || !m_filterTag.isEmpty()) {
+    m_filterString.clear();
+    m_filterTag.clear();
+    emit filterStringChanged();
+    emit filterTagChanged();
+  }
+  m_isSearchMode = true;
+  emit isSearchModeChanged();
+  loadFromIndex();
+}
+
 bool NotesModel::isSearchMode() const { return m_isSearchMode; }
 
 void NotesModel::refresh() {
@@ -229,75 +359,65 @@ void NotesModel::navigateToRoot() {
 void NotesModel::clearFilters() {
   m_filterString.clear();
   m_filterTag.clear();
+  m_query.clear();
+  m_shownQuery.clear();
   m_isSearchMode = false;
   emit filterStringChanged();
   emit filterTagChanged();
+  emit queryChanged();
   emit isSearchModeChanged();
   loadFromIndex();
 }
 
 void NotesModel::togglePin(const QString &path) {
-  QString normalizedPath = path;
-  if (normalizedPath.startsWith(QLatin1String("file:///"))) {
-    normalizedPath = QUrl(normalizedPath).toLocalFile();
-  }
-  normalizedPath =
-      QDir::cleanPath(QFileInfo(normalizedPath).absoluteFilePath());
+  QString normalizedPath = NotesIndex::normalizePath(path);
 
   // Read the file
   QFile file(normalizedPath);
   if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
     return;
   }
-  QString content = QTextStream(&file).readAll();
+  QByteArray content = file.readAll();
   file.close();
 
-  // Toggle pinned status in frontmatter
-  bool currentlyPinned = false;
-
-  if (content.startsWith(QLatin1String("---"))) {
-    int endIdx = content.indexOf(QLatin1String("---"), 3);
-    if (endIdx > 0) {
-      QString frontmatter = content.mid(3, endIdx - 3);
-      QRegularExpression pinnedRegex(QStringLiteral("pinned:\\s*(true|false)"),
-                                     QRegularExpression::CaseInsensitiveOption);
-      QRegularExpressionMatch match = pinnedRegex.match(frontmatter);
-      if (match.hasMatch()) {
-        currentlyPinned = match.captured(1).toLower() == QLatin1String("true");
-        // Replace the value
-        QString newFrontmatter = frontmatter;
-        newFrontmatter.replace(
-            pinnedRegex, currentlyPinned ? QStringLiteral("pinned: false")
-                                         : QStringLiteral("pinned: true"));
-        content = QStringLiteral("---") + newFrontmatter + content.mid(endIdx);
-      } else {
-        // Add pinned: true before the closing ---
-        QString newFrontmatter = frontmatter + QStringLiteral("pinned: true\n");
-        content = QStringLiteral("---") + newFrontmatter + content.mid(endIdx);
-      }
-    }
-  } else {
-    // No frontmatter, add it
-    content = QStringLiteral("---\npinned: true\n---\n") + content;
-  }
+  // Toggle pinned status in frontmatter, creating the block if needed
+  bool currentlyPinned = Frontmatter::parse(content).boolean("pinned");
+  content = Frontmatter::setField(content, "pinned",
+                                  currentlyPinned ? "false" : "true");
 
   // Write back
   if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
     return;
   }
-  QTextStream out(&file);
-  out << content;
+  file.write(content);
   file.close();
 
   // Update the index
   NotesIndex::instance()->updateEntry(normalizedPath);
 }
 
-void NotesModel::onEntryUpdated(const QString &path) {
-  // meaningful optimization: check if path is in current view or relevant
-  // For now, simpler to just reload the view to reflect changes (tags, pin
-  // status) Logic is fast enough since it reads from memory index
-  loadFromIndex();
+void NotesModel::onEntriesChanged(const QStringList &paths) {
+  if (m_currentPath.isEmpty())
+    return;
+
+  // Title, tag and query filters may match anything; a content search
+  // keeps its results until it is run again
+  if (!m_filterTag.isEmpty() || !m_filterString.isEmpty() ||
+      !m_query.isEmpty()) {
+    loadFromIndex();
+    return;
+  }
+  if (m_isSearchMode)
+    return;
+
+  // Folder view: only direct children (or the folder itself) matter
+  for (const QString &path : paths) {
+    if (path == m_currentPath ||
+        path.left(path.lastIndexOf(QLatin1Char('/'))) == m_currentPath) {
+      loadFromIndex();
+      return;
+    }
+  }
 }
 
 QString NotesModel::findPathByTitle(const QString &title) {
@@ -314,54 +434,215 @@ void NotesModel::searchContent(const QString &query) {
     return;
   }
 
+  // Supersedes any running search and rows still being streamed in
+  cancelContentSearch();
+  m_loadGeneration++;
+  m_pendingItems.clear();
+  m_previewRequested.clear();
+  if (!m_query.isEmpty()) {
+    m_query.clear();
+    emit queryChanged();
+  }
+  m_shownQuery.clear();
+
+  // The trigram index narrows the vault down to notes that can match; only
+  // those are opened
+  QVector<NoteMetadata> candidates =
+      NotesIndex::instance()->contentCandidates(query);
+  sortByDisplayOrder(candidates);
+
+  m_isSearchMode = true;
   m_loading = true;
+  emit isSearchModeChanged();
   emit loadingChanged();
 
-  QString rootPath = m_rootPath;
-  QString lowerQuery = query.toLower();
-
-  m_contentSearchWatcher->setFuture(QtConcurrent::run([rootPath, lowerQuery]() {
-    QVector<NoteItem> results;
-    QDirIterator it(rootPath, {"*.md"}, QDir::Files,
-                    QDirIterator::Subdirectories);
-
-    while (it.hasNext()) {
-      QString filePath = it.next();
-      QFile file(filePath);
-
-      if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        // Stream line by line for memory efficiency
-        QTextStream in(&file);
-        bool found = false;
-
-        while (!in.atEnd() && !found) {
-          QString line = in.readLine();
-          if (line.toLower().contains(lowerQuery)) {
-            found = true;
-          }
-        }
-        file.close();
-
-        if (found) {
-          QFileInfo info(filePath);
-          NoteItem item;
-          item.type = QStringLiteral("note");
-          item.path = filePath;
-          item.title = info.completeBaseName();
-          item.date =
-              info.lastModified().toString(QStringLiteral("yyyy-MM-dd HH:mm"));
-          item.lastModified = info.lastModified();
-          item.color = QStringLiteral("#624a73");
-          item.isPinned = false;
-          results.append(item);
-        }
-      }
+  const QString foldedQuery = query.toCaseFolded();
+  streamMatches(
+      candidates,
+      [foldedQuery](const NoteMetadata &, const QString &,
+                    const QString &folded) {
+        return countOccurrences(folded, foldedQuery);
+      },
+      query, true);
+}
+
+void NotesModel::runQuery() {
+  const NoteQuery query = NoteQuery::parse(m_query, m_rootPath);
+  QVector<NoteMetadata> candidates =
+      NotesIndex::instance()->queryCandidates(query);
+  sortByDisplayOrder(candidates);
+
+  // A new query replaces the rows; re-running the one on screen (the vault
+  // changed) only touches the rows that differ
+  const bool fresh = m_query != m_shownQuery;
+  m_shownQuery = m_query;
+
+  if (!query.needsText()) {
+    // The index answered it exactly
+    QVector<NoteItem> items;
+    items.reserve(candidates.size());
+    for (const NoteMetadata &meta : std::as_const(candidates))
+      items.append(toNoteItem(meta));
+    if (fresh) {
+      beginResetModel();
+      m_items = std::move(items);
+      endResetModel();
+    } else {
+      applyItems(std::move(items));
     }
+    m_loading = false;
+    emit loadingChanged();
+    return;
+  }
+
+  const QStringList terms = query.textTerms();
+  streamMatches(
+      candidates,
+      [query, terms](const NoteMetadata &meta, const QString &,
+                     const QString &folded) {
+        if (!query.matches(meta, folded))
+          return 0;
+        int count = 0;
+        for (const QString &term : terms)
+          count += countOccurrences(folded, term);
+        return qMax(count, 1);
+      },
+      terms.value(0), fresh);
+}
+
+void NotesModel::streamMatches(const QVector<NoteMetadata> &candidates,
+                               const MatchCounter &matchCount,
+                               const QString &highlight, bool incremental) {
+  const int generation = m_loadGeneration;
+  auto cancelled = std::make_shared<std::atomic<bool>>(false);
+  m_searchCancel = cancelled;
+  m_searchIncremental = incremental;
+  m_searchHits.clear();
+
+  // Candidates come in display order, so hits can be appended as they come
+  if (incremental) {
+    beginResetModel();
+    m_items.clear();
+    endResetModel();
+  }
 
-    return results;
+  m_searchTimer.start();
+  m_searchFirstHitMs = -1;
+  const int cap = m_maxSearchResults;
+
+  m_searchFutures.removeIf(
+      [](const QFuture<void> &future) { return future.isFinished(); });
+  m_searchFutures.append(QtConcurrent::run([this, candidates, matchCount,
+                                            highlight, generation, cancelled,
+                                            cap]() {
+    QVector<NoteItem> batch;
+    QElapsedTimer sinceFlush;
+    sinceFlush.start();
+    int scanned = 0, hits = 0;
+
+    auto flush = [&]() {
+      if (batch.isEmpty())
+        return;
+      QMetaObject::invokeMethod(
+          this,
+          [this, generation, batch]() { appendSearchHits(generation, batch); },
+          Qt::QueuedConnection);
+      batch.clear();
+      sinceFlush.restart();
+    };
+
+    for (const NoteMetadata &meta : candidates) {
+      if (cancelled->load() || hits >= cap)
+        break;
+      scanned++;
+
+      QFile file(meta.filePath);
+      if (!file.open(QIODevice::ReadOnly))
+        continue;
+      const QString text = QString::fromUtf8(file.readAll());
+      file.close();
+
+      const int count = matchCount(meta, text, text.toCaseFolded());
+      if (count == 0)
+        continue;
+
+      NoteItem item = toNoteItem(meta);
+      item.matchCount = count;
+      if (!highlight.isEmpty())
+        item.snippet = searchSnippet(text, highlight);
+      batch.append(item);
+      hits++;
+
+      // The first hit goes out on its own, later ones in batches
+      if (hits == 1 || batch.size() >= kSearchBatch ||
+          sinceFlush.elapsed() >= kSearchFlushMs)
+        flush();
+    }
+    flush();
+
+    const int candidateCount = int(candidates.size());
+    QMetaObject::invokeMethod(
+        this,
+        [this, generation, scanned, hits, candidateCount]() {
+          finishContentSearch(generation, scanned, hits, candidateCount);
+        },
+        Qt::QueuedConnection);
   }));
 }
 
+void NotesModel::cancelContentSearch() {
+  if (m_searchCancel) {
+    *m_searchCancel = true;
+    m_searchCancel.reset();
+  }
+}
+
+void NotesModel::appendSearchHits(int generation,
+                                  const QVector<NoteItem> &hits) {
+  if (generation != m_loadGeneration || hits.isEmpty())
+    return;
+  if (m_searchFirstHitMs < 0)
+    m_searchFirstHitMs = m_searchTimer.elapsed();
+  if (!m_searchIncremental) {
+    m_searchHits += hits;
+    return;
+  }
+
+  int first = m_items.size();
+  beginInsertRows(QModelIndex(), first, first + hits.size() - 1);
+  m_items.append(hits);
+  endInsertRows();
+}
+
+void NotesModel::finishContentSearch(int generation, int scanned, int hits,
+                                     int candidates) {
+  if (generation != m_loadGeneration)
+    return;
+  m_searchCancel.reset();
+
+  if (!m_searchIncremental)
+    applyItems(std::move(m_searchHits));
+  m_searchHits.clear();
+
+  qDebug() << "NotesModel: text search" << hits << "hits in" << scanned
+           << "of" << candidates << "candidates - first after"
+           << m_searchFirstHitMs << "ms, done after" << m_searchTimer.elapsed()
+           << "ms";
+
+  m_loading = false;
+  emit loadingChanged();
+}
+
+int NotesModel::maxSearchResults() const { return m_maxSearchResults; }
+
+void NotesModel::setMaxSearchResults(int limit) {
+  limit = qMax(1, limit);
+  if (m_maxSearchResults != limit) {
+    m_maxSearchResults = limit;
+    emit maxSearchResultsChanged();
+  }
+}
+
 QStringList NotesModel::getAllTags() { return allTags(); }
 
 QStringList NotesModel::allTags() const {
@@ -377,6 +658,18 @@ void NotesModel::loadFromIndex() {
   m_loading = true;
   emit loadingChanged();
 
+  // Supersedes rows still being streamed in from a previous load or search
+  cancelContentSearch();
+  m_loadGeneration++;
+  m_pendingItems.clear();
+  // Reloaded rows ask again for the previews they still lack
+  m_previewRequested.clear();
+
+  if (!m_query.isEmpty()) {
+    runQuery(); // done loading once its text search, if any, finishes
+    return;
+  }
+
   NotesIndex *index = NotesIndex::instance();
 
   QVector<NoteMetadata> metaItems;
@@ -385,7 +678,7 @@ void NotesModel::loadFromIndex() {
     // Filter by tag
     metaItems = index->getNotesByTag(m_filterTag);
   } else if (!m_filterString.isEmpty()) {
-    // Search by title/tags
+    // Search by title/tags, ranked best first
     metaItems = index->searchByTitle(m_filterString);
   } else {
     // Normal folder view
@@ -393,33 +686,174 @@ void NotesModel::loadFromIndex() {
   }
 
   // Convert NoteMetadata to NoteItem
-  beginResetModel();
-  m_items.clear();
-
+  QVector<NoteItem> items;
+  items.reserve(metaItems.size());
   for (const NoteMetadata &meta : std::as_const(metaItems)) {
-    NoteItem item;
-    item.type =
-        meta.isFolder ? QStringLiteral("folder") : QStringLiteral("note");
-    item.title = meta.title;
-    item.path = meta.filePath;
-    item.date = meta.lastModified.toString(QStringLiteral("yyyy-MM-dd HH:mm"));
-    item.color = meta.color;
-    item.tags = meta.tags;
-    item.isPinned = meta.isPinned;
-    item.lastModified = meta.lastModified;
-    // Preview is lazy loaded in data()
-    m_items.append(item);
-  }
-
-  applySorting();
-  endResetModel();
+    items.append(toNoteItem(meta));
+  }
+
+  // Folder listings come from the index already in display order, title
+  // search results in rank order
+  if (!m_filterTag.isEmpty()) {
+    sortItems(items);
+  }
+
+  if (!m_filterString.isEmpty() && items.size() > kFirstSearchPage &&
+      !sharesRows(items)) {
+    // A new result set: show the best matches at once and stream the tail
+    // in behind them
+    m_pendingItems = items.mid(kFirstSearchPage);
+    items.resize(kFirstSearchPage);
+    int generation = m_loadGeneration;
+    QTimer::singleShot(0, this, [this, generation]() {
+      appendPendingItems(generation);
+    });
+    beginResetModel();
+    m_items = std::move(items);
+    endResetModel();
+  } else {
+    // Refreshes of what is on screen touch only the rows that changed
+    applyItems(std::move(items));
+  }
 
   m_loading = false;
   emit loadingChanged();
 }
 
-void NotesModel::applySorting() {
-  std::sort(m_items.begin(), m_items.end(),
+void NotesModel::appendPendingItems(int generation) {
+  if (generation != m_loadGeneration || m_pendingItems.isEmpty())
+    return;
+
+  int count = qMin<int>(kSearchChunk, m_pendingItems.size());
+  int first = m_items.size();
+  beginInsertRows(QModelIndex(), first, first + count - 1);
+  m_items.append(m_pendingItems.mid(0, count));
+  m_pendingItems.remove(0, count);
+  endInsertRows();
+
+  if (!m_pendingItems.isEmpty()) {
+    QTimer::singleShot(0, this, [this, generation]() {
+      appendPendingItems(generation);
+    });
+  }
+}
+
+bool NotesModel::sharesRows(const QVector<NoteItem> &items) const {
+  QSet<QString> paths;
+  paths.reserve(m_items.size());
+  for (const NoteItem &item : m_items)
+    paths.insert(item.path);
+  for (const NoteItem &item : items) {
+    if (paths.contains(item.path))
+      return true;
+  }
+  return false;
+}
+
+void NotesModel::applyItems(QVector<NoteItem> items) {
+  QHash<QString, int> target; // path -> row in items
+  target.reserve(items.size());
+  for (int row = 0; row < items.size(); ++row)
+    target.insert(items[row].path, row);
+
+  // Target rows of the current rows that stay, in current order
+  QVector<int> order;
+  order.reserve(m_items.size());
+  for (const NoteItem &item : std::as_const(m_items)) {
+    auto it = target.constFind(item.path);
+    if (it != target.constEnd())
+      order.append(it.value());
+  }
+  const QVector<bool> stable = increasingRun(order);
+  const int moves = int(stable.count(false));
+
+  // Another folder or result set, or a reshuffle that would move most rows:
+  // nothing worth preserving
+  if (order.isEmpty() || moves > order.size() / 2) {
+    beginResetModel();
+    m_items = std::move(items);
+    endResetModel();
+    return;
+  }
+
+  // 1. Drop rows that are gone, bottom up in contiguous ranges
+  for (int row = int(m_items.size()) - 1; row >= 0; --row) {
+    if (target.contains(m_items[row].path))
+      continue;
+    int last = row;
+    while (row > 0 && !target.contains(m_items[row - 1].path))
+      --row;
+    beginRemoveRows(QModelIndex(), row, last);
+    m_items.remove(row, last - row + 1);
+    endRemoveRows();
+  }
+
+  // 2. Rows on the longest run already in target order stay put; every
+  // other row moves directly behind its predecessor in target order.
+  // Handled in target order, each lands next to a row already placed.
+  QVector<int> survivors = order; // target rows, sorted below
+  QVector<bool> isNew(items.size(), true);
+  for (int t : std::as_const(order))
+    isNew[t] = false;
+  std::sort(survivors.begin(), survivors.end());
+  QSet<int> moving;
+  for (int k = 0; k < order.size(); ++k) {
+    if (!stable[k])
+      moving.insert(order[k]);
+  }
+  // Current row of each surviving target row and the reverse; after step 1
+  // m_items holds the survivors in the order they were listed
+  QVector<int> targetAt = order;
+  QVector<int> rowOfTarget(items.size(), -1);
+  for (int row = 0; row < targetAt.size(); ++row)
+    rowOfTarget[targetAt[row]] = row;
+  for (int s = 0; s < survivors.size(); ++s) {
+    if (!moving.contains(survivors[s]))
+      continue;
+    int from = rowOfTarget[survivors[s]];
+    int dest = s == 0 ? 0 : rowOfTarget[survivors[s - 1]] + 1;
+    if (from == dest || from + 1 == dest)
+      continue;
+    const int to = from < dest ? dest - 1 : dest;
+    beginMoveRows(QModelIndex(), from, from, QModelIndex(), dest);
+    m_items.move(from, to);
+    endMoveRows();
+    // Only the rows between the two ends shift
+    targetAt.move(from, to);
+    for (int row = qMin(from, to); row <= qMax(from, to); ++row)
+      rowOfTarget[targetAt[row]] = row;
+  }
+
+  // 3. Insert new rows in contiguous ranges and refresh changed roles
+  for (int row = 0; row < items.size();) {
+    if (!isNew[row]) {
+      NoteItem &current = m_items[row];
+      NoteItem &next = items[row];
+      // Keep a background-loaded preview while the note is unchanged
+      if (next.preview.isEmpty() && current.lastModified == next.lastModified)
+        next.preview = current.preview;
+      const QVector<int> roles = changedRoles(current, next);
+      current = std::move(next);
+      if (!roles.isEmpty())
+        emit dataChanged(index(row), index(row), roles);
+      ++row;
+      continue;
+    }
+
+    int end = row;
+    while (end < items.size() && isNew[end])
+      ++end;
+    beginInsertRows(QModelIndex(), row, end - 1);
+    m_items.insert(row, end - row, NoteItem());
+    for (int k = row; k < end; ++k)
+      m_items[k] = std::move(items[k]);
+    endInsertRows();
+    row = end;
+  }
+}
+
+void NotesModel::sortItems(QVector<NoteItem> &items) {
+  std::sort(items.begin(), items.end(),
             [](const NoteItem &a, const NoteItem &b) {
               // Pinned first
               if (a.isPinned != b.isPinned)
@@ -433,63 +867,78 @@ void NotesModel::applySorting() {
 }
 
 void NotesModel::onScanFinished() {
-  beginResetModel();
-  m_items = m_watcher->result();
-  applySorting();
-  endResetModel();
+  QVector<NoteItem> items = m_watcher->result();
+  sortItems(items);
+  applyItems(std::move(items));
 
   m_loading = false;
   emit loadingChanged();
 }
 
-void NotesModel::onDirectoryChanged(const QString &path) {
-  Q_UNUSED(path);
-  refresh();
-}
-
 void NotesModel::onIndexReady() {
-  // Reload from updated index
-  if (!m_currentPath.isEmpty()) {
+  // Reload from updated index; content search results stay until the
+  // search is run again
+  bool contentSearch = m_isSearchMode && m_filterTag.isEmpty() &&
+                       m_filterString.isEmpty() && m_query.isEmpty();
+  if (!m_currentPath.isEmpty() && !contentSearch) {
     loadFromIndex();
   }
 }
 
-void NotesModel::onContentSearchFinished() {
-  beginResetModel();
-  m_items = m_contentSearchWatcher->result();
-  m_isSearchMode = true;
-  applySorting();
-  endResetModel();
-
-  m_loading = false;
-  emit loadingChanged();
-  emit isSearchModeChanged();
-}
-
-QString NotesModel::createPreview(const QString &filePath, int maxLength) {
-  QFile file(filePath);
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    return QString();
+void NotesModel::requestPreview(const QString &path) {
+  if (m_previewRequested.contains(path))
+    return;
+  m_previewRequested.insert(path);
+  m_previewQueue.append(path);
+  if (!m_previewLoadScheduled) {
+    // One batch for every delegate created in this pass
+    m_previewLoadScheduled = true;
+    QTimer::singleShot(0, this, &NotesModel::loadPendingPreviews);
   }
+}
 
-  QTextStream in(&file);
-  QString content = in.readAll();
-  file.close();
-
-  QString result = content;
+void NotesModel::loadPendingPreviews() {
+  m_previewLoadScheduled = false;
+  const QStringList paths = std::move(m_previewQueue);
+  m_previewQueue.clear();
+  if (paths.isEmpty())
+    return;
 
-  // Remove frontmatter
-  if (result.startsWith(QLatin1String("---"))) {
-    int endIndex = result.indexOf(QLatin1String("---"), 3);
-    if (endIndex > 0) {
-      result = result.mid(endIndex + 3).trimmed();
+  auto *watcher = new QFutureWatcher<QHash<QString, QString>>(this);
+  connect(watcher, &QFutureWatcher<QHash<QString, QString>>::finished, this,
+          [this, watcher]() {
+            applyPreviews(watcher->result());
+            watcher->deleteLater();
+          });
+  watcher->setFuture(QtConcurrent::run([paths]() {
+    QHash<QString, QString> previews;
+    for (const QString &path : paths) {
+      QFile file(path);
+      if (!file.open(QIODevice::ReadOnly))
+        continue;
+      const QByteArray data = file.readAll();
+      file.close();
+      const QByteArray body = data.mid(Frontmatter::parse(data).bodyOffset());
+      previews.insert(path,
+                      NotesIndex::extractPreview(QString::fromUtf8(body)));
     }
-  }
+    return previews;
+  }));
+}
 
-  // Truncate to maxLength
-  if (result.length() > maxLength) {
-    result = result.left(maxLength) + QStringLiteral("...");
+void NotesModel::applyPreviews(const QHash<QString, QString> &previews) {
+  for (int row = 0; row < m_items.size(); ++row) {
+    auto it = previews.constFind(m_items[row].path);
+    if (it == previews.constEnd() || it.value().isEmpty() ||
+        m_items[row].preview == it.value())
+      continue;
+    m_items[row].preview = it.value();
+    emit dataChanged(index(row), index(row), {PreviewRole});
+  }
+  // Notes without any text stay marked, so their delegates don't keep
+  // asking until the rows reload
+  for (auto it = previews.constBegin(); it != previews.constEnd(); ++it) {
+    if (!it.value().isEmpty())
+      m_previewRequested.remove(it.key());
   }
-
-  return result;
 }
@@ -1,14 +1,19 @@
 #pragma once
 
+#include "NoteMetadata.h"
 #include <QAbstractListModel>
 #include <QDateTime>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFileInfo>
-#include <QFileSystemWatcher>
 #include <QFutureWatcher>
+#include <QSet>
 #include <QString>
 #include <QVector>
 #include <QtQml>
+#include <atomic>
+#include <functional>
+#include <memory>
 
 struct NoteItem {
   QString type;           // "folder" or "note"
@@ -16,10 +21,12 @@ struct NoteItem {
   QString path;           // Full file path
   QString date;           // Modified date string
   QString color;          // Color from frontmatter
-  QString preview;        // Content preview (lazy loaded)
+  QString preview;        // Content preview (from the index)
   QStringList tags;       // Tags from frontmatter
   bool isPinned;          // Pinned status
   QDateTime lastModified; // For sorting
+  QString snippet;        // Content search: context, match in <b>
+  int matchCount = 0;     // Content search: occurrences in the note
 };
 
 class NotesModel : public QAbstractListModel {
@@ -35,8 +42,11 @@ class NotesModel : public QAbstractListModel {
                  filterStringChanged)
   Q_PROPERTY(QString filterTag READ filterTag WRITE setFilterTag NOTIFY
                  filterTagChanged)
+  Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged)
   Q_PROPERTY(bool isSearchMode READ isSearchMode NOTIFY isSearchModeChanged)
   Q_PROPERTY(QStringList allTags READ allTags NOTIFY allTagsChanged)
+  Q_PROPERTY(int maxSearchResults READ maxSearchResults WRITE
+                 setMaxSearchResults NOTIFY maxSearchResultsChanged)
 
 public:
   enum NotesRoles {
@@ -47,7 +57,9 @@ public:
     ColorRole,
     PreviewRole,
     TagsRole,
-    IsPinnedRole
+    IsPinnedRole,
+    SnippetRole,
+    MatchCountRole
   };
 
   explicit NotesModel(QObject *parent = nullptr);
@@ -74,8 +86,16 @@ public:
   QString filterTag() const;
   void setFilterTag(const QString &tag);
 
+  // Structured search (see NoteQuery); replaces filterString and filterTag
+  QString query() const;
+  void setQuery(const QString &query);
+
   bool isSearchMode() const;
 
+  // Text searches stop once this many notes matched
+  int maxSearchResults() const;
+  void setMaxSearchResults(int limit);
+
   // Q_INVOKABLE methods for QML
   Q_INVOKABLE void refresh();
   Q_INVOKABLE void navigateToFolder(const QString &folderPath);
@@ -85,9 +105,19 @@ public:
   Q_INVOKABLE void togglePin(const QString &path);
   Q_INVOKABLE QString findPathByTitle(const QString &title);
   Q_INVOKABLE QStringList getBacklinks(const QString &title);
+  /**
+   * @brief Full-text search. Hits are appended as they are found, each with
+   * a snippet and match count; a new search or any other load cancels it.
+   */
   Q_INVOKABLE void searchContent(const QString &query);
   Q_INVOKABLE QStringList getAllTags();
   QStringList allTags() const;
+  /**
+   * @brief Loads the preview of a listed note the index has not parsed yet
+   * (see getItemsInFolder() during a scan) off the GUI thread; the row is
+   * updated through dataChanged. Delegates call it for empty previews.
+   */
+  Q_INVOKABLE void requestPreview(const QString &path);
 
 signals:
   void currentPathChanged();
@@ -96,22 +126,48 @@ signals:
   void folderStackChanged();
   void filterStringChanged();
   void filterTagChanged();
+  void queryChanged();
   void isSearchModeChanged();
   void allTagsChanged();
+  void maxSearchResultsChanged();
   void errorOccurred(const QString &message);
 
 private slots:
   void onScanFinished();
-  void onDirectoryChanged(const QString &path);
   void onIndexReady();
-  void onEntryUpdated(const QString &path);
-  void onContentSearchFinished();
+  void onEntriesChanged(const QStringList &paths);
 
 private:
   void startScan();
   void loadFromIndex();
-  void applySorting();
-  static QString createPreview(const QString &filePath, int maxLength = 100);
+  void appendPendingItems(int generation);
+  /**
+   * @brief Makes @p items the model's rows with the fewest row signals:
+   * removals, moves and insertions keyed by path, and dataChanged limited
+   * to the roles that differ. Unrelated lists are swapped with a reset.
+   */
+  void applyItems(QVector<NoteItem> items);
+  bool sharesRows(const QVector<NoteItem> &items) const;
+  static void sortItems(QVector<NoteItem> &items);
+
+  void runQuery();
+
+  // Reads @p candidates off the GUI thread in order and keeps those
+  // @p matchCount finds in the text; incremental hits are appended as they
+  // come, otherwise the rows are diffed in once the scan is done
+  using MatchCounter = std::function<int(
+      const NoteMetadata &meta, const QString &text, const QString &folded)>;
+  void streamMatches(const QVector<NoteMetadata> &candidates,
+                     const MatchCounter &matchCount, const QString &highlight,
+                     bool incremental);
+  void cancelContentSearch();
+  void appendSearchHits(int generation, const QVector<NoteItem> &hits);
+  void finishContentSearch(int generation, int scanned, int hits,
+                           int candidates);
+
+  // Previews the index could not supply, loaded off the GUI thread
+  void loadPendingPreviews();
+  void applyPreviews(const QHash<QString, QString> &previews);
 
   QString m_currentPath;
   QString m_rootPath;
@@ -119,11 +175,36 @@ private:
   QStringList m_folderStack;
   QVector<NoteItem> m_items;
 
+  // Title search shows the first page at once and streams the rest in
+  static constexpr int kFirstSearchPage = 50;
+  static constexpr int kSearchChunk = 100;
+  QVector<NoteItem> m_pendingItems;
+  int m_loadGeneration = 0;
+
   QString m_filterString;
   QString m_filterTag;
+  QString m_query;
+  QString m_shownQuery; // query the rows on screen came from
   bool m_isSearchMode = false;
 
+  // Paths queued or loading; forgotten once applied or the rows reload
+  QSet<QString> m_previewRequested;
+  QStringList m_previewQueue;
+  bool m_previewLoadScheduled = false;
+
   QFutureWatcher<QVector<NoteItem>> *m_watcher = nullptr;
-  QFutureWatcher<QVector<NoteItem>> *m_contentSearchWatcher = nullptr;
-  QFileSystemWatcher *m_fsWatcher = nullptr;
+
+  // Content search streams hits in batches; the flag is its cancellation
+  // token, checked before every file. Superseded workers may still be
+  // posting to this model, so every unfinished one is kept until it ends.
+  static constexpr int kDefaultMaxSearchResults = 200;
+  static constexpr int kSearchBatch = 20;
+  static constexpr int kSearchFlushMs = 50;
+  int m_maxSearchResults = kDefaultMaxSearchResults;
+  QVector<QFuture<void>> m_searchFutures;
+  std::shared_ptr<std::atomic<bool>> m_searchCancel;
+  bool m_searchIncremental = true;
+  QVector<NoteItem> m_searchHits; // held back until a non-incremental scan ends
+  QElapsedTimer m_searchTimer;
+  qint64 m_searchFirstHitMs = -1;
 };
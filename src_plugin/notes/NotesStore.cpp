@@ -0,0 +1,453 @@
+#include "NotesStore.h"
+#include "FuzzyMatcher.h"
+#include <QColor>
+#include <algorithm>
+
+NoteId NotesStore::allocate() {
+  if (!m_freeIds.isEmpty())
+    return m_freeIds.takeLast();
+
+  NoteId id = idLimit();
+  m_paths.append(QString());
+  m_titles.append(QString());
+  m_titleKeys.append(QString());
+  m_titleMasks.append(0);
+  m_colors.append(kDefaultColor);
+  m_previews.append(QString());
+  m_outlines.append(NoteOutline());
+  m_mtimes.append(0);
+  m_sizes.append(0);
+  m_flags.append(0);
+  m_tags.append(QVector<quint32>());
+  m_links.append(QVector<quint32>());
+  m_names.append(QVector<quint32>());
+  m_aliases.append(QStringList());
+  m_parentDirs.append(0);
+  return id;
+}
+
+void NotesStore::reserve(int count) {
+  m_paths.reserve(count);
+  m_titles.reserve(count);
+  m_titleKeys.reserve(count);
+  m_titleMasks.reserve(count);
+  m_colors.reserve(count);
+  m_previews.reserve(count);
+  m_outlines.reserve(count);
+  m_mtimes.reserve(count);
+  m_sizes.reserve(count);
+  m_flags.reserve(count);
+  m_tags.reserve(count);
+  m_links.reserve(count);
+  m_names.reserve(count);
+  m_aliases.reserve(count);
+  m_parentDirs.reserve(count);
+  m_idByPath.reserve(count);
+  m_idByTitle.reserve(count);
+}
+
+NoteId NotesStore::insert(const NoteMetadata &meta) {
+  NoteId id = find(meta.filePath);
+  if (id != kInvalid) {
+    unlink(id);
+  } else {
+    id = allocate();
+    m_paths[id] = meta.filePath;
+    m_idByPath.insert(m_paths[id], id);
+    m_parentDirs[id] = internDir(
+        meta.filePath.left(meta.filePath.lastIndexOf(QLatin1Char('/'))));
+    m_count++;
+  }
+
+  if (m_titles[id] != meta.title || m_titleKeys[id].isEmpty()) {
+    m_titleKeys[id] = searchKey(meta.title);
+    m_titleMasks[id] = FuzzyMatcher::charMask(m_titleKeys[id]);
+  }
+  m_titles[id] = meta.title;
+  m_colors[id] = packColor(meta.color);
+  m_previews[id] = meta.preview;
+  m_outlines[id] = meta.outline;
+  for (const NoteOutline::Anchor &anchor : meta.outline.anchors) {
+    if (anchor.level != 0)
+      continue;
+    QVector<NoteId> &notes = m_blockNotes[anchor.name];
+    if (!notes.contains(id)) // an ID may repeat within a note
+      notes.append(id);
+  }
+  m_mtimes[id] = meta.lastModified.toMSecsSinceEpoch();
+  m_sizes[id] = meta.fileSize;
+  m_flags[id] = Alive | (meta.isFolder ? Folder : 0) |
+                (meta.isPinned ? Pinned : 0) |
+                (meta.hasTasks ? HasTasks : 0);
+  m_idByTitle.insert(m_titles[id], id);
+
+  QVector<quint32> &tags = m_tags[id];
+  tags.reserve(meta.tags.size());
+  for (const QString &tag : meta.tags) {
+    quint32 tagId = internTag(tag);
+    quint32 key = m_tagKeyOf[tagId];
+    // Post once per note even if a tag repeats in another case
+    bool posted = false;
+    for (quint32 previous : std::as_const(tags))
+      posted |= m_tagKeyOf[previous] == key;
+    tags.append(tagId);
+    if (!posted)
+      m_tagPostings[key].append(id);
+  }
+  m_tagTree.addNote(id, meta.tags);
+
+  m_aliases[id] = meta.aliases;
+  if (!meta.isFolder) {
+    addName(id, meta.title);
+    for (const QString &alias : meta.aliases)
+      addName(id, alias);
+  }
+
+  QVector<quint32> targets;
+  targets.reserve(meta.links.size());
+  for (const QString &name : meta.links) {
+    if (!name.isEmpty())
+      targets.append(internLinkTarget(name));
+  }
+  setLinks(id, std::move(targets));
+
+  attach(id);
+  return id;
+}
+
+void NotesStore::unlink(NoteId id) {
+  // Uses the current sort key, so it must run before columns change
+  detach(id);
+
+  // Another note may have taken over the title
+  auto title = m_idByTitle.find(m_titles[id]);
+  if (title != m_idByTitle.end() && title.value() == id)
+    m_idByTitle.erase(title);
+
+  QStringList tagNames;
+  for (quint32 tagId : std::as_const(m_tags[id])) {
+    m_tagPostings[m_tagKeyOf[tagId]].removeAll(id);
+    tagNames.append(m_tagNames[tagId]);
+  }
+  m_tagTree.removeNote(id, tagNames);
+  m_tags[id].clear();
+
+  // Outgoing links are left alone; insert() diffs them against the new set
+  for (quint32 target : std::as_const(m_names[id])) {
+    if (m_linkNotes[target] == id)
+      m_linkNotes[target] = kInvalid;
+  }
+  m_names[id].clear();
+  m_aliases[id].clear();
+
+  const NoteOutline &outline = m_outlines[id];
+  for (const NoteOutline::Anchor &anchor : outline.anchors) {
+    if (anchor.level != 0)
+      continue;
+    auto notes = m_blockNotes.find(anchor.name);
+    if (notes != m_blockNotes.end()) {
+      notes.value().removeOne(id);
+      if (notes.value().isEmpty())
+        m_blockNotes.erase(notes);
+    }
+  }
+  m_outlines[id] = NoteOutline();
+}
+
+void NotesStore::setLinks(NoteId id, QVector<quint32> targets) {
+  std::sort(targets.begin(), targets.end());
+  targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+
+  // Both sets are sorted; walk them together and only touch the reverse
+  // lists of targets that were added or dropped
+  const QVector<quint32> &old = m_links[id];
+  auto o = old.cbegin(), n = targets.cbegin();
+  while (o != old.cend() || n != targets.cend()) {
+    if (n == targets.cend() || (o != old.cend() && *o < *n)) {
+      m_linkSources[*o++].removeOne(id);
+    } else if (o == old.cend() || *n < *o) {
+      m_linkSources[*n++].append(id);
+    } else {
+      ++o;
+      ++n;
+    }
+  }
+  m_links[id] = std::move(targets);
+}
+
+void NotesStore::addName(NoteId id, const QString &name) {
+  if (name.isEmpty())
+    return;
+  quint32 target = internLinkTarget(name);
+  if (m_names[id].contains(target))
+    return;
+  m_names[id].append(target);
+  m_linkNotes[target] = id;
+}
+
+bool NotesStore::remove(NoteId id) {
+  if (!isAlive(id))
+    return false;
+
+  unlink(id);
+  setLinks(id, {});
+  m_idByPath.remove(m_paths[id]);
+  m_paths[id].clear();
+  m_titles[id].clear();
+  m_titleKeys[id].clear();
+  m_previews[id].clear();
+  m_flags[id] = 0;
+  m_freeIds.append(id);
+  m_count--;
+  return true;
+}
+
+void NotesStore::clear() {
+  const quint64 generation = tagGeneration();
+  *this = NotesStore();
+  m_tagGenerationBase = generation + 1;
+}
+
+NoteMetadata NotesStore::metadata(NoteId id) const {
+  NoteMetadata meta;
+  if (!isAlive(id))
+    return meta;
+
+  meta.filePath = m_paths[id];
+  meta.title = m_titles[id];
+  meta.color = unpackColor(m_colors[id]);
+  meta.preview = m_previews[id];
+  meta.outline = m_outlines[id];
+  meta.lastModified = QDateTime::fromMSecsSinceEpoch(m_mtimes[id]);
+  meta.fileSize = m_sizes[id];
+  meta.isFolder = m_flags[id] & Folder;
+  meta.isPinned = m_flags[id] & Pinned;
+  meta.hasTasks = m_flags[id] & HasTasks;
+  meta.aliases = m_aliases[id];
+  meta.tags.reserve(m_tags[id].size());
+  for (quint32 tagId : m_tags[id])
+    meta.tags.append(m_tagNames[tagId]);
+  meta.links.reserve(m_links[id].size());
+  for (quint32 target : m_links[id])
+    meta.links.append(m_linkTargets[target]);
+  return meta;
+}
+
+QVector<NoteId> NotesStore::notesWithTag(const QString &tag) const {
+  auto key = m_tagKeyIds.constFind(tag.toLower());
+  if (key == m_tagKeyIds.constEnd())
+    return {};
+  return m_tagPostings[key.value()];
+}
+
+QVector<NoteId> NotesStore::notesUnderTag(const QString &tag) const {
+  quint32 node = m_tagTree.find(tag);
+  return node == TagTree::kNone ? QVector<NoteId>() : m_tagTree.notes(node);
+}
+
+int NotesStore::tagUseCount(const QString &tag) const {
+  quint32 node = m_tagTree.find(tag);
+  return node == TagTree::kNone ? 0 : m_tagTree.noteCount(node);
+}
+
+NoteId NotesStore::resolveLink(QStringView link) const {
+  auto target = m_linkTargetIds.constFind(linkTarget(link).toCaseFolded());
+  if (target == m_linkTargetIds.constEnd())
+    return kInvalid;
+  return m_linkNotes[target.value()];
+}
+
+QVector<NoteId> NotesStore::backlinks(NoteId id) const {
+  if (!isAlive(id) || m_names[id].isEmpty())
+    return {};
+  const QVector<quint32> &names = m_names[id];
+  if (names.size() == 1)
+    return m_linkSources[names.first()];
+
+  // A note may link to the same note under several names
+  QVector<NoteId> sources;
+  for (quint32 target : names)
+    sources += m_linkSources[target];
+  std::sort(sources.begin(), sources.end());
+  sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+  return sources;
+}
+
+QVector<NoteId> NotesStore::linkSources(const QString &target) const {
+  auto it = m_linkTargetIds.constFind(target.toCaseFolded());
+  if (it == m_linkTargetIds.constEnd())
+    return {};
+  return m_linkSources[it.value()];
+}
+
+QVector<NoteId> NotesStore::outgoingLinks(NoteId id) const {
+  QVector<NoteId> notes;
+  if (!isAlive(id))
+    return notes;
+  for (quint32 target : m_links[id]) {
+    NoteId note = m_linkNotes[target];
+    if (note != kInvalid && note != id && !notes.contains(note))
+      notes.append(note);
+  }
+  return notes;
+}
+
+quint32 NotesStore::internTag(const QString &tag) {
+  auto it = m_tagIds.constFind(tag);
+  if (it != m_tagIds.constEnd())
+    return it.value();
+
+  QString key = tag.toLower();
+  auto keyIt = m_tagKeyIds.constFind(key);
+  quint32 keyId;
+  if (keyIt != m_tagKeyIds.constEnd()) {
+    keyId = keyIt.value();
+  } else {
+    keyId = quint32(m_tagKeys.size());
+    m_tagKeys.append(key);
+    m_tagKeyIds.insert(key, keyId);
+    m_tagPostings.append(QVector<NoteId>());
+    m_tagSearchKeys.append(searchKey(tag));
+    m_tagSearchMasks.append(FuzzyMatcher::charMask(m_tagSearchKeys.last()));
+  }
+
+  quint32 tagId = quint32(m_tagNames.size());
+  m_tagNames.append(tag);
+  m_tagKeyOf.append(keyId);
+  m_tagIds.insert(tag, tagId);
+  return tagId;
+}
+
+quint32 NotesStore::internLinkTarget(const QString &name) {
+  QString key = name.toCaseFolded();
+  auto it = m_linkTargetIds.constFind(key);
+  if (it != m_linkTargetIds.constEnd())
+    return it.value();
+
+  quint32 target = quint32(m_linkTargets.size());
+  m_linkTargets.append(name);
+  m_linkTargetIds.insert(key, target);
+  m_linkSources.append(QVector<NoteId>());
+  m_linkNotes.append(kInvalid);
+  return target;
+}
+
+QVector<NoteId> NotesStore::children(const QString &dirPath) const {
+  auto dir = m_dirIds.constFind(dirPath);
+  if (dir == m_dirIds.constEnd())
+    return {};
+  return m_dirChildren[dir.value()];
+}
+
+quint32 NotesStore::internDir(const QString &dirPath) {
+  auto it = m_dirIds.constFind(dirPath);
+  if (it != m_dirIds.constEnd())
+    return it.value();
+
+  quint32 dir = quint32(m_dirChildren.size());
+  m_dirIds.insert(dirPath, dir);
+  m_dirChildren.append(QVector<NoteId>());
+  return dir;
+}
+
+bool NotesStore::listsBefore(NoteId a, NoteId b) const {
+  // Pinned first, then folders, then newest first; IDs break ties so the
+  // order is total and an entry can be found again by binary search
+  bool pinnedA = m_flags[a] & Pinned, pinnedB = m_flags[b] & Pinned;
+  if (pinnedA != pinnedB)
+    return pinnedA;
+  bool folderA = m_flags[a] & Folder, folderB = m_flags[b] & Folder;
+  if (folderA != folderB)
+    return folderA;
+  if (m_mtimes[a] != m_mtimes[b])
+    return m_mtimes[a] > m_mtimes[b];
+  return a < b;
+}
+
+void NotesStore::attach(NoteId id) {
+  QVector<NoteId> &siblings = m_dirChildren[m_parentDirs[id]];
+  if (m_bulkLoading) {
+    siblings.append(id);
+    return;
+  }
+  auto less = [this](NoteId a, NoteId b) { return listsBefore(a, b); };
+  siblings.insert(std::upper_bound(siblings.begin(), siblings.end(), id, less),
+                  id);
+}
+
+void NotesStore::detach(NoteId id) {
+  QVector<NoteId> &siblings = m_dirChildren[m_parentDirs[id]];
+  if (!m_bulkLoading) {
+    auto less = [this](NoteId a, NoteId b) { return listsBefore(a, b); };
+    auto pos = std::lower_bound(siblings.begin(), siblings.end(), id, less);
+    if (pos != siblings.end() && *pos == id) {
+      siblings.erase(pos);
+      return;
+    }
+  }
+  siblings.removeOne(id);
+}
+
+void NotesStore::endBulkLoad() {
+  m_bulkLoading = false;
+  auto less = [this](NoteId a, NoteId b) { return listsBefore(a, b); };
+  for (QVector<NoteId> &siblings : m_dirChildren)
+    std::sort(siblings.begin(), siblings.end(), less);
+}
+
+QString NotesStore::searchKey(const QString &text) {
+  bool ascii = true;
+  for (QChar c : text) {
+    if (c.unicode() >= 0x80) {
+      ascii = false;
+      break;
+    }
+  }
+  if (ascii)
+    return text.toCaseFolded();
+
+  // Decompose, then drop the combining marks the accents became
+  const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+  QString key;
+  key.reserve(decomposed.size());
+  for (QChar c : decomposed) {
+    if (c.category() != QChar::Mark_NonSpacing)
+      key.append(c);
+  }
+  return key.toCaseFolded();
+}
+
+QString NotesStore::linkTarget(QStringView link) {
+  // "[[Note|Shown text]]"; inside tables the pipe is escaped as "\|"
+  qsizetype cut = link.indexOf(u'|');
+  if (cut >= 0) {
+    link = link.left(cut);
+    if (link.endsWith(u'\\'))
+      link.chop(1);
+  }
+  // "#Heading" and "#^block" address a part of the note
+  cut = link.indexOf(u'#');
+  if (cut >= 0)
+    link = link.left(cut);
+  cut = link.lastIndexOf(u'/');
+  if (cut >= 0)
+    link = link.mid(cut + 1);
+  link = link.trimmed();
+  if (link.endsWith(QLatin1String(".md"), Qt::CaseInsensitive))
+    link.chop(3);
+  return link.trimmed().toString();
+}
+
+quint32 NotesStore::packColor(const QString &color) {
+  if (color.isEmpty())
+    return kDefaultColor;
+  QColor parsed(color);
+  return parsed.isValid() ? parsed.rgba() : kDefaultColor;
+}
+
+QString NotesStore::unpackColor(quint32 argb) {
+  if (argb == kDefaultColor)
+    return QStringLiteral("#624a73");
+  QColor color = QColor::fromRgba(argb);
+  return color.alpha() == 255 ? color.name() : color.name(QColor::HexArgb);
+}
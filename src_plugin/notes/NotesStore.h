@@ -0,0 +1,223 @@
+#pragma once
+
+#include "NoteMetadata.h"
+#include "TagTree.h"
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Compact, ID-based storage behind NotesIndex.
+ *
+ * Every note and folder gets a dense integer ID and its attributes live in
+ * parallel columns indexed by that ID (structure of arrays): a pass over all
+ * titles or modification times walks one contiguous array instead of
+ * hopping between heap-allocated records. Paths and titles are stored once
+ * and shared with the lookup hashes; tags and link targets are interned, and
+ * the tag and backlink indexes are plain ID vectors. NoteMetadata is only
+ * materialized for results handed out of the index.
+ *
+ * Links form a graph over interned link targets (case-folded note names).
+ * Each note keeps its sorted outgoing targets (forward adjacency) and each
+ * target the notes linking to it (reverse adjacency); a note's title and
+ * aliases are targets too, so resolving a link or collecting a note's
+ * backlinks never looks at strings of other notes. Reinserting a note only
+ * touches the targets that entered or left its link set.
+ *
+ * The store also holds the folder tree: each directory keeps its children
+ * in listing order (pinned, then folders, then newest first), maintained by
+ * binary insertion as entries change, so a folder listing is a slice.
+ *
+ * Each note's outline (heading and ^block-id byte ranges) is stored with
+ * it, and block IDs are mapped to the notes defining them vault-wide.
+ *
+ * Tags are also kept in a TagTree, so nested tags ("project/alpha") can be
+ * listed as a tree with note counts and queried by prefix.
+ *
+ * Removed IDs are recycled, so an ID is only meaningful while its entry
+ * exists. Interned tag and link strings are never released; vaults have few
+ * of them compared to notes.
+ */
+class NotesStore {
+public:
+  static constexpr NoteId kInvalid = ~NoteId(0);
+  static constexpr quint32 kDefaultColor = 0xFF624A73; // #624a73
+
+  /**
+   * @brief Adds @p meta, replacing the entry with the same path if any.
+   * @return The entry's ID.
+   */
+  NoteId insert(const NoteMetadata &meta);
+  bool remove(NoteId id);
+  void clear();
+  void reserve(int count);
+
+  /**
+   * @brief Between these calls insert() appends children unsorted; the
+   * child lists are sorted once at the end. Used for full rebuilds.
+   */
+  void beginBulkLoad() { m_bulkLoading = true; }
+  void endBulkLoad();
+
+  int size() const { return m_count; }
+  // Upper bound (exclusive) for iterating IDs; check isAlive() on each
+  NoteId idLimit() const { return NoteId(m_flags.size()); }
+  bool isAlive(NoteId id) const {
+    return id < idLimit() && (m_flags[id] & Alive);
+  }
+
+  NoteId find(const QString &path) const {
+    return m_idByPath.value(path, kInvalid);
+  }
+  NoteId findByTitle(const QString &title) const {
+    return m_idByTitle.value(title, kInvalid);
+  }
+  /**
+   * @brief Note a [[link]] points at, matched case-insensitively against
+   * titles and aliases. Headings, block refs, aliases and folders in
+   * @p link are ignored (see linkTarget()).
+   */
+  NoteId resolveLink(QStringView link) const;
+
+  const QString &path(NoteId id) const { return m_paths[id]; }
+  const QString &title(NoteId id) const { return m_titles[id]; }
+  qint64 mtimeMs(NoteId id) const { return m_mtimes[id]; }
+  qint64 fileSize(NoteId id) const { return m_sizes[id]; }
+  bool isFolder(NoteId id) const { return m_flags[id] & Folder; }
+  bool isPinned(NoteId id) const { return m_flags[id] & Pinned; }
+  bool hasTasks(NoteId id) const { return m_flags[id] & HasTasks; }
+  const QVector<quint32> &tagIds(NoteId id) const { return m_tags[id]; }
+  const QString &tagName(quint32 tagId) const { return m_tagNames[tagId]; }
+  const QStringList &aliases(NoteId id) const { return m_aliases[id]; }
+  const QString &preview(NoteId id) const { return m_previews[id]; }
+  const NoteOutline &outline(NoteId id) const { return m_outlines[id]; }
+
+  // Search keys (see searchKey()) and their FuzzyMatcher character masks
+  const QString &titleKey(NoteId id) const { return m_titleKeys[id]; }
+  quint64 titleMask(NoteId id) const { return m_titleMasks[id]; }
+  int tagKeyCount() const { return m_tagKeys.size(); }
+  quint32 tagKeyOf(quint32 tagId) const { return m_tagKeyOf[tagId]; }
+  const QString &tagSearchKey(quint32 key) const {
+    return m_tagSearchKeys[key];
+  }
+  quint64 tagSearchMask(quint32 key) const { return m_tagSearchMasks[key]; }
+
+  NoteMetadata metadata(NoteId id) const;
+
+  /** @brief Notes carrying @p tag, compared case-insensitively. */
+  QVector<NoteId> notesWithTag(const QString &tag) const;
+  /**
+   * @brief Notes carrying @p tag or a tag nested below it ("project" covers
+   * "project/alpha"), sorted by ID.
+   */
+  QVector<NoteId> notesUnderTag(const QString &tag) const;
+  /** @brief Size of notesUnderTag() without copying it. */
+  int tagUseCount(const QString &tag) const;
+  /** @brief Notes linking to @p id under its title or any alias. */
+  QVector<NoteId> backlinks(NoteId id) const;
+  /** @brief Notes containing a [[link]] to @p target, existing or not. */
+  QVector<NoteId> linkSources(const QString &target) const;
+  /** @brief Existing notes @p id links to. */
+  QVector<NoteId> outgoingLinks(NoteId id) const;
+  /** @brief Notes defining the block ^@p blockId, usually just one. */
+  QVector<NoteId> notesWithBlock(const QString &blockId) const {
+    return m_blockNotes.value(blockId);
+  }
+  /** @brief Nested tags with per-node note counts. */
+  const TagTree &tagTree() const { return m_tagTree; }
+  /** @brief Changes whenever a tag (or tag prefix) appears or disappears. */
+  quint64 tagGeneration() const {
+    return m_tagGenerationBase + m_tagTree.generation();
+  }
+
+  /** @brief Direct children of @p dirPath in listing order. */
+  QVector<NoteId> children(const QString &dirPath) const;
+  bool hasDirectory(const QString &dirPath) const {
+    return m_dirIds.contains(dirPath);
+  }
+
+  /**
+   * @brief Case-folded form of @p text with diacritics stripped ("Café"
+   * and "cafe" share a key), as used by title and tag search.
+   */
+  static QString searchKey(const QString &text);
+
+  /**
+   * @brief Note name a raw link refers to: "folder/Note#Heading|Alias",
+   * "Note#^block" and "Note.md" all yield "Note". Empty for links into the
+   * current note ("#Heading").
+   */
+  static QString linkTarget(QStringView link);
+
+  static quint32 packColor(const QString &color);
+  static QString unpackColor(quint32 argb);
+
+private:
+  enum Flag : quint8 {
+    Alive = 1 << 0,
+    Folder = 1 << 1,
+    Pinned = 1 << 2,
+    HasTasks = 1 << 3
+  };
+
+  NoteId allocate();
+  void unlink(NoteId id);
+  quint32 internTag(const QString &tag);
+  quint32 internLinkTarget(const QString &name);
+  void setLinks(NoteId id, QVector<quint32> targets);
+  void addName(NoteId id, const QString &name);
+  quint32 internDir(const QString &dirPath);
+  bool listsBefore(NoteId a, NoteId b) const;
+  void attach(NoteId id);
+  void detach(NoteId id);
+
+  // Columns, indexed by NoteId
+  QVector<QString> m_paths;
+  QVector<QString> m_titles;
+  QVector<QString> m_titleKeys;
+  QVector<quint64> m_titleMasks;
+  QVector<quint32> m_colors; // ARGB
+  QVector<QString> m_previews;
+  QVector<NoteOutline> m_outlines;
+  QVector<qint64> m_mtimes;  // ms since epoch
+  QVector<qint64> m_sizes;
+  QVector<quint8> m_flags;
+  QVector<QVector<quint32>> m_tags;  // tag IDs
+  QVector<QVector<quint32>> m_links; // sorted link target IDs
+  QVector<QVector<quint32>> m_names; // targets naming the note
+  QVector<QStringList> m_aliases;
+  QVector<quint32> m_parentDirs;     // directory IDs
+
+  QHash<QString, NoteId> m_idByPath;
+  QHash<QString, NoteId> m_idByTitle; // last inserted note wins
+  QVector<NoteId> m_freeIds;
+  int m_count = 0;
+
+  // Tags as written, each mapped to a case-insensitive key with postings
+  QVector<QString> m_tagNames;
+  QVector<quint32> m_tagKeyOf;
+  QHash<QString, quint32> m_tagIds;
+  QVector<QString> m_tagKeys;
+  QHash<QString, quint32> m_tagKeyIds;
+  QVector<QVector<NoteId>> m_tagPostings; // tag key -> notes
+  QVector<QString> m_tagSearchKeys;
+  QVector<quint64> m_tagSearchMasks;
+  TagTree m_tagTree;
+  quint64 m_tagGenerationBase = 0; // keeps generations rising across clear()
+
+  // Link targets by case-folded name, the notes linking to them and the
+  // note they resolve to (last inserted note wins, like titles)
+  QVector<QString> m_linkTargets; // as first written
+  QHash<QString, quint32> m_linkTargetIds;
+  QVector<QVector<NoteId>> m_linkSources; // target -> notes
+  QVector<NoteId> m_linkNotes;            // target -> note or kInvalid
+
+  // Block IDs (case-sensitive, like the ^markers) -> notes defining them
+  QHash<QString, QVector<NoteId>> m_blockNotes;
+
+  // Folder tree: directories by path, each with its sorted children
+  QHash<QString, quint32> m_dirIds;
+  QVector<QVector<NoteId>> m_dirChildren;
+  bool m_bulkLoading = false;
+};
@@ -0,0 +1,392 @@
+#include "ParsedNoteCache.h"
+#include "Frontmatter.h"
+#include "MarkdownParser.h"
+#include "NotesIndex.h"
+#include <QDebug>
+#include <QFile>
+#include <QRegularExpression>
+#include <QThread>
+
+ParsedNoteCache *ParsedNoteCache::s_instance = nullptr;
+
+QString ParsedNote::body() const {
+  // The same text readNote() hands to the editor
+  QString text = bodyOffset > 0
+                     ? QString::fromUtf8(data.mid(bodyOffset)).trimmed()
+                     : QString::fromUtf8(data);
+  text.remove(QLatin1Char('\r'));
+  return text;
+}
+
+qint64 ParsedNote::cost() const {
+  qint64 bytes = qint64(sizeof(ParsedNote)) + data.size();
+  for (const NoteBlock &block : blocks) {
+    bytes += qint64(sizeof(NoteBlock)) + block.content.size() * 2 +
+             block.language.size() * 2 + block.metadata.size() * 64;
+  }
+  for (const NoteOutline::Anchor &anchor : outline.anchors)
+    bytes += qint64(sizeof(anchor)) + anchor.name.size() * 2;
+  for (const Embed &embed : embeds)
+    bytes += qint64(sizeof(embed)) + embed.link.size() * 2;
+  return bytes;
+}
+
+ParsedNoteCache *ParsedNoteCache::instance() {
+  if (!s_instance) {
+    s_instance = new ParsedNoteCache();
+  }
+  return s_instance;
+}
+
+ParsedNoteCache *ParsedNoteCache::create(QQmlEngine *qmlEngine,
+                                         QJSEngine *jsEngine) {
+  Q_UNUSED(qmlEngine);
+  Q_UNUSED(jsEngine);
+  return instance();
+}
+
+ParsedNoteCache::ParsedNoteCache(QObject *parent) : QObject(parent) {
+  m_cache.setMaxCost(kDefaultBudget);
+  m_pool.setMaxThreadCount(2);
+  m_pool.setObjectName(QStringLiteral("ParsedNoteCache"));
+  m_prefetchPool.setMaxThreadCount(1);
+  m_prefetchPool.setThreadPriority(QThread::LowPriority);
+  m_prefetchPool.setObjectName(QStringLiteral("ParsedNoteCache prefetch"));
+}
+
+ParsedNoteCache::Entry ParsedNoteCache::cached(const QString &path,
+                                               const QFileInfo &info) {
+  QMutexLocker locker(&m_mutex);
+  Slot *slot = m_cache.object(path);
+  if (!slot)
+    return nullptr;
+  const ParsedNote &note = *slot->note;
+  if (!info.exists() || note.size != info.size() ||
+      note.mtimeMs != info.lastModified().toMSecsSinceEpoch()) {
+    m_cache.remove(path); // changed on disk since it was parsed
+    return nullptr;
+  }
+  return slot->note;
+}
+
+ParsedNoteCache::Entry ParsedNoteCache::read(const QString &path,
+                                             const QFileInfo &info) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly))
+    return nullptr;
+
+  auto note = std::make_shared<ParsedNote>();
+  note->path = path;
+  // Stat taken before reading: a write racing the read makes the entry
+  // stale rather than wrongly current
+  note->size = info.size();
+  note->mtimeMs = info.lastModified().toMSecsSinceEpoch();
+  note->data = file.readAll();
+  file.close();
+
+  const Frontmatter fm = Frontmatter::parse(note->data);
+  note->bodyOffset = fm.bodyOffset();
+  note->color = fm.value("color", QStringLiteral("#624a73"));
+  note->blocks = MarkdownParser::parse(note->body());
+  note->outline = NoteOutline::parse(note->data, note->bodyOffset);
+  note->embeds = scanEmbeds(note->data, note->bodyOffset);
+
+  const qint64 cost = note->cost();
+  {
+    // Evicts least recently used entries beyond the budget; a note larger
+    // than the whole budget is handed out but not kept
+    QMutexLocker locker(&m_mutex);
+    m_cache.insert(path, new Slot{note}, cost);
+  }
+  return note;
+}
+
+ParsedNoteCache::Entry ParsedNoteCache::lookup(const QString &path) {
+  const QFileInfo info(path);
+  Entry note = cached(path, info);
+  if (note)
+    countHit(path);
+  else
+    m_misses++;
+  return note;
+}
+
+ParsedNoteCache::Entry ParsedNoteCache::load(const QString &path) {
+  const QFileInfo info(path);
+  if (Entry note = cached(path, info)) {
+    countHit(path);
+    return note;
+  }
+  m_misses++;
+  return parse(path);
+}
+
+ParsedNoteCache::Entry ParsedNoteCache::parse(const QString &path) {
+  {
+    QMutexLocker locker(&m_foregroundMutex);
+    m_foreground++;
+  }
+  Entry note = read(path, QFileInfo(path));
+  {
+    // Read ahead for nothing if it had to be read again
+    QMutexLocker locker(&m_mutex);
+    m_prefetched.remove(path);
+  }
+  {
+    QMutexLocker locker(&m_foregroundMutex);
+    if (--m_foreground == 0)
+      m_foregroundIdle.wakeAll();
+  }
+  return note;
+}
+
+void ParsedNoteCache::countHit(const QString &path) {
+  m_hits++;
+  QMutexLocker locker(&m_mutex);
+  if (m_prefetched.remove(path))
+    m_prefetchHits++;
+}
+
+void ParsedNoteCache::waitForForeground() {
+  QMutexLocker locker(&m_foregroundMutex);
+  while (m_foreground > 0)
+    m_foregroundIdle.wait(&m_foregroundMutex);
+}
+
+void ParsedNoteCache::prefetchLinks(const QString &path) {
+  const int generation = ++m_prefetchGeneration;
+  const QStringList paths = NotesIndex::instance()->linkedNotesToPrefetch(
+      NotesIndex::normalizePath(path), kPrefetchCount, kPrefetchBytes);
+  if (paths.isEmpty())
+    return;
+
+  m_prefetchPool.start([this, paths, generation]() {
+    int done = 0;
+    for (const QString &linked : paths) {
+      waitForForeground();
+      if (m_prefetchGeneration != generation)
+        return; // another note was opened; its links matter now
+      const QFileInfo info(linked);
+      if (cached(linked, info) || !read(linked, info))
+        continue;
+      done++;
+      m_prefetchReads++;
+      QMutexLocker locker(&m_mutex);
+      m_prefetched.insert(linked);
+    }
+    const qint64 reads = m_prefetchReads;
+    qDebug() << "ParsedNoteCache: read ahead" << done << "of" << paths.size()
+             << "linked notes;" << m_prefetchHits.load() << "of" << reads
+             << "read-ahead notes used so far";
+  });
+}
+
+void ParsedNoteCache::clear() {
+  QMutexLocker locker(&m_mutex);
+  m_cache.clear();
+}
+
+void ParsedNoteCache::setBudget(qint64 bytes) {
+  QMutexLocker locker(&m_mutex);
+  m_cache.setMaxCost(bytes);
+}
+
+qint64 ParsedNoteCache::budget() const {
+  QMutexLocker locker(&m_mutex);
+  return m_cache.maxCost();
+}
+
+QVariantMap ParsedNoteCache::stats() const {
+  const qint64 hits = m_hits;
+  const qint64 misses = m_misses;
+  QVariantMap stats;
+  stats[QStringLiteral("hits")] = hits;
+  stats[QStringLiteral("misses")] = misses;
+  stats[QStringLiteral("hitRate")] =
+      hits + misses > 0 ? double(hits) / double(hits + misses) : 0.0;
+  const qint64 prefetched = m_prefetchReads;
+  const qint64 prefetchHits = m_prefetchHits;
+  stats[QStringLiteral("prefetched")] = prefetched;
+  stats[QStringLiteral("prefetchHits")] = prefetchHits;
+  stats[QStringLiteral("prefetchHitRate")] =
+      prefetched > 0 ? double(prefetchHits) / double(prefetched) : 0.0;
+
+  QMutexLocker locker(&m_mutex);
+  stats[QStringLiteral("entries")] = qint64(m_cache.count());
+  stats[QStringLiteral("bytes")] = qint64(m_cache.totalCost());
+  stats[QStringLiteral("budget")] = qint64(m_cache.maxCost());
+  return stats;
+}
+
+int ParsedNoteCache::requestEmbed(const QString &notePath,
+                                  const QString &link) {
+  EmbedJob job;
+  job.id = ++m_nextRequest;
+  job.notePath = NotesIndex::normalizePath(notePath);
+  job.link = link;
+  // Answered from the event loop, so the caller has stored the ID by then
+  QMetaObject::invokeMethod(
+      this, [this, job]() { resolveEmbed(job); }, Qt::QueuedConnection);
+  return job.id;
+}
+
+void ParsedNoteCache::resolveEmbed(EmbedJob job) {
+  // The embedding note counts as a whole, so embedding it into itself is
+  // caught like any other cycle
+  QStringList stack{job.notePath + QLatin1Char('#')};
+  QString missing, error;
+  const QString text =
+      expandEmbed(job.notePath, job.link, stack, job, &missing, &error);
+
+  if (!missing.isEmpty()) {
+    // Started over once the note is read; notes met so far are cached
+    const bool reading = m_waiting.contains(missing);
+    m_waiting[missing].append(job);
+    if (!reading)
+      readInBackground(missing);
+    return;
+  }
+  emit embedResolved(job.id, error.isEmpty() ? text : QString(), error);
+}
+
+void ParsedNoteCache::readInBackground(const QString &path) {
+  m_pool.start([this, path]() {
+    Entry note = parse(path);
+    QMetaObject::invokeMethod(
+        this, [this, path, note]() { onRead(path, note); },
+        Qt::QueuedConnection);
+  });
+}
+
+void ParsedNoteCache::onRead(const QString &path, const Entry &note) {
+  const QVector<EmbedJob> jobs = m_waiting.take(path);
+  for (EmbedJob job : jobs) {
+    // Kept with the job in case the budget evicts it before the retry
+    job.notes.insert(path, note);
+    resolveEmbed(job);
+  }
+}
+
+QString ParsedNoteCache::expandEmbed(const QString &notePath,
+                                     const QString &link, QStringList &stack,
+                                     const EmbedJob &job, QString *missing,
+                                     QString *error) {
+  // "Note#Section|Alias": the note, then the section or ^block
+  const QString target = link.section(QLatin1Char('|'), 0, 0).trimmed();
+  const qsizetype hash = target.indexOf(QLatin1Char('#'));
+  const QString noteName = hash < 0 ? target : target.left(hash).trimmed();
+  const QString anchor = hash < 0 ? QString() : target.mid(hash + 1).trimmed();
+  const bool isBlock = anchor.startsWith(QLatin1Char('^'));
+
+  NotesIndex *index = NotesIndex::instance();
+  QString path = noteName.isEmpty() ? notePath
+                                    : index->findPathByTitle(noteName);
+  if (path.isEmpty() && isBlock)
+    path = index->findPathByBlock(anchor.mid(1));
+  if (path.isEmpty()) {
+    // Not indexed (yet): a note of that name next to the embedding one
+    const QString local = notePath.left(notePath.lastIndexOf(u'/') + 1) +
+                          noteName + QStringLiteral(".md");
+    if (QFileInfo::exists(local))
+      path = local;
+  }
+  if (path.isEmpty()) {
+    *error = QStringLiteral("Note not found: ") + noteName;
+    return QString();
+  }
+
+  const QString key = path + QLatin1Char('#') + anchor;
+  if (stack.contains(key) || stack.size() > kMaxEmbedDepth) {
+    *error = QStringLiteral("Recursive embed: ") + link;
+    return QString();
+  }
+
+  Entry note;
+  auto known = job.notes.constFind(path);
+  if (known != job.notes.constEnd()) {
+    note = known.value();
+    if (!note) {
+      *error = QStringLiteral("Note not found: ") + noteName;
+      return QString();
+    }
+  } else if (!(note = lookup(path))) {
+    *missing = path;
+    return QString();
+  }
+
+  qsizetype begin = note->bodyOffset;
+  qsizetype end = note->data.size();
+  if (!anchor.isEmpty()) {
+    const NoteOutline::Anchor *found =
+        isBlock ? note->outline.block(QStringView(anchor).mid(1))
+                : note->outline.heading(anchor);
+    if (!found) {
+      *error = QStringLiteral("Content not found");
+      return QString();
+    }
+    begin = found->begin;
+    end = found->end;
+  }
+
+  // Note embeds inside the range are replaced by their own text; the ones
+  // that fail (cycles included) stay as written
+  stack.append(key);
+  QByteArray out;
+  qsizetype pos = begin;
+  for (const ParsedNote::Embed &embed : note->embeds) {
+    if (qsizetype(embed.offset) < begin || qsizetype(embed.offset) >= end)
+      continue;
+    QString nestedError;
+    const QString nested =
+        expandEmbed(path, embed.link, stack, job, missing, &nestedError);
+    if (!missing->isEmpty()) {
+      stack.removeLast();
+      return QString();
+    }
+    if (!nestedError.isEmpty() || nested.isEmpty())
+      continue;
+
+    qsizetype lineEnd = note->data.indexOf('\n', embed.offset);
+    if (lineEnd < 0 || lineEnd > end)
+      lineEnd = end;
+    out += note->data.mid(pos, embed.offset - pos);
+    out += nested.toUtf8();
+    pos = lineEnd;
+  }
+  out += note->data.mid(pos, end - pos);
+  stack.removeLast();
+
+  QString text = QString::fromUtf8(out);
+  text.remove(QLatin1Char('\r'));
+  return text.trimmed();
+}
+
+QVector<ParsedNote::Embed>
+ParsedNoteCache::scanEmbeds(const QByteArray &data, qsizetype bodyOffset) {
+  // Standalone "![[...]]" lines, as MarkdownParser makes Embed blocks of;
+  // images are attachments, not transclusions
+  static const QRegularExpression imageExt(
+      QStringLiteral(R"(\.(png|jpg|jpeg|gif|bmp|svg|webp|ico|tiff?)$)"),
+      QRegularExpression::CaseInsensitiveOption);
+
+  QVector<ParsedNote::Embed> embeds;
+  bool inFence = false;
+  qsizetype pos = bodyOffset;
+  while (pos < data.size()) {
+    qsizetype eol = data.indexOf('\n', pos);
+    if (eol < 0)
+      eol = data.size();
+    const QByteArrayView line =
+        QByteArrayView(data).sliced(pos, eol - pos).trimmed();
+    if (line.startsWith("```") || line.startsWith("~~~")) {
+      inFence = !inFence;
+    } else if (!inFence && line.size() > 5 && line.startsWith("![[") &&
+               line.endsWith("]]")) {
+      const QString link = QString::fromUtf8(line.sliced(3, line.size() - 5));
+      if (!link.contains(QLatin1String("]]")) && !link.contains(imageExt))
+        embeds.append({link, quint32(pos)});
+    }
+    pos = eol + 1;
+  }
+  return embeds;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "NoteBlock.h"
+#include "NoteOutline.h"
+#include <QByteArray>
+#include <QCache>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QVariantMap>
+#include <QVector>
+#include <QWaitCondition>
+#include <QtQml>
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief A note read and parsed once: its bytes, blocks and outline.
+ * Never modified after it is built, so threads share it freely.
+ */
+struct ParsedNote {
+  struct Embed {
+    QString link;       // "Note#Section", as written inside ![[...]]
+    quint32 offset = 0; // start of the embed's line
+  };
+
+  QString path;
+  qint64 size = 0;
+  qint64 mtimeMs = 0;
+  QByteArray data;          // the whole file
+  qsizetype bodyOffset = 0; // past the frontmatter
+  QString color;
+  QVector<NoteBlock> blocks; // MarkdownParser::parse() of body(): spans
+                             // are offsets into its UTF-8
+  NoteOutline outline;
+  QVector<Embed> embeds; // note embeds (not images): transclusion edges
+
+  /** @brief The body as NotesFileHandler::readNote() returns it. */
+  QString body() const;
+  /** @brief Approximate memory held, in bytes. */
+  qint64 cost() const;
+};
+
+/**
+ * @brief Process-wide LRU cache of parsed notes, keyed by path and checked
+ * against the file's size and modification time on every lookup.
+ *
+ * The editor's NoteBlockModel and embeds share it, so opening a note that
+ * was shown recently, or one embedded several times, reads and parses the
+ * file once. Entries are evicted least recently used first once their
+ * cost() exceeds the budget.
+ *
+ * Embeds are resolved in the background: the target notes are loaded on a
+ * small pool, the embedded section or block is cut from the cached bytes
+ * and note embeds inside it are expanded in turn. The chain of embeds
+ * being expanded is tracked, so a transclusion leading back to a note and
+ * section already on it is left as written instead of recursing.
+ *
+ * Opening a note reads the notes it links to ahead of time (see
+ * prefetchLinks()), so following a link usually finds its note parsed.
+ *
+ * lookup(), load() and parse() are thread-safe; requestEmbed() is for the GUI
+ * thread, which owns NotesIndex.
+ */
+class ParsedNoteCache : public QObject {
+  Q_OBJECT
+  QML_ELEMENT
+  QML_SINGLETON
+
+public:
+  using Entry = std::shared_ptr<const ParsedNote>;
+
+  static ParsedNoteCache *instance();
+  static ParsedNoteCache *create(QQmlEngine *qmlEngine, QJSEngine *jsEngine);
+
+  explicit ParsedNoteCache(QObject *parent = nullptr);
+
+  /** @brief The cached parse of @p path if it still matches the file. */
+  Entry lookup(const QString &path);
+  /** @brief The cached parse, or reads and parses the note now. */
+  Entry load(const QString &path);
+  /** @brief Reads and parses the note now and caches it; no lookup. */
+  Entry parse(const QString &path);
+  void clear();
+
+  static constexpr qint64 kDefaultBudget = 32 * 1024 * 1024;
+  void setBudget(qint64 bytes);
+  qint64 budget() const;
+
+  /**
+   * @brief Resolves ![[@p link]] found in the note at @p notePath and
+   * reports the text through embedResolved().
+   * @return The request ID embedResolved() carries.
+   */
+  Q_INVOKABLE int requestEmbed(const QString &notePath, const QString &link);
+
+  /**
+   * @brief Reads ahead the notes linked from @p path (see
+   * NotesIndex::linkedNotesToPrefetch()) on a low-priority thread,
+   * replacing the read-ahead of the previously opened note. Reads for the
+   * GUI go first: read-ahead waits while any is running.
+   */
+  void prefetchLinks(const QString &path);
+  static constexpr int kPrefetchCount = 8;
+  static constexpr qint64 kPrefetchBytes = 2 * 1024 * 1024;
+
+  /**
+   * @brief hits, misses, hitRate, entries, bytes and budget (bytes), and
+   * for read-ahead: prefetched, prefetchHits and prefetchHitRate (the
+   * share of read-ahead notes that were then opened or embedded).
+   */
+  Q_INVOKABLE QVariantMap stats() const;
+
+signals:
+  // text is empty and error set if the embed could not be resolved
+  void embedResolved(int request, const QString &text, const QString &error);
+
+private:
+  struct EmbedJob {
+    int id = 0;
+    QString notePath;
+    QString link;
+    QHash<QString, Entry> notes; // read for this job; null if unreadable
+  };
+
+  // Holder so QCache may delete entries still in use elsewhere
+  struct Slot {
+    Entry note;
+  };
+
+  static constexpr int kMaxEmbedDepth = 8;
+
+  Entry cached(const QString &path, const QFileInfo &info);
+  Entry read(const QString &path, const QFileInfo &info);
+  void countHit(const QString &path);
+  void waitForForeground();
+  void resolveEmbed(EmbedJob job);
+  void readInBackground(const QString &path);
+  void onRead(const QString &path, const Entry &note);
+  QString expandEmbed(const QString &notePath, const QString &link,
+                      QStringList &stack, const EmbedJob &job,
+                      QString *missing, QString *error);
+  static QVector<ParsedNote::Embed> scanEmbeds(const QByteArray &data,
+                                               qsizetype bodyOffset);
+
+  static ParsedNoteCache *s_instance;
+
+  mutable QMutex m_mutex;
+  QCache<QString, Slot> m_cache;
+  std::atomic<qint64> m_hits{0};
+  std::atomic<qint64> m_misses{0};
+
+  // Reads someone waits for, against which read-ahead holds back
+  QMutex m_foregroundMutex;
+  QWaitCondition m_foregroundIdle;
+  int m_foreground = 0;
+
+  QThreadPool m_prefetchPool; // one low-priority thread
+  std::atomic<int> m_prefetchGeneration{0};
+  QSet<QString> m_prefetched; // read ahead, not used since (under m_mutex)
+  std::atomic<qint64> m_prefetchReads{0};
+  std::atomic<qint64> m_prefetchHits{0};
+
+  QThreadPool m_pool;
+  int m_nextRequest = 0;
+  QHash<QString, QVector<EmbedJob>> m_waiting; // notes being read
+};
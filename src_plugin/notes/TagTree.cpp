@@ -0,0 +1,106 @@
+#include "TagTree.h"
+#include <algorithm>
+
+TagTree::TagTree() {
+  m_names.append(QString());
+  m_tags.append(QString());
+  m_parents.append(kNone);
+  m_children.append(QVector<quint32>());
+  m_notes.append(QVector<NoteId>());
+}
+
+quint32 TagTree::find(const QString &tag) const {
+  QString key;
+  for (const QString &segment :
+       tag.split(QLatin1Char('/'), Qt::SkipEmptyParts)) {
+    if (!key.isEmpty())
+      key += QLatin1Char('/');
+    key += segment.toLower();
+  }
+  return key.isEmpty() ? kNone : m_byKey.value(key, kNone);
+}
+
+quint32 TagTree::intern(quint32 parent, const QString &segment) {
+  QString key = parent == kRoot ? QString() : m_tags[parent].toLower();
+  if (!key.isEmpty())
+    key += QLatin1Char('/');
+  key += segment.toLower();
+
+  auto it = m_byKey.constFind(key);
+  if (it != m_byKey.constEnd())
+    return it.value();
+
+  quint32 node = quint32(m_names.size());
+  m_names.append(segment);
+  m_tags.append(parent == kRoot ? segment
+                                : m_tags[parent] + QLatin1Char('/') + segment);
+  m_parents.append(parent);
+  m_children.append(QVector<quint32>());
+  m_notes.append(QVector<NoteId>());
+  m_byKey.insert(key, node);
+  return node;
+}
+
+QVector<quint32> TagTree::nodesOf(const QStringList &tags, bool create) {
+  // Every node on the path of every tag, once; the root is left out
+  QVector<quint32> nodes;
+  for (const QString &tag : tags) {
+    quint32 node = kRoot;
+    for (const QString &segment :
+         tag.split(QLatin1Char('/'), Qt::SkipEmptyParts)) {
+      if (create) {
+        node = intern(node, segment);
+      } else {
+        const QString key =
+            (node == kRoot ? QString()
+                           : m_tags[node].toLower() + QLatin1Char('/')) +
+            segment.toLower();
+        node = m_byKey.value(key, kNone);
+        if (node == kNone)
+          break;
+      }
+      if (!nodes.contains(node))
+        nodes.append(node);
+    }
+  }
+  return nodes;
+}
+
+void TagTree::addNote(NoteId id, const QStringList &tags) {
+  for (quint32 node : nodesOf(tags, true)) {
+    QVector<NoteId> &notes = m_notes[node];
+    auto it = std::lower_bound(notes.begin(), notes.end(), id);
+    if (it != notes.end() && *it == id)
+      continue;
+    notes.insert(it, id);
+    if (notes.size() == 1)
+      attach(node);
+  }
+}
+
+void TagTree::removeNote(NoteId id, const QStringList &tags) {
+  for (quint32 node : nodesOf(tags, false)) {
+    QVector<NoteId> &notes = m_notes[node];
+    auto it = std::lower_bound(notes.begin(), notes.end(), id);
+    if (it == notes.end() || *it != id)
+      continue;
+    notes.erase(it);
+    if (notes.isEmpty())
+      detach(node);
+  }
+}
+
+void TagTree::attach(quint32 node) {
+  QVector<quint32> &siblings = m_children[m_parents[node]];
+  auto it = std::lower_bound(
+      siblings.begin(), siblings.end(), node, [this](quint32 a, quint32 b) {
+        return m_names[a].compare(m_names[b], Qt::CaseInsensitive) < 0;
+      });
+  siblings.insert(it, node);
+  m_generation++;
+}
+
+void TagTree::detach(quint32 node) {
+  m_children[m_parents[node]].removeOne(node);
+  m_generation++;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+using NoteId = quint32;
+
+/**
+ * @brief Prefix tree over nested tags ("project/alpha/backend").
+ *
+ * Each node is one path segment and holds the sorted IDs of every note
+ * tagged with it or anything below it, so "all notes under project/" is a
+ * lookup and a node's count is the number of distinct notes in its
+ * subtree. Notes are added and removed with their full tag lists; both
+ * touch only the nodes on those tags' paths.
+ *
+ * Segments compare case-insensitively and keep the spelling they were
+ * first seen with. Nodes are never freed, so node IDs stay valid; a node
+ * without notes is dropped from its parent's children, which are kept
+ * sorted by name. generation() changes whenever a node appears in or
+ * disappears from the tree.
+ */
+class TagTree {
+public:
+  static constexpr quint32 kRoot = 0;
+  static constexpr quint32 kNone = ~quint32(0);
+
+  TagTree();
+
+  void addNote(NoteId id, const QStringList &tags);
+  void removeNote(NoteId id, const QStringList &tags);
+
+  /** @brief Node for @p tag, compared case-insensitively, or kNone. */
+  quint32 find(const QString &tag) const;
+
+  const QString &name(quint32 node) const { return m_names[node]; }
+  /** @brief Full tag of @p node, e.g. "Project/Alpha". */
+  const QString &tag(quint32 node) const { return m_tags[node]; }
+  quint32 parent(quint32 node) const { return m_parents[node]; }
+  /** @brief Children that have notes, sorted by name. */
+  const QVector<quint32> &children(quint32 node) const {
+    return m_children[node];
+  }
+  /** @brief Sorted IDs of the notes tagged @p node or below it. */
+  const QVector<NoteId> &notes(quint32 node) const { return m_notes[node]; }
+  int noteCount(quint32 node) const { return int(m_notes[node].size()); }
+
+  quint64 generation() const { return m_generation; }
+
+private:
+  quint32 intern(quint32 parent, const QString &segment);
+  QVector<quint32> nodesOf(const QStringList &tags, bool create);
+  void attach(quint32 node);
+  void detach(quint32 node);
+
+  // Columns, indexed by node ID
+  QVector<QString> m_names;
+  QVector<QString> m_tags;
+  QVector<quint32> m_parents;
+  QVector<QVector<quint32>> m_children;
+  QVector<QVector<NoteId>> m_notes;
+
+  QHash<QString, quint32> m_byKey; // lowercased full tag -> node
+  quint64 m_generation = 0;
+};
@@ -0,0 +1,397 @@
+#include "TrigramIndex.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace {
+constexpr quint32 kMagic = 0x4E545249; // "NTRI"
+constexpr quint32 kVersion = 1;
+
+// Posting lists are stored as LEB128-encoded deltas
+void appendVarint(QByteArray &out, quint32 value) {
+  while (value >= 0x80) {
+    out.append(char((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.append(char(value));
+}
+
+// Decodes a posting list, rejecting anything save() cannot have written:
+// IDs must be strictly increasing and below @p limit
+bool readVarints(const QByteArray &in, quint32 limit, QVector<quint32> &out) {
+  quint64 value = 0, next = 0;
+  int shift = 0;
+  for (char c : in) {
+    value |= quint64(quint8(c) & 0x7F) << shift;
+    if (quint8(c) & 0x80) {
+      shift += 7;
+      if (shift > 28)
+        return false;
+      continue;
+    }
+    if (!out.isEmpty() && value == 0)
+      return false; // a repeated ID
+    next = (out.isEmpty() ? 0 : quint64(out.last())) + value;
+    if (next >= limit)
+      return false;
+    out.append(quint32(next));
+    value = 0;
+    shift = 0;
+  }
+  return shift == 0;
+}
+
+// Smallest serialized sizes, to bound counts read from the header: a
+// document is an empty QString (length only) plus size and mtime, a
+// posting list its trigram plus an empty QByteArray
+constexpr qint64 kMinDocumentBytes = 4 + 8 + 8;
+constexpr qint64 kMinPostingBytes = 8 + 4;
+} // namespace
+
+QVector<quint64> TrigramIndex::extract(const QString &text) {
+  const QString folded = text.toCaseFolded();
+  QVector<quint64> trigrams;
+  if (folded.size() < 3)
+    return trigrams;
+
+  const char16_t *units = reinterpret_cast<const char16_t *>(folded.utf16());
+  trigrams.reserve(folded.size() - 2);
+  quint64 key = (quint64(units[0]) << 16) | units[1];
+  for (qsizetype i = 2; i < folded.size(); ++i) {
+    key = ((key << 16) | units[i]) & 0xFFFFFFFFFFFFull;
+    trigrams.append(key);
+  }
+
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()),
+                 trigrams.end());
+  return trigrams;
+}
+
+QString TrigramIndex::indexPath(const QString &rootPath) {
+  return QDir::cleanPath(rootPath) + QStringLiteral("/.notes-trigrams.bin");
+}
+
+void TrigramIndex::clear() {
+  QWriteLocker locker(&m_lock);
+  m_docs.clear();
+  m_docByPath.clear();
+  m_postings.clear();
+  m_dead = 0;
+  m_revision++;
+}
+
+bool TrigramIndex::isDirty() const {
+  QReadLocker locker(&m_lock);
+  return m_revision != m_savedRevision;
+}
+
+bool TrigramIndex::isCurrent(const Source &source) const {
+  QReadLocker locker(&m_lock);
+  return isCurrentLocked(source);
+}
+
+bool TrigramIndex::isCurrentLocked(const Source &source) const {
+  auto it = m_docByPath.constFind(source.path);
+  if (it == m_docByPath.constEnd())
+    return false;
+  const Document &doc = m_docs[it.value()];
+  return doc.size == source.size && doc.mtimeMs == source.mtimeMs;
+}
+
+void TrigramIndex::addDocument(const Source &source,
+                               const QVector<quint64> &trigrams) {
+  QWriteLocker locker(&m_lock);
+  removeLocked(source.path);
+
+  quint32 id = quint32(m_docs.size());
+  m_docs.append({source.path, source.size, source.mtimeMs, true});
+  m_docByPath.insert(source.path, id);
+  m_revision++;
+  // IDs grow monotonically, so appending keeps every list sorted
+  for (quint64 trigram : trigrams)
+    m_postings[trigram].append(id);
+}
+
+void TrigramIndex::removeDocument(const QString &path) {
+  QWriteLocker locker(&m_lock);
+  removeLocked(path);
+}
+
+void TrigramIndex::removeLocked(const QString &path) {
+  auto it = m_docByPath.find(path);
+  if (it == m_docByPath.end())
+    return;
+  m_docs[it.value()].alive = false;
+  m_docByPath.erase(it);
+  m_dead++;
+  m_revision++;
+
+  if (m_dead > 64 && m_dead * 4 > m_docs.size())
+    compactLocked();
+}
+
+void TrigramIndex::compactLocked() {
+  QVector<quint32> remap(m_docs.size(), ~0u);
+  QVector<Document> docs;
+  docs.reserve(m_docs.size() - m_dead);
+  for (int i = 0; i < m_docs.size(); ++i) {
+    if (m_docs[i].alive) {
+      remap[i] = quint32(docs.size());
+      docs.append(m_docs[i]);
+    }
+  }
+
+  // Remapping preserves order, so lists stay sorted
+  for (auto it = m_postings.begin(); it != m_postings.end();) {
+    QVector<quint32> &list = it.value();
+    int out = 0;
+    for (quint32 id : std::as_const(list)) {
+      if (remap[id] != ~0u)
+        list[out++] = remap[id];
+    }
+    list.resize(out);
+    if (list.isEmpty()) {
+      it = m_postings.erase(it);
+    } else {
+      list.squeeze();
+      ++it;
+    }
+  }
+
+  m_docs = std::move(docs);
+  m_docByPath.clear();
+  m_docByPath.reserve(m_docs.size());
+  for (int i = 0; i < m_docs.size(); ++i)
+    m_docByPath.insert(m_docs[i].path, quint32(i));
+  m_dead = 0;
+}
+
+bool TrigramIndex::update(const QVector<Source> &notes,
+                          const std::atomic<bool> *cancelled) {
+  QElapsedTimer timer;
+  timer.start();
+  bool changed = false;
+  int indexed = 0;
+  qint64 indexedBytes = 0;
+
+  // Documents whose note is gone
+  QSet<QString> present;
+  present.reserve(notes.size());
+  for (const Source &note : notes)
+    present.insert(note.path);
+  {
+    QWriteLocker locker(&m_lock);
+    QStringList gone;
+    for (auto it = m_docByPath.constBegin(); it != m_docByPath.constEnd();
+         ++it) {
+      if (!present.contains(it.key()))
+        gone.append(it.key());
+    }
+    for (const QString &path : std::as_const(gone))
+      removeLocked(path);
+    changed = !gone.isEmpty();
+  }
+
+  for (const Source &note : notes) {
+    if (cancelled && cancelled->load())
+      return changed;
+    {
+      QReadLocker locker(&m_lock);
+      if (isCurrentLocked(note))
+        continue;
+    }
+
+    // Read and extract outside the lock; searches keep running meanwhile
+    QFile file(note.path);
+    if (!file.open(QIODevice::ReadOnly))
+      continue;
+    QByteArray data = file.readAll();
+    file.close();
+
+    addDocument(note, extract(QString::fromUtf8(data)));
+    indexed++;
+    indexedBytes += data.size();
+    changed = true;
+  }
+
+  QWriteLocker locker(&m_lock);
+  m_lastIndexed = indexed;
+  m_lastIndexedBytes = indexedBytes;
+  m_lastElapsedMs = timer.elapsed();
+  return changed;
+}
+
+QStringList TrigramIndex::candidates(const QString &query) const {
+  const QVector<quint64> trigrams = extract(query);
+  QReadLocker locker(&m_lock);
+
+  QStringList paths;
+  if (trigrams.isEmpty()) {
+    paths.reserve(m_docByPath.size());
+    for (auto it = m_docByPath.constBegin(); it != m_docByPath.constEnd();
+         ++it)
+      paths.append(it.key());
+    return paths;
+  }
+
+  // Intersect the shortest lists first; the result only ever shrinks
+  QVector<const QVector<quint32> *> lists;
+  lists.reserve(trigrams.size());
+  for (quint64 trigram : trigrams) {
+    auto it = m_postings.constFind(trigram);
+    if (it == m_postings.constEnd())
+      return paths; // some trigram occurs nowhere
+    lists.append(&it.value());
+  }
+  std::sort(lists.begin(), lists.end(),
+            [](const QVector<quint32> *a, const QVector<quint32> *b) {
+              return a->size() < b->size();
+            });
+
+  QVector<quint32> result = *lists.first();
+  QVector<quint32> next;
+  for (int i = 1; i < lists.size() && !result.isEmpty(); ++i) {
+    next.clear();
+    std::set_intersection(result.cbegin(), result.cend(),
+                          lists[i]->cbegin(), lists[i]->cend(),
+                          std::back_inserter(next));
+    result.swap(next);
+  }
+
+  for (quint32 id : std::as_const(result)) {
+    if (m_docs[id].alive)
+      paths.append(m_docs[id].path);
+  }
+  return paths;
+}
+
+TrigramIndex::Stats TrigramIndex::stats() const {
+  QReadLocker locker(&m_lock);
+  Stats stats;
+  stats.documents = m_docByPath.size();
+  stats.trigrams = m_postings.size();
+  for (auto it = m_postings.constBegin(); it != m_postings.constEnd(); ++it)
+    stats.postings += it.value().size();
+
+  // Lists, hash nodes and list headers, plus the document table
+  stats.memoryBytes = stats.postings * qint64(sizeof(quint32)) +
+                      stats.trigrams * 64 + m_docs.size() * 96;
+  for (const Document &doc : m_docs)
+    stats.memoryBytes += doc.path.size() * 2;
+
+  stats.indexed = m_lastIndexed;
+  stats.indexedBytes = m_lastIndexedBytes;
+  stats.elapsedMs = m_lastElapsedMs;
+  return stats;
+}
+
+bool TrigramIndex::save(const QString &rootPath) const {
+  const QString rootPrefix = QDir::cleanPath(rootPath) + QLatin1Char('/');
+  QReadLocker locker(&m_lock);
+
+  // Written compacted: live documents renumbered in order
+  QVector<quint32> remap(m_docs.size(), ~0u);
+  quint32 live = 0;
+  for (int i = 0; i < m_docs.size(); ++i) {
+    if (m_docs[i].alive)
+      remap[i] = live++;
+  }
+
+  const quint64 revision = m_revision;
+  QSaveFile file(indexPath(rootPath));
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  QDataStream out(&file);
+  out << kMagic << kVersion << live;
+  for (const Document &doc : m_docs) {
+    if (doc.alive)
+      out << doc.path.mid(rootPrefix.size()) << doc.size << doc.mtimeMs;
+  }
+
+  out << quint32(m_postings.size());
+  QByteArray encoded;
+  for (auto it = m_postings.constBegin(); it != m_postings.constEnd(); ++it) {
+    encoded.clear();
+    quint32 previous = 0;
+    for (quint32 id : it.value()) {
+      if (remap[id] == ~0u)
+        continue;
+      appendVarint(encoded, remap[id] - previous);
+      previous = remap[id];
+    }
+    out << it.key() << encoded;
+  }
+
+  if (out.status() != QDataStream::Ok || !file.commit())
+    return false;
+  m_savedRevision = revision;
+  return true;
+}
+
+bool TrigramIndex::load(const QString &rootPath) {
+  const QString rootPrefix = QDir::cleanPath(rootPath) + QLatin1Char('/');
+  QFile file(indexPath(rootPath));
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream in(&file);
+  quint32 magic = 0, version = 0, docCount = 0;
+  in >> magic >> version >> docCount;
+  if (magic != kMagic || version != kVersion)
+    return false;
+  // Counts come from the file; never reserve more than it can hold
+  if (docCount > (file.size() - file.pos()) / kMinDocumentBytes) {
+    qDebug() << "TrigramIndex: ignoring corrupt index" << file.fileName();
+    return false;
+  }
+
+  QVector<Document> docs;
+  QHash<QString, quint32> docByPath;
+  docs.reserve(docCount);
+  for (quint32 i = 0; i < docCount && in.status() == QDataStream::Ok; ++i) {
+    Document doc;
+    QString relativePath;
+    in >> relativePath >> doc.size >> doc.mtimeMs;
+    doc.path = rootPrefix + relativePath;
+    docByPath.insert(doc.path, i);
+    docs.append(doc);
+  }
+
+  quint32 trigramCount = 0;
+  in >> trigramCount;
+  if (in.status() != QDataStream::Ok ||
+      trigramCount > (file.size() - file.pos()) / kMinPostingBytes) {
+    qDebug() << "TrigramIndex: ignoring corrupt index" << file.fileName();
+    return false;
+  }
+  QHash<quint64, QVector<quint32>> postings;
+  postings.reserve(trigramCount);
+  QByteArray encoded;
+  for (quint32 i = 0; i < trigramCount && in.status() == QDataStream::Ok;
+       ++i) {
+    quint64 trigram = 0;
+    in >> trigram >> encoded;
+    QVector<quint32> &list = postings[trigram];
+    if (!list.isEmpty() || !readVarints(encoded, docCount, list))
+      in.setStatus(QDataStream::ReadCorruptData); // duplicate or malformed
+  }
+
+  if (in.status() != QDataStream::Ok) {
+    qDebug() << "TrigramIndex: ignoring corrupt index" << file.fileName();
+    return false;
+  }
+
+  QWriteLocker locker(&m_lock);
+  m_docs = std::move(docs);
+  m_docByPath = std::move(docByPath);
+  m_postings = std::move(postings);
+  m_dead = 0;
+  m_savedRevision = ++m_revision;
+  return true;
+}
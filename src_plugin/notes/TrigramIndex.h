@@ -0,0 +1,106 @@
+#pragma once
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief Inverted index from case-folded trigrams to the notes containing
+ * them, used to narrow full-text searches down to a few candidates.
+ *
+ * A trigram is three consecutive UTF-16 units of the case-folded body. A
+ * note can only contain a query if it contains every trigram of the query,
+ * so intersecting the query's posting lists yields a superset of the
+ * matches that callers then verify against the text.
+ *
+ * Document IDs only ever grow, which keeps posting lists sorted on append.
+ * Updated or deleted notes leave a dead ID behind that is skipped on reads
+ * and squeezed out once dead IDs make up a quarter of the index.
+ *
+ * The index is persisted in the vault next to the metadata cache; on load
+ * every document remembers the size and mtime it was built from, so only
+ * changed notes are read again. Notes the indexer parses anyway are added
+ * with the trigrams it extracted, and update() only reads the rest. All
+ * methods are thread-safe.
+ */
+class TrigramIndex {
+public:
+  struct Source {
+    QString path;
+    qint64 size = 0;
+    qint64 mtimeMs = 0;
+  };
+
+  struct Stats {
+    int documents = 0;
+    qint64 trigrams = 0;
+    qint64 postings = 0;
+    qint64 memoryBytes = 0; // estimate
+    // Last update()
+    int indexed = 0;
+    qint64 indexedBytes = 0;
+    qint64 elapsedMs = 0;
+  };
+
+  /**
+   * @brief Case-folded, sorted, de-duplicated trigrams of @p text.
+   */
+  static QVector<quint64> extract(const QString &text);
+
+  void clear();
+  bool load(const QString &rootPath);
+  bool save(const QString &rootPath) const;
+  /** @brief Whether documents changed since the last load() or save(). */
+  bool isDirty() const;
+  static QString indexPath(const QString &rootPath);
+
+  /**
+   * @brief Brings the index in line with @p notes: drops documents that are
+   * gone and reads every note whose size or mtime changed. Meant to run on
+   * a worker thread; returns early once @p cancelled is set.
+   * @return True if the index changed.
+   */
+  bool update(const QVector<Source> &notes,
+              const std::atomic<bool> *cancelled = nullptr);
+
+  /** @brief Whether @p source is indexed with this size and mtime. */
+  bool isCurrent(const Source &source) const;
+  void addDocument(const Source &source, const QVector<quint64> &trigrams);
+  void removeDocument(const QString &path);
+
+  /**
+   * @brief Notes that may contain @p query (case-insensitive). Queries
+   * shorter than a trigram match every document.
+   */
+  QStringList candidates(const QString &query) const;
+
+  Stats stats() const;
+
+private:
+  struct Document {
+    QString path;
+    qint64 size = 0;
+    qint64 mtimeMs = 0;
+    bool alive = true;
+  };
+
+  bool isCurrentLocked(const Source &source) const;
+  void removeLocked(const QString &path);
+  void compactLocked();
+
+  mutable QReadWriteLock m_lock;
+  QVector<Document> m_docs; // by document ID
+  QHash<QString, quint32> m_docByPath;
+  QHash<quint64, QVector<quint32>> m_postings; // trigram -> sorted doc IDs
+  int m_dead = 0;
+  quint64 m_revision = 0; // bumped by every document change
+  mutable std::atomic<quint64> m_savedRevision{0};
+
+  int m_lastIndexed = 0;
+  qint64 m_lastIndexedBytes = 0;
+  qint64 m_lastElapsedMs = 0;
+};
@@ -0,0 +1,214 @@
+#include "VaultWalker.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QVector>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <strings.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+QString directoryPrefix(const QString &dirPath) {
+  QString prefix = QDir::cleanPath(dirPath);
+  if (!prefix.endsWith(QLatin1Char('/')))
+    prefix += QLatin1Char('/');
+  return prefix;
+}
+
+// Lists one directory. Subdirectories that may be descended into are
+// appended to @p subdirs even when the caller did not ask for Dirs.
+bool listImpl(const QString &dirPath, int filters,
+              const VaultWalker::Visitor &visit, QVector<QString> *subdirs) {
+  const QString prefix = directoryPrefix(dirPath);
+  const bool wantDirs = filters & VaultWalker::Dirs;
+
+#if defined(Q_OS_WIN)
+  std::wstring pattern =
+      QDir::toNativeSeparators(prefix).toStdWString() + L"*";
+  WIN32_FIND_DATAW data;
+  HANDLE find =
+      FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data,
+                       FindExSearchNameMatch, nullptr,
+                       FIND_FIRST_EX_LARGE_FETCH);
+  if (find == INVALID_HANDLE_VALUE)
+    return false;
+
+  do {
+    const wchar_t *name = data.cFileName;
+    // Dot-names are hidden as on POSIX and to VaultWatcher (".", "..",
+    // .obsidian/, .trash/, the index caches); so are hidden attributes
+    if (name[0] == L'.')
+      continue;
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_HIDDEN)
+      continue;
+
+    VaultWalker::Entry entry;
+    entry.isDir = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    // Only links and junctions; cloud placeholders are reparse points too
+    // and must still be walked. dwReserved0 holds the reparse tag.
+    entry.isSymLink =
+        (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) &&
+        (data.dwReserved0 == IO_REPARSE_TAG_SYMLINK ||
+         data.dwReserved0 == IO_REPARSE_TAG_MOUNT_POINT);
+    entry.name = QString::fromWCharArray(name);
+
+    bool note = !entry.isDir && VaultWalker::isNoteName(entry.name);
+    if (entry.isDir ? !(wantDirs || subdirs)
+                    : !(filters & (note ? VaultWalker::Notes
+                                        : VaultWalker::OtherFiles)))
+      continue;
+
+    entry.path = prefix + entry.name;
+    entry.size = (qint64(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    // FILETIME counts 100 ns ticks since 1601-01-01
+    qint64 ticks = (qint64(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                   data.ftLastWriteTime.dwLowDateTime;
+    entry.mtimeMs = (ticks - 116444736000000000LL) / 10000;
+
+    if (entry.isDir && subdirs && !entry.isSymLink)
+      subdirs->append(entry.path);
+    if (!entry.isDir || wantDirs)
+      visit(entry);
+  } while (FindNextFileW(find, &data));
+
+  FindClose(find);
+  return true;
+
+#elif defined(Q_OS_UNIX)
+  DIR *dir = opendir(QFile::encodeName(prefix).constData());
+  if (!dir)
+    return false;
+  int fd = dirfd(dir);
+
+  while (dirent *ent = readdir(dir)) {
+    const char *name = ent->d_name;
+    if (name[0] == '.')
+      continue; // hidden, "." and ".."
+
+    size_t length = strlen(name);
+    bool noteName = length > 3 && strcasecmp(name + length - 3, ".md") == 0;
+
+    // d_type fast path: regular files the caller does not want, and
+    // directories nobody needs, are dropped without a stat
+    unsigned char type = ent->d_type;
+    bool wantNote = filters & VaultWalker::Notes;
+    bool wantOther = filters & VaultWalker::OtherFiles;
+    if (type == DT_REG) {
+      if (noteName ? !wantNote : !wantOther)
+        continue;
+    } else if (type == DT_DIR) {
+      if (!wantDirs && !subdirs)
+        continue;
+    } else if (type != DT_LNK && type != DT_UNKNOWN) {
+      continue; // fifo, socket, device
+    }
+
+    VaultWalker::Entry entry;
+    entry.name = QFile::decodeName(name);
+    entry.path = prefix + entry.name;
+    entry.isSymLink = type == DT_LNK;
+
+    if (type == DT_REG && !noteName) {
+      // Attachments are reported without stat data
+      visit(entry);
+      continue;
+    }
+
+    struct stat st;
+    if (fstatat(fd, name, &st, 0) != 0)
+      continue; // dangling link or raced deletion
+    if (type == DT_UNKNOWN) {
+      struct stat lst;
+      entry.isSymLink = fstatat(fd, name, &lst, AT_SYMLINK_NOFOLLOW) == 0 &&
+                        S_ISLNK(lst.st_mode);
+    }
+
+    entry.isDir = S_ISDIR(st.st_mode);
+    if (!entry.isDir && !S_ISREG(st.st_mode))
+      continue;
+    if (!entry.isDir && !(filters & (noteName ? VaultWalker::Notes
+                                              : VaultWalker::OtherFiles)))
+      continue;
+    if (entry.isDir && !wantDirs && !subdirs)
+      continue;
+
+    entry.size = st.st_size;
+#if defined(Q_OS_DARWIN)
+    const struct timespec &mtime = st.st_mtimespec;
+#else
+    const struct timespec &mtime = st.st_mtim;
+#endif
+    entry.mtimeMs = qint64(mtime.tv_sec) * 1000 + mtime.tv_nsec / 1000000;
+
+    if (entry.isDir && subdirs && !entry.isSymLink)
+      subdirs->append(entry.path);
+    if (!entry.isDir || wantDirs)
+      visit(entry);
+  }
+
+  closedir(dir);
+  return true;
+
+#else
+  if (!QFileInfo(dirPath).isDir())
+    return false;
+
+  QDirIterator it(dirPath, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+  while (it.hasNext()) {
+    it.next();
+    QFileInfo info = it.fileInfo();
+
+    VaultWalker::Entry entry;
+    entry.name = info.fileName();
+    entry.isDir = info.isDir();
+    entry.isSymLink = info.isSymLink();
+    bool note = !entry.isDir && VaultWalker::isNoteName(entry.name);
+    if (entry.isDir ? !(wantDirs || subdirs)
+                    : !(filters & (note ? VaultWalker::Notes
+                                        : VaultWalker::OtherFiles)))
+      continue;
+
+    entry.path = prefix + entry.name;
+    entry.size = info.size();
+    entry.mtimeMs = info.lastModified().toMSecsSinceEpoch();
+
+    if (entry.isDir && subdirs && !entry.isSymLink)
+      subdirs->append(entry.path);
+    if (!entry.isDir || wantDirs)
+      visit(entry);
+  }
+  return true;
+#endif
+}
+
+} // namespace
+
+bool VaultWalker::isNoteName(const QString &name) {
+  return name.endsWith(QLatin1String(".md"), Qt::CaseInsensitive);
+}
+
+bool VaultWalker::listDirectory(const QString &dirPath, int filters,
+                                const Visitor &visit) {
+  return listImpl(dirPath, filters, visit, nullptr);
+}
+
+void VaultWalker::walk(const QString &rootPath, int filters,
+                       const Visitor &visit,
+                       const std::atomic<bool> *cancelled) {
+  QVector<QString> pending{QDir::cleanPath(rootPath)};
+  while (!pending.isEmpty()) {
+    if (cancelled && cancelled->load())
+      return;
+    QString dirPath = pending.takeLast();
+    listImpl(dirPath, filters, visit, &pending);
+  }
+}
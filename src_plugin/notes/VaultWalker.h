@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <functional>
+
+/**
+ * @brief Single-pass directory enumeration shared by everything that lists
+ * the notes vault.
+ *
+ * Each directory is read exactly once and every entry is reported together
+ * with its stat data, so callers never build a QFileInfo or stat a second
+ * time. Backends:
+ *  - Windows: FindFirstFileExW (basic info, large fetch); size and mtime
+ *    come with the directory record.
+ *  - POSIX: readdir() using d_type to skip entries the caller did not ask
+ *    for without a stat; only requested entries are fstatat()-ed.
+ *  - Elsewhere: QDirIterator.
+ * Hidden entries are skipped like QDirIterator does without QDir::Hidden,
+ * and symlinked directories are reported but never descended into.
+ */
+class VaultWalker {
+public:
+  enum Filter {
+    Notes = 1 << 0,      // *.md files
+    Dirs = 1 << 1,       // subdirectories
+    OtherFiles = 1 << 2, // attachments; no stat data is gathered
+    All = Notes | Dirs | OtherFiles
+  };
+
+  struct Entry {
+    QString path; // cleaned absolute path
+    QString name;
+    bool isDir = false;
+    bool isSymLink = false;
+    qint64 size = 0;
+    qint64 mtimeMs = 0; // ms since epoch
+  };
+
+  using Visitor = std::function<void(const Entry &)>;
+
+  /**
+   * @brief Lists the direct children of @p dirPath matching @p filters.
+   * @return False if the directory could not be opened.
+   */
+  static bool listDirectory(const QString &dirPath, int filters,
+                            const Visitor &visit);
+
+  /**
+   * @brief Recursively walks @p rootPath, reporting entries matching
+   * @p filters. Stops early once @p cancelled becomes true.
+   */
+  static void walk(const QString &rootPath, int filters, const Visitor &visit,
+                   const std::atomic<bool> *cancelled = nullptr);
+
+  static bool isNoteName(const QString &name);
+};
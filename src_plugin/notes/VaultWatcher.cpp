@@ -0,0 +1,688 @@
+#include "VaultWatcher.h"
+#include "VaultWalker.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSet>
+#include <QtConcurrent>
+
+#if defined(Q_OS_LINUX)
+#include <QSocketNotifier>
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <QFileInfo>
+#include <QThread>
+#include <vector>
+#include <windows.h>
+#endif
+
+namespace {
+bool isUnder(const QString &path, const QString &dirPath) {
+  return path.size() > dirPath.size() && path.startsWith(dirPath) &&
+         path.at(dirPath.size()) == QLatin1Char('/');
+}
+} // namespace
+
+VaultWatcher::VaultWatcher(QObject *parent)
+    : QObject(parent), m_flushTimer(new QTimer(this)),
+      m_pollTimer(new QTimer(this)),
+      m_pollWatcher(new QFutureWatcher<Snapshot>(this)) {
+  m_flushTimer->setSingleShot(true);
+  connect(m_flushTimer, &QTimer::timeout, this, &VaultWatcher::flush);
+
+  m_pollTimer->setSingleShot(true);
+  connect(m_pollTimer, &QTimer::timeout, this, &VaultWatcher::poll);
+  connect(m_pollWatcher, &QFutureWatcher<Snapshot>::finished, this,
+          &VaultWatcher::onPollFinished);
+}
+
+VaultWatcher::~VaultWatcher() { stop(); }
+
+void VaultWatcher::start(const QString &rootPath) {
+  QString root = QDir::cleanPath(rootPath);
+  if (root == m_rootPath)
+    return;
+
+  stop();
+  if (root.isEmpty())
+    return;
+
+  m_rootPath = root;
+  if (!startInotify() && !startDirectoryWatch())
+    startPolling();
+}
+
+void VaultWatcher::stop() {
+  stopInotify();
+  stopDirectoryWatch();
+  m_pollTimer->stop();
+  m_pollWatcher->waitForFinished();
+  m_snapshot.clear();
+  m_hasSnapshot = false;
+
+  m_flushTimer->stop();
+  m_batchAge.invalidate();
+  m_pending.clear();
+  m_pendingRenames.clear();
+  m_rootPath.clear();
+}
+
+bool VaultWatcher::isReported(const QString &name) {
+  return !name.startsWith(QLatin1Char('.'));
+}
+
+bool VaultWatcher::isNotePath(const QString &path) {
+  return VaultWalker::isNoteName(
+      path.mid(path.lastIndexOf(QLatin1Char('/')) + 1));
+}
+
+// Coalescing
+
+void VaultWatcher::record(const QString &path, Op op) {
+  if (op == Op::Removed) {
+    // A rename target deleted in the same batch: the source is what's gone
+    for (int i = 0; i < m_pendingRenames.size(); ++i) {
+      if (m_pendingRenames[i].second == path) {
+        QString from = m_pendingRenames.takeAt(i).first;
+        m_pending.remove(path);
+        record(from, Op::Removed);
+        return;
+      }
+    }
+  }
+
+  auto it = m_pending.find(path);
+  if (it == m_pending.end()) {
+    m_pending.insert(path, op);
+  } else if (it.value() == Op::Added && op == Op::Removed) {
+    m_pending.erase(it); // transient file, e.g. an editor's temp copy
+  } else if (it.value() == Op::Removed && op == Op::Added) {
+    it.value() = Op::Modified; // replaced in place
+  } else if (it.value() != Op::Added) {
+    it.value() = op;
+  }
+  scheduleFlush();
+}
+
+void VaultWatcher::recordRename(const QString &from, const QString &to) {
+  // Pending additions and edits under a renamed directory follow it;
+  // removals keep their old path so they apply before the rename
+  const QString prefix = from + QLatin1Char('/');
+  QVector<QPair<QString, Op>> moved;
+  for (auto it = m_pending.begin(); it != m_pending.end();) {
+    if (it.key().startsWith(prefix) && it.value() != Op::Removed) {
+      moved.append({to + it.key().mid(from.size()), it.value()});
+      it = m_pending.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (const auto &entry : std::as_const(moved))
+    m_pending.insert(entry.first, entry.second);
+
+  auto pending = m_pending.find(from);
+  if (pending != m_pending.end() && pending.value() != Op::Removed) {
+    Op op = pending.value();
+    m_pending.erase(pending);
+    if (op == Op::Added) {
+      // Created during this batch; the old name never reaches the index
+      record(to, Op::Added);
+      return;
+    }
+    record(to, Op::Modified);
+  }
+
+  // Collapse chains (a -> b -> c) and round trips (a -> b -> a)
+  for (int i = 0; i < m_pendingRenames.size(); ++i) {
+    if (m_pendingRenames[i].second == from) {
+      if (m_pendingRenames[i].first == to)
+        m_pendingRenames.removeAt(i);
+      else
+        m_pendingRenames[i].second = to;
+      scheduleFlush();
+      return;
+    }
+  }
+
+  m_pendingRenames.append({from, to});
+  scheduleFlush();
+}
+
+void VaultWatcher::scheduleFlush() {
+  if (!m_batchAge.isValid())
+    m_batchAge.start();
+  // Each event extends the quiet period, but a long burst is still
+  // delivered in slices of at most kMaxLatencyMs
+  qint64 remaining = kMaxLatencyMs - m_batchAge.elapsed();
+  m_flushTimer->start(int(qBound<qint64>(0, remaining, kQuietMs)));
+}
+
+void VaultWatcher::flush() {
+  // Moves whose second half never arrived left the vault
+  const auto moves = std::exchange(m_moves, {});
+  for (auto it = moves.constBegin(); it != moves.constEnd(); ++it) {
+    if (it.value().second)
+      removeWatchTree(it.value().first);
+    record(it.value().first, Op::Removed);
+  }
+  m_flushTimer->stop();
+  m_batchAge.invalidate();
+
+  ChangeSet changes;
+  for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+    switch (it.value()) {
+    case Op::Added:
+      changes.added.append(it.key());
+      break;
+    case Op::Removed:
+      changes.removed.append(it.key());
+      break;
+    case Op::Modified:
+      changes.modified.append(it.key());
+      break;
+    }
+  }
+  changes.renamed = std::exchange(m_pendingRenames, {});
+  m_pending.clear();
+
+  if (!changes.isEmpty())
+    emit changed(changes);
+}
+
+// inotify backend
+
+bool VaultWatcher::startInotify() {
+#if defined(Q_OS_LINUX)
+  m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (m_inotifyFd < 0)
+    return false;
+
+  if (!addWatchTree(m_rootPath, false)) {
+    stopInotify();
+    return false;
+  }
+
+  m_notifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+  connect(m_notifier, &QSocketNotifier::activated, this,
+          &VaultWatcher::onInotifyReadable);
+  qDebug() << "VaultWatcher: inotify watching" << m_watchPaths.size()
+           << "directories under" << m_rootPath;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void VaultWatcher::stopInotify() {
+#if defined(Q_OS_LINUX)
+  delete m_notifier;
+  m_notifier = nullptr;
+  if (m_inotifyFd >= 0) {
+    ::close(m_inotifyFd); // drops every watch
+    m_inotifyFd = -1;
+  }
+#endif
+  m_watchPaths.clear();
+  m_watchDescriptors.clear();
+  m_moves.clear();
+}
+
+bool VaultWatcher::addWatchTree(const QString &dirPath, bool reportContents) {
+#if defined(Q_OS_LINUX)
+  constexpr uint32_t mask = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE |
+                            IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR |
+                            IN_DONT_FOLLOW | IN_EXCL_UNLINK;
+  bool ok = true;
+  auto watch = [this, &ok](const QString &dir) {
+    if (!ok)
+      return;
+    int wd = inotify_add_watch(m_inotifyFd, QFile::encodeName(dir).constData(),
+                               mask);
+    if (wd < 0) {
+      if (errno == ENOSPC)
+        ok = false; // fs.inotify.max_user_watches reached
+      return;       // otherwise the directory is already gone again
+    }
+    // Re-adding a known inode returns its existing descriptor
+    QString previous = m_watchPaths.value(wd);
+    if (!previous.isEmpty())
+      m_watchDescriptors.remove(previous);
+    m_watchPaths.insert(wd, dir);
+    m_watchDescriptors.insert(dir, wd);
+  };
+
+  watch(dirPath);
+  // Files created before the watch existed would otherwise be missed
+  int filters = reportContents ? VaultWalker::All : VaultWalker::Dirs;
+  VaultWalker::walk(dirPath, filters, [&](const VaultWalker::Entry &entry) {
+    if (entry.isDir && !entry.isSymLink)
+      watch(entry.path);
+    if (reportContents)
+      record(entry.path, Op::Added);
+  });
+
+  if (!ok)
+    qWarning() << "VaultWatcher: inotify watch limit reached for" << dirPath;
+  return ok;
+#else
+  Q_UNUSED(dirPath);
+  Q_UNUSED(reportContents);
+  return false;
+#endif
+}
+
+void VaultWatcher::removeWatchTree(const QString &dirPath) {
+  for (auto it = m_watchDescriptors.begin(); it != m_watchDescriptors.end();) {
+    if (it.key() == dirPath || isUnder(it.key(), dirPath)) {
+#if defined(Q_OS_LINUX)
+      inotify_rm_watch(m_inotifyFd, it.value());
+#endif
+      m_watchPaths.remove(it.value());
+      it = m_watchDescriptors.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void VaultWatcher::renameWatchTree(const QString &from, const QString &to) {
+  // Descriptors follow the inode; only the paths they map to change
+  QVector<QPair<QString, int>> moved;
+  for (auto it = m_watchDescriptors.begin(); it != m_watchDescriptors.end();) {
+    if (it.key() == from || isUnder(it.key(), from)) {
+      moved.append({to + it.key().mid(from.size()), it.value()});
+      it = m_watchDescriptors.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (const auto &entry : std::as_const(moved)) {
+    m_watchDescriptors.insert(entry.first, entry.second);
+    m_watchPaths.insert(entry.second, entry.first);
+  }
+}
+
+void VaultWatcher::onInotifyReadable() {
+#if defined(Q_OS_LINUX)
+  alignas(inotify_event) char buffer[16 * 1024];
+  bool overflow = false;
+  bool limitReached = false;
+
+  for (;;) {
+    ssize_t length = ::read(m_inotifyFd, buffer, sizeof(buffer));
+    if (length <= 0)
+      break; // EAGAIN: queue drained
+
+    for (char *p = buffer; p < buffer + length;) {
+      const auto *event = reinterpret_cast<const inotify_event *>(p);
+      p += sizeof(inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        overflow = true;
+        continue;
+      }
+      if (event->mask & IN_IGNORED) {
+        // Watched directory deleted or moved out; its descriptor is dead
+        QString dir = m_watchPaths.take(event->wd);
+        if (m_watchDescriptors.value(dir, -1) == event->wd)
+          m_watchDescriptors.remove(dir);
+        continue;
+      }
+      if (event->len == 0 || !m_watchPaths.contains(event->wd))
+        continue;
+
+      QString name = QFile::decodeName(event->name);
+      bool isDir = event->mask & IN_ISDIR;
+      if (!isReported(name))
+        continue;
+      QString path = m_watchPaths.value(event->wd) + QLatin1Char('/') + name;
+
+      if (event->mask & IN_MOVED_FROM) {
+        m_moves.insert(event->cookie, {path, isDir});
+      } else if (event->mask & IN_MOVED_TO) {
+        auto move = m_moves.find(event->cookie);
+        if (move != m_moves.end()) {
+          QString from = move.value().first;
+          m_moves.erase(move);
+          if (isDir)
+            renameWatchTree(from, path);
+          recordRename(from, path);
+        } else {
+          // Moved in from outside the vault
+          record(path, Op::Added);
+          if (isDir && !addWatchTree(path, true))
+            limitReached = true;
+        }
+      } else if (event->mask & IN_CREATE) {
+        record(path, Op::Added);
+        if (isDir && !addWatchTree(path, true))
+          limitReached = true;
+      } else if (event->mask & IN_DELETE) {
+        record(path, Op::Removed);
+      } else if (event->mask & IN_CLOSE_WRITE) {
+        record(path, Op::Modified);
+      }
+    }
+  }
+
+  if (limitReached) {
+    qWarning() << "VaultWatcher: falling back to polling";
+    stopInotify();
+    m_pending.clear();
+    m_pendingRenames.clear();
+    startPolling();
+    emit overflowed();
+  } else if (overflow) {
+    qWarning() << "VaultWatcher: inotify queue overflowed, events lost";
+    m_pending.clear();
+    m_pendingRenames.clear();
+    m_moves.clear();
+    emit overflowed();
+  }
+#endif
+}
+
+// ReadDirectoryChangesW backend
+
+bool VaultWatcher::startDirectoryWatch() {
+#if defined(Q_OS_WIN)
+  const std::wstring root = QDir::toNativeSeparators(m_rootPath).toStdWString();
+  HANDLE dir = CreateFileW(
+      root.c_str(), FILE_LIST_DIRECTORY,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+      OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+      nullptr);
+  if (dir == INVALID_HANDLE_VALUE)
+    return false;
+  HANDLE stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+  if (!stopEvent) {
+    CloseHandle(dir);
+    return false;
+  }
+
+  m_directoryHandle = dir;
+  m_directoryStop = stopEvent;
+  const int generation = ++m_directoryGeneration;
+  const QString rootPath = m_rootPath;
+  m_directoryThread =
+      QThread::create([this, rootPath, dir, stopEvent, generation]() {
+        watchDirectory(rootPath, dir, stopEvent, generation);
+      });
+  m_directoryThread->start();
+  qDebug() << "VaultWatcher: ReadDirectoryChangesW watching" << m_rootPath;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void VaultWatcher::stopDirectoryWatch() {
+  ++m_directoryGeneration; // results still queued are dropped
+#if defined(Q_OS_WIN)
+  if (m_directoryThread) {
+    SetEvent(m_directoryStop);
+    m_directoryThread->wait();
+    delete m_directoryThread;
+    m_directoryThread = nullptr;
+  }
+  if (m_directoryHandle)
+    CloseHandle(m_directoryHandle);
+  if (m_directoryStop)
+    CloseHandle(m_directoryStop);
+#endif
+  m_directoryHandle = nullptr;
+  m_directoryStop = nullptr;
+}
+
+void VaultWatcher::watchDirectory(const QString &rootPath, void *dirHandle,
+                                  void *stopEvent, int generation) {
+#if defined(Q_OS_WIN)
+  constexpr DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME |
+                           FILE_NOTIFY_CHANGE_DIR_NAME |
+                           FILE_NOTIFY_CHANGE_LAST_WRITE;
+  HANDLE dir = dirHandle;
+  OVERLAPPED overlapped = {};
+  overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+  // DWORD-aligned, as FILE_NOTIFY_INFORMATION requires; 64 KiB is also
+  // the most a network share will fill
+  std::vector<DWORD> buffer(16 * 1024);
+  const DWORD bufferBytes = DWORD(buffer.size() * sizeof(DWORD));
+
+  auto reported = [](const QString &relative) {
+    for (QStringView part : QStringView(relative).split(QLatin1Char('/'))) {
+      if (!isReported(part.toString()))
+        return false;
+    }
+    return true;
+  };
+  auto post = [this, generation](QVector<DirectoryEvent> events) {
+    QMetaObject::invokeMethod(
+        this,
+        [this, generation, events = std::move(events)]() {
+          applyDirectoryEvents(generation, events);
+        },
+        Qt::QueuedConnection);
+  };
+  auto lost = [this, generation](bool failed) {
+    QMetaObject::invokeMethod(
+        this,
+        [this, generation, failed]() {
+          onDirectoryWatchLost(generation, failed);
+        },
+        Qt::QueuedConnection);
+  };
+
+  bool failed = !overlapped.hEvent;
+  QString renameFrom; // old name of a rename whose new name comes next
+  bool renameFromReported = false;
+  while (!failed) {
+    ResetEvent(overlapped.hEvent);
+    if (!ReadDirectoryChangesW(dir, buffer.data(), bufferBytes, TRUE, filter,
+                               nullptr, &overlapped, nullptr)) {
+      failed = true;
+      break;
+    }
+
+    HANDLE handles[2] = {overlapped.hEvent, stopEvent};
+    DWORD bytes = 0;
+    if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) !=
+        WAIT_OBJECT_0) {
+      CancelIoEx(dir, &overlapped);
+      GetOverlappedResult(dir, &overlapped, &bytes, TRUE);
+      break; // stopped
+    }
+    if (!GetOverlappedResult(dir, &overlapped, &bytes, FALSE)) {
+      if (GetLastError() == ERROR_NOTIFY_ENUM_DIR) {
+        lost(false);
+        continue;
+      }
+      failed = true;
+      break;
+    }
+    if (bytes == 0) {
+      lost(false); // the kernel buffer overflowed, events were dropped
+      continue;
+    }
+
+    QVector<DirectoryEvent> events;
+    const char *p = reinterpret_cast<const char *>(buffer.data());
+    for (;;) {
+      const auto *info = reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(p);
+      QString relative = QString::fromWCharArray(
+          info->FileName, int(info->FileNameLength / sizeof(WCHAR)));
+      relative.replace(QLatin1Char('\\'), QLatin1Char('/'));
+      const QString path = rootPath + QLatin1Char('/') + relative;
+      const bool isReportedPath = reported(relative);
+
+      switch (info->Action) {
+      case FILE_ACTION_ADDED:
+        if (isReportedPath) {
+          events.append({Op::Added, path, {}});
+          // Contents of a directory moved in are not announced one by one
+          if (QFileInfo(path).isDir()) {
+            VaultWalker::walk(path, VaultWalker::All,
+                              [&events](const VaultWalker::Entry &entry) {
+                                events.append({Op::Added, entry.path, {}});
+                              });
+          }
+        }
+        break;
+      case FILE_ACTION_REMOVED:
+        if (isReportedPath)
+          events.append({Op::Removed, path, {}});
+        break;
+      case FILE_ACTION_MODIFIED:
+        // Directory times only echo changes already seen on their children
+        if (isReportedPath && !QFileInfo(path).isDir())
+          events.append({Op::Modified, path, {}});
+        break;
+      case FILE_ACTION_RENAMED_OLD_NAME:
+        renameFrom = path;
+        renameFromReported = isReportedPath;
+        break;
+      case FILE_ACTION_RENAMED_NEW_NAME:
+        if (renameFromReported && isReportedPath)
+          events.append({Op::Modified, renameFrom, path});
+        else if (renameFromReported)
+          events.append({Op::Removed, renameFrom, {}}); // now hidden
+        else if (isReportedPath)
+          events.append({Op::Added, path, {}}); // no longer hidden
+        renameFrom.clear();
+        break;
+      }
+
+      if (info->NextEntryOffset == 0)
+        break;
+      p += info->NextEntryOffset;
+    }
+    if (!events.isEmpty())
+      post(std::move(events));
+  }
+
+  if (overlapped.hEvent)
+    CloseHandle(overlapped.hEvent);
+  if (failed)
+    lost(true);
+#else
+  Q_UNUSED(rootPath);
+  Q_UNUSED(dirHandle);
+  Q_UNUSED(stopEvent);
+  Q_UNUSED(generation);
+#endif
+}
+
+void VaultWatcher::applyDirectoryEvents(
+    int generation, const QVector<DirectoryEvent> &events) {
+  if (generation != m_directoryGeneration)
+    return;
+  for (const DirectoryEvent &event : events) {
+    if (!event.to.isEmpty())
+      recordRename(event.path, event.to);
+    else
+      record(event.path, event.op);
+  }
+}
+
+void VaultWatcher::onDirectoryWatchLost(int generation, bool failed) {
+  if (generation != m_directoryGeneration)
+    return;
+  m_pending.clear();
+  m_pendingRenames.clear();
+  if (failed) {
+    // The volume cannot be watched (e.g. some network shares)
+    qWarning() << "VaultWatcher: ReadDirectoryChangesW failed, polling";
+    stopDirectoryWatch();
+    startPolling();
+  } else {
+    qWarning() << "VaultWatcher: change buffer overflowed, events lost";
+  }
+  emit overflowed();
+}
+
+// Polling backend
+
+void VaultWatcher::startPolling() {
+  qDebug() << "VaultWatcher: polling" << m_rootPath;
+  m_hasSnapshot = false;
+  poll();
+}
+
+void VaultWatcher::poll() {
+  if (m_rootPath.isEmpty() || m_pollWatcher->isRunning())
+    return;
+
+  QString rootPath = m_rootPath;
+  m_pollClock.start();
+  m_pollWatcher->setFuture(
+      QtConcurrent::run([rootPath]() { return takeSnapshot(rootPath); }));
+}
+
+void VaultWatcher::onPollFinished() {
+  if (m_rootPath.isEmpty() || m_inotifyFd >= 0 || m_directoryThread)
+    return;
+
+  qint64 walkMs = m_pollClock.elapsed();
+  Snapshot next = m_pollWatcher->result();
+  if (m_hasSnapshot)
+    diffSnapshot(next);
+  m_snapshot = std::move(next);
+  m_hasSnapshot = true;
+
+  // Keep polling below ~5% of one core however large the vault is
+  m_pollTimer->start(int(qBound<qint64>(kPollMinMs, walkMs * 20, kPollMaxMs)));
+}
+
+VaultWatcher::Snapshot VaultWatcher::takeSnapshot(const QString &rootPath) {
+  Snapshot snapshot;
+  VaultWalker::walk(rootPath, VaultWalker::All,
+                    [&snapshot](const VaultWalker::Entry &entry) {
+                      snapshot.insert(entry.path,
+                                      {entry.size, entry.mtimeMs, entry.isDir});
+                    });
+  return snapshot;
+}
+
+void VaultWatcher::diffSnapshot(const Snapshot &next) {
+  // Notes that vanished, keyed by (size, mtime) to recognise renames;
+  // an ambiguous stamp maps to an empty path and is never paired
+  QSet<QString> removedNotes;
+  QHash<QPair<qint64, qint64>, QString> removedByStamp;
+  for (auto it = m_snapshot.constBegin(); it != m_snapshot.constEnd(); ++it) {
+    if (next.contains(it.key()))
+      continue;
+    // Attachments carry no stamp to pair renames by
+    if (it.value().isDir || !isNotePath(it.key())) {
+      record(it.key(), Op::Removed);
+      continue;
+    }
+    removedNotes.insert(it.key());
+    QPair<qint64, qint64> stamp{it.value().size, it.value().mtimeMs};
+    removedByStamp.insert(stamp, removedByStamp.contains(stamp) ? QString()
+                                                                : it.key());
+  }
+
+  for (auto it = next.constBegin(); it != next.constEnd(); ++it) {
+    const Stamp &stamp = it.value();
+    auto previous = m_snapshot.constFind(it.key());
+    if (previous == m_snapshot.constEnd()) {
+      if (!stamp.isDir && isNotePath(it.key())) {
+        QString from = removedByStamp.take({stamp.size, stamp.mtimeMs});
+        if (!from.isEmpty()) {
+          removedNotes.remove(from);
+          recordRename(from, it.key());
+          continue;
+        }
+      }
+      record(it.key(), Op::Added);
+    } else if (!stamp.isDir && (previous.value().size != stamp.size ||
+                                previous.value().mtimeMs != stamp.mtimeMs)) {
+      // Directory mtimes only echo changes already seen on their children
+      record(it.key(), Op::Modified);
+    }
+  }
+
+  for (const QString &path : std::as_const(removedNotes))
+    record(path, Op::Removed);
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+class QSocketNotifier;
+class QThread;
+
+/**
+ * @brief Recursive watcher for the notes vault.
+ *
+ * Raw filesystem events are folded per path (create + delete cancels out,
+ * delete + create becomes a modification, rename chains collapse) and
+ * delivered as one ChangeSet once the vault has been quiet for a moment,
+ * so a git checkout or a sync client touching hundreds of files produces a
+ * handful of batches rather than hundreds of signals.
+ *
+ * Backends:
+ *  - Windows: ReadDirectoryChangesW on the root with bWatchSubtree, read
+ *    with overlapped I/O on a worker thread. Directories that appear
+ *    (moved in, say) have their existing contents reported as added.
+ *  - Linux: inotify, one watch per directory. New directories are watched
+ *    as they appear and their existing contents are reported as added.
+ *  - Last resort, when neither can watch the vault (an unsupported network
+ *    share, the inotify watch limit): a snapshot diff taken on a worker
+ *    thread with VaultWalker. The poll interval grows with the time a walk
+ *    takes, so large vaults are not polled flat out.
+ *
+ * Notes, attachments and directories are reported; hidden entries, which
+ * include the index cache, are ignored. Attachments are listed without
+ * stat data, so only their creation, removal and renaming show up.
+ */
+class VaultWatcher : public QObject {
+  Q_OBJECT
+
+public:
+  struct ChangeSet {
+    QStringList added;
+    QStringList removed;
+    QStringList modified;
+    QVector<QPair<QString, QString>> renamed; // from -> to
+
+    bool isEmpty() const {
+      return added.isEmpty() && removed.isEmpty() && modified.isEmpty() &&
+             renamed.isEmpty();
+    }
+  };
+
+  explicit VaultWatcher(QObject *parent = nullptr);
+  ~VaultWatcher() override;
+
+  /**
+   * @brief Starts watching @p rootPath recursively. A no-op if that root is
+   * already being watched.
+   */
+  void start(const QString &rootPath);
+  void stop();
+
+  bool isWatching() const { return !m_rootPath.isEmpty(); }
+  QString rootPath() const { return m_rootPath; }
+
+signals:
+  void changed(const VaultWatcher::ChangeSet &changes);
+  // Events were lost (kernel queue overflow); the owner should rescan
+  void overflowed();
+
+private slots:
+  void flush();
+  void poll();
+  void onPollFinished();
+  void onInotifyReadable();
+
+private:
+  enum class Op { Added, Removed, Modified };
+
+  struct Stamp {
+    qint64 size = 0;
+    qint64 mtimeMs = 0;
+    bool isDir = false;
+  };
+  using Snapshot = QHash<QString, Stamp>;
+
+  void record(const QString &path, Op op);
+  void recordRename(const QString &from, const QString &to);
+  void scheduleFlush();
+
+  bool startInotify();
+  void stopInotify();
+  bool addWatchTree(const QString &dirPath, bool reportContents);
+  void removeWatchTree(const QString &dirPath);
+  void renameWatchTree(const QString &from, const QString &to);
+
+  struct DirectoryEvent {
+    Op op = Op::Modified;
+    QString path;
+    QString to; // set for a rename from path
+  };
+  bool startDirectoryWatch();
+  void stopDirectoryWatch();
+  // Runs on m_directoryThread; hands results back through queued calls
+  void watchDirectory(const QString &rootPath, void *dirHandle,
+                      void *stopEvent, int generation);
+  void applyDirectoryEvents(int generation,
+                            const QVector<DirectoryEvent> &events);
+  void onDirectoryWatchLost(int generation, bool failed);
+
+  void startPolling();
+  static Snapshot takeSnapshot(const QString &rootPath);
+  void diffSnapshot(const Snapshot &next);
+
+  static bool isReported(const QString &name);
+  static bool isNotePath(const QString &path);
+
+  static constexpr int kQuietMs = 150;       // debounce after the last event
+  static constexpr int kMaxLatencyMs = 1000; // flush at least this often
+  static constexpr int kPollMinMs = 2000;
+  static constexpr int kPollMaxMs = 30000;
+
+  QString m_rootPath;
+
+  // Coalesced events of the current batch
+  QHash<QString, Op> m_pending;
+  QVector<QPair<QString, QString>> m_pendingRenames;
+  QTimer *m_flushTimer = nullptr;
+  QElapsedTimer m_batchAge;
+
+  // inotify backend
+  int m_inotifyFd = -1;
+  QSocketNotifier *m_notifier = nullptr;
+  QHash<int, QString> m_watchPaths;       // wd -> directory
+  QHash<QString, int> m_watchDescriptors; // directory -> wd
+  QHash<quint32, QPair<QString, bool>> m_moves; // cookie -> (from, isDir)
+
+  // ReadDirectoryChangesW backend
+  QThread *m_directoryThread = nullptr;
+  void *m_directoryHandle = nullptr; // HANDLE of the root directory
+  void *m_directoryStop = nullptr;   // event that ends the worker
+  int m_directoryGeneration = 0;     // drops results of a stopped watch
+
+  // Polling backend
+  QTimer *m_pollTimer = nullptr;
+  QFutureWatcher<Snapshot> *m_pollWatcher = nullptr;
+  QElapsedTimer m_pollClock;
+  Snapshot m_snapshot;
+  bool m_hasSnapshot = false;
+};
+
+Q_DECLARE_METATYPE(VaultWatcher::ChangeSet)
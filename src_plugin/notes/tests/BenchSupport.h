@@ -0,0 +1,265 @@
+#pragma once
+
+// Shared by the notes benchmarks: a CHECK macro counting failures, timing
+// helpers, waiting on signals, counting model row signals, and a
+// deterministic synthetic vault.
+// Benchmarks print their numbers and only fail on wrong answers.
+
+#include <QAbstractItemModel>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QTimeZone>
+#include <QTimer>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+namespace Bench {
+
+inline int failures = 0;
+
+/** @brief Drops qDebug() output unless the benchmark got --verbose. */
+inline void quietDebugOutput() {
+  if (QCoreApplication::arguments().contains(QStringLiteral("--verbose")))
+    return;
+  qInstallMessageHandler([](QtMsgType type, const QMessageLogContext &,
+                            const QString &message) {
+    if (type != QtDebugMsg && type != QtInfoMsg)
+      std::fprintf(stderr, "%s\n", qPrintable(message));
+  });
+}
+
+/** @brief Value of --name=N on the command line, or @p fallback. */
+inline int intArg(const QString &name, int fallback) {
+  const QString prefix = QStringLiteral("--") + name + QLatin1Char('=');
+  for (const QString &arg : QCoreApplication::arguments()) {
+    if (arg.startsWith(prefix)) {
+      bool ok = false;
+      int value = arg.mid(prefix.size()).toInt(&ok);
+      if (ok && value > 0)
+        return value;
+    }
+  }
+  return fallback;
+}
+
+struct Timing {
+  double medianUs = 0;
+  double maxUs = 0;
+};
+
+/** @brief Runs @p fn @p runs times; median and worst run in microseconds. */
+template <typename Fn> Timing measure(int runs, Fn &&fn) {
+  std::vector<double> samples;
+  samples.reserve(runs);
+  QElapsedTimer timer;
+  for (int i = 0; i < runs; ++i) {
+    timer.start();
+    fn(i);
+    samples.push_back(timer.nsecsElapsed() / 1000.0);
+  }
+  std::sort(samples.begin(), samples.end());
+  return {samples[samples.size() / 2], samples.back()};
+}
+
+/**
+ * @brief Spins the event loop until @p sender emits @p signal.
+ * @return False on timeout.
+ */
+template <typename Sender, typename Signal>
+bool waitForSignal(Sender *sender, Signal signal, int timeoutMs = 120000) {
+  QEventLoop loop;
+  QTimer timeout;
+  timeout.setSingleShot(true);
+  QObject::connect(&timeout, &QTimer::timeout, &loop, &QEventLoop::quit);
+  QObject::connect(sender, signal, &loop, &QEventLoop::quit);
+  timeout.start(timeoutMs);
+  loop.exec();
+  return timeout.isActive();
+}
+
+/** @brief Spins the event loop until @p done returns true. */
+inline bool waitUntil(const std::function<bool()> &done,
+                      int timeoutMs = 120000) {
+  QElapsedTimer timer;
+  timer.start();
+  while (!done()) {
+    if (timer.elapsed() > timeoutMs)
+      return false;
+    QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    QThread::msleep(1);
+  }
+  return true;
+}
+
+// Rows touched by model signals since the last reset()
+struct Churn {
+  int inserted = 0;
+  int removed = 0;
+  int moved = 0;
+  int changed = 0;
+  int resets = 0;
+
+  void watch(const QAbstractItemModel &model) {
+    QObject::connect(&model, &QAbstractItemModel::rowsInserted,
+                     [this](const QModelIndex &, int first, int last) {
+                       inserted += last - first + 1;
+                     });
+    QObject::connect(&model, &QAbstractItemModel::rowsRemoved,
+                     [this](const QModelIndex &, int first, int last) {
+                       removed += last - first + 1;
+                     });
+    QObject::connect(&model, &QAbstractItemModel::rowsMoved,
+                     [this](const QModelIndex &, int first, int last,
+                            const QModelIndex &, int) {
+                       moved += last - first + 1;
+                     });
+    QObject::connect(&model, &QAbstractItemModel::dataChanged,
+                     [this](const QModelIndex &topLeft,
+                            const QModelIndex &bottomRight) {
+                       changed += bottomRight.row() - topLeft.row() + 1;
+                     });
+    QObject::connect(&model, &QAbstractItemModel::modelReset,
+                     [this]() { ++resets; });
+  }
+  void reset() { *this = Churn{}; }
+};
+
+inline const QStringList &words() {
+  static const QStringList list = {
+      QStringLiteral("meeting"),  QStringLiteral("notes"),
+      QStringLiteral("project"),  QStringLiteral("alpha"),
+      QStringLiteral("budget"),   QStringLiteral("review"),
+      QStringLiteral("design"),   QStringLiteral("roadmap"),
+      QStringLiteral("journal"),  QStringLiteral("recipe"),
+      QStringLiteral("travel"),   QStringLiteral("reading"),
+      QStringLiteral("research"), QStringLiteral("ideas"),
+      QStringLiteral("weekly"),   QStringLiteral("planning"),
+      QStringLiteral("garden"),   QStringLiteral("invoice"),
+      QStringLiteral("draft"),    QStringLiteral("summary"),
+      QStringLiteral("café"),     QStringLiteral("kubernetes"),
+      QStringLiteral("tangent"),  QStringLiteral("retro")};
+  return list;
+}
+
+/** @brief Title of synthetic note @p i: two words and the number. */
+inline QString noteTitle(int i) {
+  const QStringList &w = words();
+  return w[i % w.size()] + QLatin1Char(' ') + w[(i / w.size()) % w.size()] +
+         QLatin1Char(' ') + QString::number(i);
+}
+
+/** @brief Tags of synthetic note @p i, nested ones included. */
+inline QStringList noteTags(int i) {
+  QStringList tags{QStringLiteral("area/") + words()[i % 5]};
+  if (i % 3 == 0)
+    tags << QStringLiteral("project/") + words()[i % 7];
+  if (i % 11 == 0)
+    tags << QStringLiteral("review");
+  return tags;
+}
+
+struct VaultOptions {
+  int notes = 1000;
+  // Notes are spread round-robin over this many top-level folders, each
+  // with a subfolder; 0 puts every note in the root
+  int folders = 10;
+  int paragraphs = 8; // body size; 0 writes frontmatter only
+};
+
+// Every note is an hour older than the one before it
+inline qint64 noteMtimeMs(int i) {
+  return QDateTime(QDate(2025, 1, 1), QTime(0, 0), QTimeZone::UTC)
+             .toMSecsSinceEpoch() -
+         qint64(i) * 3600 * 1000;
+}
+
+/**
+ * @brief Writes a deterministic vault under @p root. Every 25th note is
+ * pinned, every 7th has an open task, every 10th an alias; bodies have a
+ * heading, [[links]] to neighbouring notes and a ^block-id.
+ * @return The note paths, in note order.
+ */
+inline QStringList writeVault(const QString &root,
+                              const VaultOptions &options) {
+  QDir().mkpath(root);
+  QStringList folders;
+  for (int f = 0; f < options.folders; ++f) {
+    const QString folder = root + QStringLiteral("/folder %1").arg(f);
+    QDir().mkpath(folder + QStringLiteral("/archive"));
+    folders << folder << folder + QStringLiteral("/archive");
+  }
+
+  QStringList paths;
+  paths.reserve(options.notes);
+  for (int i = 0; i < options.notes; ++i) {
+    const QString dir = folders.isEmpty() ? root : folders[i % folders.size()];
+    const QString path = dir + QLatin1Char('/') + noteTitle(i) +
+                         QStringLiteral(".md");
+
+    QByteArray text = "---\ntags: [" + noteTags(i).join(", ").toUtf8() + "]\n";
+    if (i % 25 == 0)
+      text += "pinned: true\n";
+    if (i % 10 == 0)
+      text += "aliases: [alias " + QByteArray::number(i) + "]\n";
+    text += "color: \"#3366cc\"\n---\n\n";
+    if (options.paragraphs > 0) {
+      text += "# " + noteTitle(i).toUtf8() + "\n\n";
+      for (int p = 0; p < options.paragraphs; ++p) {
+        const QStringList &w = words();
+        text += w[(i + p) % w.size()].toUtf8() + " " +
+                w[(i * 7 + p) % w.size()].toUtf8() +
+                " lorem ipsum dolor sit amet, see [[" +
+                noteTitle((i + p + 1) % options.notes).toUtf8() +
+                "]] for the details of item " + QByteArray::number(p) +
+                ".\n\n";
+      }
+      if (i % 7 == 0)
+        text += "- [ ] follow up on " + QByteArray::number(i) + "\n";
+      text += "- [x] done\n\nClosing line ^block" + QByteArray::number(i) +
+              "\n";
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+      continue;
+    file.write(text);
+    file.flush(); // or closing would stamp the time again
+    file.setFileTime(QDateTime::fromMSecsSinceEpoch(noteMtimeMs(i),
+                                                    QTimeZone::UTC),
+                     QFileDevice::FileModificationTime);
+    file.close();
+    paths << path;
+  }
+  return paths;
+}
+
+/** @brief Prints the verdict; the return value is main()'s. */
+inline int finish(const char *name) {
+  if (failures) {
+    std::fprintf(stderr, "%d check(s) failed\n", failures);
+    return EXIT_FAILURE;
+  }
+  std::printf("%s: all checks passed\n", name);
+  return EXIT_SUCCESS;
+}
+
+} // namespace Bench
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__,    \
+                   #cond);                                                     \
+      ++Bench::failures;                                                       \
+    }                                                                          \
+  } while (0)
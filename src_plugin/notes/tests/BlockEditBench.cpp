@@ -0,0 +1,111 @@
+// Times typing into one block of a 10,000-line note: NoteBlockModel's
+// replaceBlock() per keystroke against a full MarkdownParser pass over the
+// note, which is what every keystroke used to cost. A keystroke in a
+// paragraph must change that one row only; a keystroke that opens a code
+// fence may reach further but must end where a fresh parse would.
+// --lines=N sets the note length.
+#include "BenchSupport.h"
+#include "MarkdownParser.h"
+#include "NoteBlockModel.h"
+
+// Headings, paragraphs, lists, code and quotes, 21 lines a section
+static QString longNote(int lines) {
+  QString text;
+  for (int s = 0, written = 0; written < lines; ++s) {
+    text += QStringLiteral("## Section %1\n\n").arg(s);
+    for (int p = 0; p < 4; ++p)
+      text += QStringLiteral("Paragraph %1.%2: lorem ipsum dolor sit amet, "
+                             "consectetur adipiscing elit.\n\n")
+                  .arg(s)
+                  .arg(p);
+    text += QStringLiteral("- first item\n- second item\n- [ ] task %1\n\n")
+                .arg(s);
+    text += QStringLiteral("```cpp\nint x = %1;\nreturn x;\n```\n\n").arg(s);
+    text += QStringLiteral("> quoted %1\n\n").arg(s);
+    written += 21;
+  }
+  return text;
+}
+
+static QString rowText(const NoteBlockModel &model, int row, int role) {
+  return model.data(model.index(row), role).toString();
+}
+
+// Whether @p model shows the blocks a fresh load of its markdown shows
+static bool matchesFreshParse(const NoteBlockModel &model) {
+  NoteBlockModel fresh;
+  fresh.loadMarkdown(model.getMarkdown());
+  if (!Bench::waitUntil([&fresh]() { return !fresh.loading(); }) ||
+      fresh.rowCount() != model.rowCount())
+    return false;
+  for (int row = 0; row < model.rowCount(); ++row) {
+    for (int role : {NoteBlockModel::TypeRole, NoteBlockModel::ContentRole}) {
+      if (rowText(fresh, row, role) != rowText(model, row, role))
+        return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  QCoreApplication app(argc, argv);
+  Bench::quietDebugOutput();
+
+  const QString note = longNote(Bench::intArg(QStringLiteral("lines"), 10000));
+  NoteBlockModel model;
+  model.loadMarkdown(note);
+  CHECK(Bench::waitUntil([&model]() { return !model.loading(); }));
+  const int rows = model.rowCount();
+  CHECK(rows > 0);
+
+  // A paragraph in the middle of the note
+  int row = rows / 2;
+  while (row < rows &&
+         rowText(model, row, NoteBlockModel::TypeRole) !=
+             QLatin1String("paragraph"))
+    ++row;
+  CHECK(row < rows);
+  const QString original = rowText(model, row, NoteBlockModel::ContentRole);
+
+  const Bench::Timing full =
+      Bench::measure(5, [&](int) { MarkdownParser::parse(note); });
+  std::printf("%lld lines, %d blocks:\n",
+              qlonglong(note.count(QLatin1Char('\n'))), rows);
+  std::printf("  %-22s %8.1f us (worst %8.1f)\n", "full parse",
+              full.medianUs, full.maxUs);
+
+  Bench::Churn churn;
+  churn.watch(model);
+
+  // Typing at the end of the paragraph, one character per keystroke
+  const QString typed =
+      QStringLiteral(" and then some more words typed one at a time");
+  const int keys = int(typed.size());
+  Bench::Timing t = Bench::measure(keys, [&](int i) {
+    model.replaceBlock(row, original + typed.left(i + 1));
+  });
+  CHECK(churn.resets == 0 && churn.inserted == 0 && churn.removed == 0);
+  CHECK(churn.changed == keys);
+  CHECK(model.rowCount() == rows);
+  CHECK(rowText(model, row, NoteBlockModel::ContentRole) == original + typed);
+  std::printf("  %-22s %8.1f us (worst %8.1f), %.1f rows changed each\n",
+              "paragraph keystroke", t.medianUs, t.maxUs,
+              double(churn.changed) / keys);
+
+  // An unclosed fence flips every fence after it, down to the note end;
+  // closing it again must restore every row
+  churn.reset();
+  t = Bench::measure(2, [&](int i) {
+    model.replaceBlock(row, i == 0 ? QStringLiteral("```\n") + original
+                                   : original);
+  });
+  CHECK(churn.resets == 0);
+  CHECK(model.rowCount() == rows);
+  CHECK(rowText(model, row, NoteBlockModel::ContentRole) == original);
+  std::printf("  %-22s %8.1f us (worst %8.1f), %d rows touched\n",
+              "fence open / close", t.medianUs, t.maxUs,
+              churn.changed + churn.inserted + churn.removed);
+
+  CHECK(matchesFreshParse(model));
+  return Bench::finish("BlockEdit");
+}
@@ -0,0 +1,76 @@
+// Times listing a folder of 10,000 notes and 20 subfolders from the
+// index's folder tree, against listing the same folder from disk, and
+// checks that the children stay sorted (pinned, folders, newest first)
+// when a note is pinned. --notes=N sets the folder size.
+#include "BenchSupport.h"
+#include "NotesIndex.h"
+#include "VaultWalker.h"
+#include <QTemporaryDir>
+
+static bool isSorted(const QVector<NoteMetadata> &items) {
+  return std::is_sorted(items.begin(), items.end(),
+                        [](const NoteMetadata &a, const NoteMetadata &b) {
+                          if (a.isPinned != b.isPinned)
+                            return a.isPinned > b.isPinned;
+                          if (a.isFolder != b.isFolder)
+                            return a.isFolder > b.isFolder;
+                          return a.lastModified > b.lastModified;
+                        });
+}
+
+int main(int argc, char **argv) {
+  QCoreApplication app(argc, argv);
+  Bench::quietDebugOutput();
+
+  QTemporaryDir dir;
+  CHECK(dir.isValid());
+  Bench::VaultOptions options;
+  options.notes = Bench::intArg(QStringLiteral("notes"), 10000);
+  options.folders = 0;
+  options.paragraphs = 1;
+  const QString root = NotesIndex::normalizePath(dir.path());
+  const QStringList paths = Bench::writeVault(root, options);
+  const int folders = 20;
+  for (int f = 0; f < folders; ++f)
+    QDir(root).mkdir(QStringLiteral("sub %1").arg(f));
+
+  NotesIndex index;
+  index.setRootPath(root);
+  CHECK(Bench::waitForSignal(&index, &NotesIndex::indexReady));
+
+  QVector<NoteMetadata> items;
+  const Bench::Timing tree = Bench::measure(
+      50, [&](int) { items = index.getItemsInFolder(root); });
+  CHECK(items.size() == paths.size() + folders);
+  CHECK(isSorted(items));
+  CHECK(!items.isEmpty() && items.first().isPinned);
+
+  // What a listing costs when it has to go to disk (names and stats only)
+  int listed = 0;
+  const Bench::Timing disk = Bench::measure(10, [&](int) {
+    listed = 0;
+    VaultWalker::listDirectory(root, VaultWalker::Notes | VaultWalker::Dirs,
+                               [&](const VaultWalker::Entry &) { ++listed; });
+  });
+  CHECK(listed == items.size());
+
+  // Pinning the oldest note must move it into the pinned group, in order
+  const QString oldest = paths.last();
+  QFile file(oldest);
+  CHECK(file.open(QIODevice::WriteOnly));
+  file.write("---\npinned: true\n---\n\nnow pinned\n");
+  file.close();
+  const Bench::Timing update =
+      Bench::measure(1, [&](int) { index.updateEntry(oldest); });
+  items = index.getItemsInFolder(root);
+  CHECK(isSorted(items));
+  CHECK(std::any_of(items.begin(), items.end(), [&](const NoteMetadata &m) {
+    return m.filePath == oldest && m.isPinned;
+  }));
+
+  std::printf("%d items: tree listing %8.1f us (worst %.1f), disk listing "
+              "%8.1f us, pin update %.1f us\n",
+              int(items.size()), tree.medianUs, tree.maxUs, disk.medianUs,
+              update.medianUs);
+  return Bench::finish("FolderListing");
+}
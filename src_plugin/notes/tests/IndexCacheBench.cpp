@@ -0,0 +1,60 @@
+// Times opening a vault with and without NotesIndexCache: the cold open
+// parses every note and writes the cache, the warm opens reuse it. The OS
+// file cache is not dropped between runs, so "cold" means a cold index, not
+// a cold disk. --notes=N sets the vault size (default 10,000).
+#include "BenchSupport.h"
+#include "NotesIndex.h"
+#include "NotesIndexCache.h"
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+// Opens @p root with a fresh index and returns the milliseconds until
+// indexReady; the index is destroyed afterwards, which flushes its cache
+static double openVault(const QString &root, int *notes) {
+  NotesIndex index;
+  QElapsedTimer timer;
+  timer.start();
+  index.setRootPath(root);
+  CHECK(Bench::waitForSignal(&index, &NotesIndex::indexReady));
+  double ms = timer.nsecsElapsed() / 1e6;
+  *notes = index.totalFiles();
+  return ms;
+}
+
+int main(int argc, char **argv) {
+  QCoreApplication app(argc, argv);
+  Bench::quietDebugOutput();
+
+  QTemporaryDir dir;
+  CHECK(dir.isValid());
+  Bench::VaultOptions options;
+  options.notes = Bench::intArg(QStringLiteral("notes"), 10000);
+  const QString root = NotesIndex::normalizePath(dir.path());
+  const int written = Bench::writeVault(root, options).size();
+  CHECK(written == options.notes);
+
+  int coldNotes = 0;
+  const double coldMs = openVault(root, &coldNotes);
+  CHECK(coldNotes == written);
+  CHECK(QFileInfo::exists(NotesIndexCache::cachePath(root)));
+
+  QElapsedTimer timer;
+  timer.start();
+  NotesIndexCache cache;
+  CHECK(cache.open(root));
+  const double mapMs = timer.nsecsElapsed() / 1e6;
+  CHECK(cache.count() == written);
+  cache.close();
+
+  const Bench::Timing warm = Bench::measure(3, [&](int) {
+    int warmNotes = 0;
+    openVault(root, &warmNotes);
+    CHECK(warmNotes == written);
+  });
+
+  std::printf("%d notes: cold open %8.1f ms, warm open %8.1f ms "
+              "(worst %.1f), cache map %.2f ms\n",
+              written, coldMs, warm.medianUs / 1000, warm.maxUs / 1000, mapMs);
+  return Bench::finish("IndexCache");
+}
@@ -0,0 +1,103 @@
+// Times NotesModel refreshes of a 5,000-note folder and counts the row
+// signals they emit, i.e. the delegates a ListView has to create, destroy
+// or move. Editing, pinning, adding or deleting one note must touch one
+// row, never reset the model. --notes=N sets the folder size.
+#include "BenchSupport.h"
+#include "NotesIndex.h"
+#include "NotesModel.h"
+#include <QTemporaryDir>
+
+static void rewrite(const QString &path, const QByteArray &text) {
+  QFile file(path);
+  CHECK(file.open(QIODevice::WriteOnly));
+  file.write(text);
+}
+
+static int rowOf(const NotesModel &model, const QString &path) {
+  for (int row = 0; row < model.rowCount(); ++row) {
+    if (model.data(model.index(row), NotesModel::PathRole).toString() == path)
+      return row;
+  }
+  return -1;
+}
+
+int main(int argc, char **argv) {
+  QCoreApplication app(argc, argv);
+  Bench::quietDebugOutput();
+
+  QTemporaryDir dir;
+  CHECK(dir.isValid());
+  Bench::VaultOptions options;
+  options.notes = Bench::intArg(QStringLiteral("notes"), 5000);
+  options.folders = 0;
+  options.paragraphs = 1;
+  const QString root = NotesIndex::normalizePath(dir.path());
+  const QStringList paths = Bench::writeVault(root, options);
+
+  NotesIndex *index = NotesIndex::instance();
+  NotesModel model;
+  model.setRootPath(root);
+  CHECK(Bench::waitForSignal(index, &NotesIndex::indexReady));
+  CHECK(model.rowCount() == paths.size());
+
+  Bench::Churn churn;
+  churn.watch(model);
+  auto report = [&](const char *what, const Bench::Timing &t, int runs) {
+    std::printf("  %-16s %8.1f us (worst %8.1f): per update %.1f inserted, "
+                "%.1f removed, %.1f moved, %.1f changed, %d resets\n",
+                what, t.medianUs, t.maxUs, double(churn.inserted) / runs,
+                double(churn.removed) / runs, double(churn.moved) / runs,
+                double(churn.changed) / runs, churn.resets);
+  };
+  std::printf("%d rows:\n", model.rowCount());
+
+  // Nothing changed: the diff alone
+  const int runs = 20;
+  Bench::Timing t = Bench::measure(runs, [&](int) { model.refresh(); });
+  CHECK(churn.inserted + churn.removed + churn.moved + churn.changed == 0);
+  report("unchanged", t, runs);
+
+  // Edits make a note the newest: it moves to the top of the unpinned rows
+  churn.reset();
+  t = Bench::measure(runs, [&](int i) {
+    const QString &path = paths[paths.size() / 2 + i];
+    rewrite(path, "edited " + QByteArray::number(i) + "\n");
+    index->updateEntry(path);
+  });
+  CHECK(churn.resets == 0 && churn.inserted == 0 && churn.removed == 0);
+  CHECK(churn.moved <= runs);
+  report("edit", t, runs);
+
+  churn.reset();
+  t = Bench::measure(runs, [&](int i) {
+    const QString &path = paths[paths.size() - 1 - i];
+    rewrite(path, "---\npinned: true\n---\n\npinned\n");
+    index->updateEntry(path);
+  });
+  CHECK(churn.resets == 0 && churn.inserted == 0 && churn.removed == 0);
+  CHECK(churn.moved <= runs);
+  CHECK(rowOf(model, paths.last()) < rowOf(model, paths[1]));
+  report("pin", t, runs);
+
+  churn.reset();
+  t = Bench::measure(runs, [&](int i) {
+    const QString path = root + QStringLiteral("/new %1.md").arg(i);
+    rewrite(path, "new\n");
+    index->updateEntry(path);
+  });
+  CHECK(churn.resets == 0 && churn.inserted == runs && churn.removed == 0);
+  CHECK(model.rowCount() == paths.size() + runs);
+  report("add", t, runs);
+
+  churn.reset();
+  t = Bench::measure(runs, [&](int i) {
+    const QString &path = paths[i + 1];
+    QFile::remove(path);
+    index->removeEntry(path);
+  });
+  CHECK(churn.resets == 0 && churn.removed == runs && churn.inserted == 0);
+  CHECK(model.rowCount() == paths.size());
+  report("delete", t, runs);
+
+  return Bench::finish("ModelUpdate");
+}
@@ -0,0 +1,109 @@
+// Times compound NoteQuery searches on a 20,000-note vault: planning the
+// candidates from the index alone, and NotesModel.query end to end (with
+// the text verified off the GUI thread when the query needs it). Answers
+// are checked against the synthetic vault's known tags, tasks and dates.
+// --notes=N sets the vault size.
+#include "BenchSupport.h"
+#include "NoteQuery.h"
+#include "NotesIndex.h"
+#include "NotesModel.h"
+#include "NotesStore.h"
+#include <QTemporaryDir>
+
+struct Case {
+  QString query;
+  std::function<bool(int)> expected; // for note i; null if not checked
+};
+
+int main(int argc, char **argv) {
+  QCoreApplication app(argc, argv);
+  Bench::quietDebugOutput();
+
+  QTemporaryDir dir;
+  CHECK(dir.isValid());
+  Bench::VaultOptions options;
+  options.notes = Bench::intArg(QStringLiteral("notes"), 20000);
+  options.paragraphs = 4;
+  const QString root = NotesIndex::normalizePath(dir.path());
+  Bench::writeVault(root, options);
+
+  NotesIndex *index = NotesIndex::instance();
+  NotesModel model;
+  model.setRootPath(root);
+  CHECK(Bench::waitForSignal(index, &NotesIndex::indexReady));
+  CHECK(Bench::waitUntil([index]() { return index->isContentIndexReady(); }));
+
+  // Notes go round-robin into "folder f" and "folder f/archive"
+  const int dirs = options.folders * 2;
+  const qint64 afterDec1 =
+      QDate(2024, 12, 2).startOfDay().toMSecsSinceEpoch();
+  const QString meetingKey = NotesStore::searchKey(QStringLiteral("meeting"));
+  auto tagged = [](int i, const char *tag) {
+    return Bench::noteTags(i).contains(QLatin1String(tag));
+  };
+
+  const QVector<Case> cases = {
+      {QStringLiteral("tag:area/meeting has:task"),
+       [&](int i) { return tagged(i, "area/meeting") && i % 7 == 0; }},
+      {QStringLiteral("path:\"folder 3/\" OR tag:review"),
+       [&](int i) { return (i % dirs) / 2 == 3 || tagged(i, "review"); }},
+      {QStringLiteral("title:meeting -tag:review"),
+       [&](int i) {
+         return NotesStore::searchKey(Bench::noteTitle(i))
+                    .contains(meetingKey) &&
+                !tagged(i, "review");
+       }},
+      {QStringLiteral("modified:>2024-12-01 (tag:review OR has:task)"),
+       [&](int i) {
+         return Bench::noteMtimeMs(i) >= afterDec1 &&
+                (tagged(i, "review") || i % 7 == 0);
+       }},
+      {QStringLiteral("\"lorem ipsum\" tag:project/alpha"),
+       [&](int i) { return tagged(i, "project/alpha"); }},
+      {QStringLiteral("kubernetes retro NOT path:\"folder 0/\""), nullptr},
+      {QStringLiteral("zzqx OR (tag:nothing has:task)"),
+       [](int) { return false; }}};
+
+  std::printf("%d notes, per query (median / worst):\n", options.notes);
+  for (const Case &c : cases) {
+    const NoteQuery query = NoteQuery::parse(c.query, root);
+    QVector<NoteMetadata> candidates;
+    const Bench::Timing plan = Bench::measure(
+        9, [&](int) { candidates = index->queryCandidates(query); });
+
+    int expected = -1;
+    if (c.expected) {
+      expected = 0;
+      for (int i = 0; i < options.notes; ++i)
+        expected += c.expected(i) ? 1 : 0;
+      // Exact from the index, or narrowed to notes all holding the text
+      CHECK(candidates.size() == expected);
+    } else {
+      CHECK(!candidates.isEmpty() && candidates.size() < options.notes);
+    }
+
+    // The model as the search field drives it, from the folder view
+    std::vector<double> modelUs;
+    QElapsedTimer timer;
+    for (int run = 0; run < 5; ++run) {
+      model.setQuery(QString());
+      timer.start();
+      model.setQuery(c.query);
+      CHECK(Bench::waitUntil([&model]() { return !model.loading(); }));
+      modelUs.push_back(timer.nsecsElapsed() / 1000.0);
+    }
+    std::sort(modelUs.begin(), modelUs.end());
+    // Text searches stop at maxSearchResults hits
+    if (expected >= 0)
+      CHECK(model.rowCount() ==
+            (query.needsText() ? qMin(expected, model.maxSearchResults())
+                               : expected));
+
+    std::printf("  %-48s %6d hits  plan %8.1f / %8.1f us, "
+                "model %9.1f / %9.1f us%s\n",
+                qPrintable(c.query), int(candidates.size()), plan.medianUs,
+                plan.maxUs, modelUs[modelUs.size() / 2], modelUs.back(),
+                query.needsText() ? " (text verified)" : "");
+  }
+  return Bench::finish("Query");
+}
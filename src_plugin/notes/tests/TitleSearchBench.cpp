@@ -0,0 +1,77 @@
+// Times title search per keystroke on 100,000 titles: the ranked index
+// search alone, and NotesModel.filterString end to end (search plus row
+// updates). Each phrase is typed one character at a time; the worst
+// keystroke is what a user feels. --notes=N sets the vault size.
+#include "BenchSupport.h"
+#include "NotesIndex.h"
+#include "NotesModel.h"
+#include <QTemporaryDir>
+
+static bool titleContains(const QVector<NoteMetadata> &results,
+                          const QString &text) {
+  return !results.isEmpty() &&
+         results.first().title.contains(text, Qt::CaseInsensitive);
+}
+
+int main(int argc, char **argv) {
+  QCoreApplication app(argc, argv);
+  Bench::quietDebugOutput();
+
+  QTemporaryDir dir;
+  CHECK(dir.isValid());
+  Bench::VaultOptions options;
+  options.notes = Bench::intArg(QStringLiteral("notes"), 100000);
+  options.paragraphs = 0;
+  const QString root = NotesIndex::normalizePath(dir.path());
+  Bench::writeVault(root, options);
+
+  NotesIndex *index = NotesIndex::instance();
+  NotesModel model;
+  model.setRootPath(root);
+  CHECK(Bench::waitForSignal(index, &NotesIndex::indexReady));
+  CHECK(index->totalFiles() == options.notes);
+
+  // Prefix typing, a folded diacritic, two words, a sparse subsequence
+  const QStringList phrases = {
+      QStringLiteral("meeting"), QStringLiteral("cafe"),
+      QStringLiteral("kubernetes retro"), QStringLiteral("rdmp")};
+
+  CHECK(titleContains(index->searchByTitle(QStringLiteral("meeting")),
+                      QStringLiteral("meeting")));
+  CHECK(titleContains(index->searchByTitle(QStringLiteral("cafe")),
+                      QStringLiteral("café")));
+  CHECK(titleContains(index->searchByTitle(QStringLiteral("kubernetes retro")),
+                      QStringLiteral("kubernetes retro")));
+  CHECK(!index->searchByTitle(QStringLiteral("rdmp")).isEmpty());
+  CHECK(index->searchByTitle(QStringLiteral("zzzzqx")).isEmpty());
+
+  std::printf("%d titles, per keystroke (typical / worst):\n", options.notes);
+  for (const QString &phrase : phrases) {
+    double searchWorst = 0, searchSum = 0;
+    for (int n = 1; n <= phrase.size(); ++n) {
+      const QString typed = phrase.left(n);
+      const Bench::Timing t =
+          Bench::measure(5, [&](int) { index->searchByTitle(typed); });
+      searchSum += t.medianUs;
+      searchWorst = qMax(searchWorst, t.medianUs);
+    }
+
+    // The model as the search field drives it, one keystroke at a time
+    std::vector<double> modelUs;
+    QElapsedTimer timer;
+    for (int n = 1; n <= phrase.size(); ++n) {
+      timer.start();
+      model.setFilterString(phrase.left(n));
+      modelUs.push_back(timer.nsecsElapsed() / 1000.0);
+    }
+    CHECK(model.rowCount() > 0);
+    model.setFilterString(QString());
+    std::sort(modelUs.begin(), modelUs.end());
+
+    std::printf("  %-18s search %8.1f / %8.1f us, model %8.1f / %8.1f us\n",
+                qPrintable(QLatin1Char('"') + phrase + QLatin1Char('"')),
+                searchSum / phrase.size(), searchWorst,
+                modelUs[modelUs.size() / 2], modelUs.back());
+  }
+  return Bench::finish("TitleSearch");
+}
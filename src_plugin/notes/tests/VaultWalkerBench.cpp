@@ -0,0 +1,115 @@
+// Checks VaultWalker against the QDirIterator enumeration the indexer used
+// before it, and times both over a synthetic vault with attachments.
+// --notes=N sets the vault size (default 20,000).
+#include "BenchSupport.h"
+#include "VaultWalker.h"
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+struct Listing {
+  int notes = 0;
+  int dirs = 0;
+  int others = 0;
+  qint64 noteBytes = 0;
+  qint64 newestMs = 0;
+};
+
+static Listing walkerListing(const QString &root) {
+  Listing listing;
+  VaultWalker::walk(root, VaultWalker::All,
+                    [&](const VaultWalker::Entry &entry) {
+                      if (entry.isDir) {
+                        ++listing.dirs;
+                      } else if (VaultWalker::isNoteName(entry.name)) {
+                        ++listing.notes;
+                        listing.noteBytes += entry.size;
+                        listing.newestMs =
+                            qMax(listing.newestMs, entry.mtimeMs);
+                      } else {
+                        ++listing.others;
+                      }
+                    });
+  return listing;
+}
+
+// The old enumerator: one QDirIterator per directory and a QFileInfo for
+// every entry
+static Listing iteratorListing(const QString &root) {
+  Listing listing;
+  QVector<QString> dirs{root};
+  while (!dirs.isEmpty()) {
+    QDirIterator it(dirs.takeLast(),
+                    QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+      QString path = QDir::cleanPath(it.next());
+      QFileInfo info = it.fileInfo();
+      if (info.isDir()) {
+        ++listing.dirs;
+        if (!info.isSymLink())
+          dirs.append(path);
+      } else if (info.suffix().compare(QLatin1String("md"),
+                                       Qt::CaseInsensitive) == 0) {
+        ++listing.notes;
+        listing.noteBytes += info.size();
+        listing.newestMs = qMax(listing.newestMs,
+                                info.lastModified().toMSecsSinceEpoch());
+      } else {
+        ++listing.others;
+      }
+    }
+  }
+  return listing;
+}
+
+int main(int argc, char **argv) {
+  QCoreApplication app(argc, argv);
+  Bench::quietDebugOutput();
+
+  QTemporaryDir dir;
+  CHECK(dir.isValid());
+  Bench::VaultOptions options;
+  options.notes = Bench::intArg(QStringLiteral("notes"), 20000);
+  options.folders = 50;
+  options.paragraphs = 1;
+  const QString root = QDir::cleanPath(dir.path());
+  const QStringList paths = Bench::writeVault(root, options);
+  // An attachment next to every tenth note
+  for (int i = 0; i < paths.size(); i += 10) {
+    QFile file(paths[i].chopped(3) + QStringLiteral(".png"));
+    if (file.open(QIODevice::WriteOnly))
+      file.write("png");
+  }
+
+  Listing walked;
+  Listing iterated;
+  const Bench::Timing walker =
+      Bench::measure(5, [&](int) { walked = walkerListing(root); });
+  const Bench::Timing iterator =
+      Bench::measure(5, [&](int) { iterated = iteratorListing(root); });
+
+  CHECK(walked.notes == paths.size());
+  CHECK(walked.notes == iterated.notes);
+  CHECK(walked.dirs == iterated.dirs);
+  CHECK(walked.others == iterated.others);
+  CHECK(walked.noteBytes == iterated.noteBytes);
+  CHECK(walked.newestMs == iterated.newestMs);
+  CHECK(walked.newestMs == Bench::noteMtimeMs(0));
+
+  // One folder listed on its own, as getItemsInFolder does
+  const QString folder = root + QStringLiteral("/folder 0");
+  int listed = 0;
+  const Bench::Timing single = Bench::measure(20, [&](int) {
+    listed = 0;
+    VaultWalker::listDirectory(folder, VaultWalker::Notes | VaultWalker::Dirs,
+                               [&](const VaultWalker::Entry &) { ++listed; });
+  });
+  CHECK(listed > 0);
+
+  std::printf("%d notes, %d dirs, %d attachments: walker %8.1f ms, "
+              "QDirIterator %8.1f ms, one folder %.1f us\n",
+              walked.notes, walked.dirs, walked.others,
+              walker.medianUs / 1000, iterator.medianUs / 1000,
+              single.medianUs);
+  return Bench::finish("VaultWalker");
+}
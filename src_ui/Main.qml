@@ -150,6 +150,20 @@ FluWindow {
         }
     }
 
+    Connections {
+        target: ConfigBridge
+        function onPreparePlugin(name) {
+            // Create the container hidden; loaded plugins are kept, so a
+            // discarded hint costs nothing further
+            if (!pluginContainerLoader.item) {
+                pluginContainerLoader.source = "qrc:/plugin/PluginContainer.qml";
+                pluginContainerLoader.active = true;
+            }
+            if (pluginContainerLoader.item)
+                pluginContainerLoader.item.preparePlugin(name);
+        }
+    }
+
     property string targetPluginName: ""
     onTargetPluginNameChanged: {
         if (pluginContainerLoader.item) {
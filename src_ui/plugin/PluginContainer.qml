@@ -36,6 +36,16 @@ Window {
             x = -width;
             opacity = 0;
             drawerEntryAnim.start();
+            reportShownPending = true;
+        }
+    }
+
+    // Report lift-to-visible latency once the first frame is presented
+    property bool reportShownPending: false
+    onFrameSwapped: {
+        if (reportShownPending) {
+            reportShownPending = false;
+            ConfigBridge.reportPluginShown(ConfigBridge.enabledPlugins[swipeView.currentIndex] || "");
         }
     }
 
@@ -57,17 +67,32 @@ Window {
         }
     }
 
+    function indexOfPlugin(name) {
+        for (var i = 0; i < ConfigBridge.enabledPlugins.length; i++) {
+            if (ConfigBridge.enabledPlugins[i] === name)
+                return i;
+        }
+        return -1;
+    }
+
     onInitialPluginChanged: {
         if (initialPlugin !== "") {
-            for (var i = 0; i < ConfigBridge.enabledPlugins.length; i++) {
-                if (ConfigBridge.enabledPlugins[i] === initialPlugin) {
-                    swipeView.currentIndex = i;
-                    break;
-                }
-            }
+            var i = indexOfPlugin(initialPlugin);
+            if (i >= 0)
+                swipeView.currentIndex = i;
         }
     }
 
+    // Likely action hint from the engine: select the page while hidden so its
+    // Loader instantiates the plugin before the finger lifts
+    function preparePlugin(name) {
+        if (visible)
+            return;
+        var i = indexOfPlugin(name);
+        if (i >= 0)
+            swipeView.currentIndex = i;
+    }
+
     Connections {
         target: ConfigBridge
         function onEnabledPluginsChanged() {
@@ -97,14 +97,10 @@ Item {
 
     function loadNote() {
         if (notePath !== "" && notesFileHandler && notesFileHandler.exists(notePath)) {
-            var noteData = notesFileHandler.readNote(notePath);
-            // noteData.content is the raw markdown string
-            blockModel.loadMarkdown(noteData.content);
-            currentColor = noteData.color;
-            updateContainerColor();
-
-            // Ensure we have at least one block for editing if empty
-            if (noteData.content.trim() === "") {}
+            // Blocks and color come from the shared parse cache: notes linked
+            // from the previous one are usually read ahead already, and
+            // misses are parsed off the GUI thread
+            blockModel.loadNote(notePath);
         }
     }
 
@@ -112,6 +108,10 @@ Item {
         target: blockModel
         function onLoadingChanged() {
             if (!blockModel.loading) {
+                if (blockModel.color !== "") {
+                    currentColor = blockModel.color;
+                    updateContainerColor();
+                }
                 if (blockModel.rowCount() === 0) {
                     blockModel.insertBlock(0, "paragraph", "");
                 }
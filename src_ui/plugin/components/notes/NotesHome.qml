@@ -9,6 +9,8 @@ Item {
 
     property var notesModel: null
     property var notesFileHandler: null
+    // Search the text of notes instead of their titles and tags
+    property bool searchNoteText: false
 
     signal requestInputMode(bool active)
     signal openFolderRequested
@@ -22,40 +24,9 @@ Item {
         // Model is now set
     }
 
-    // Listen for model updates
-    Connections {
-        target: notesModel
-        enabled: notesModel !== null
-
-        function onCurrentPathChanged() {
-            // Path changed
-        }
-
-        // Force ListView to update when model finishes loading
-        function onLoadingChanged() {
-            if (notesModel && !notesModel.loading) {
-                forceListViewUpdate();
-            }
-        }
-    }
-
-    // Timer to force ListView refresh on next event loop
-    Timer {
-        id: refreshTimer
-        interval: 10
-        repeat: false
-        onTriggered: {
-            if (listView && homeRoot.notesModel) {
-                listView.model = null;
-                listView.model = homeRoot.notesModel;
-            }
-        }
-    }
-
-    // Force ListView to re-read its model data
-    function forceListViewUpdate() {
-        refreshTimer.start();
-    }
+    // The model reports every change with row signals, so the ListView is
+    // never re-bound: that would recreate every delegate and lose the
+    // scroll position
 
     // Refresh when this view becomes active again (after editor closes)
     StackView.onActivated: {
@@ -64,6 +35,23 @@ Item {
         }
     }
 
+    function runSearch(text) {
+        if (!notesModel)
+            return;
+        if (text.length === 0) {
+            notesModel.clearFilters();
+        } else if (searchNoteText) {
+            // Streams hits in; the next keystroke cancels this search
+            notesModel.searchContent(text);
+        } else if (/[:"#()]|\b(AND|OR|NOT)\b|(^|\s)-\S/.test(text)) {
+            // Fields, phrases and operators make it a structured query;
+            // plain words keep the fuzzy title search
+            notesModel.query = text;
+        } else {
+            notesModel.filterString = text;
+        }
+    }
+
     // Format path for display
     function formatDisplayPath(path) {
         var displayPath = path;
@@ -235,20 +223,14 @@ Item {
 
                         Text {
                             anchors.fill: parent
-                            text: "Search notes..."
+                            text: homeRoot.searchNoteText ? "Search note text..." : "Search notes..."
                             color: FluTheme.dark ? "#666" : "#999"
                             font.pixelSize: 13
                             visible: !searchInput.text && !searchInput.activeFocus
                             verticalAlignment: Text.AlignVCenter
                         }
 
-                        onTextChanged: {
-                            if (text.length > 0) {
-                                notesModel.filterString = text;
-                            } else {
-                                notesModel.clearFilters();
-                            }
-                        }
+                        onTextChanged: homeRoot.runSearch(text)
                     }
 
                     FluIconButton {
@@ -263,6 +245,22 @@ Item {
                 }
             }
 
+            // Full-text search toggle
+            FluIconButton {
+                iconSource: FluentIcons.Quote
+                iconSize: 14
+                highlighted: homeRoot.searchNoteText
+                onClicked: {
+                    homeRoot.searchNoteText = !homeRoot.searchNoteText;
+                    homeRoot.runSearch(searchInput.text);
+                }
+
+                FluTooltip {
+                    visible: parent.hovered
+                    text: homeRoot.searchNoteText ? "Search titles and tags" : "Search note text"
+                }
+            }
+
             // Tag filter button
             FluIconButton {
                 iconSource: FluentIcons.Tag
@@ -336,7 +334,7 @@ Item {
             delegate: Item {
                 id: wrapper
                 width: listView.width
-                height: model.type === "folder" ? 56 : 80
+                height: model.type === "folder" ? 56 : (model.snippet !== "" ? 96 : 80)
 
                 // Use model.* directly for live bindings (not required property)
                 property int itemIndex: model.index
@@ -347,6 +345,19 @@ Item {
                 property string itemColor: model.color
                 property var itemTags: model.tags
                 property bool itemIsPinned: model.isPinned
+                property string itemPreview: model.preview
+                // Text search hits: the matching passage (<b> marks the match)
+                property string itemSnippet: model.snippet
+                property int itemMatchCount: model.matchCount
+
+                // Notes listed before the index has parsed them come without a
+                // preview; it is loaded in the background and arrives as a change
+                function requestMissingPreview() {
+                    if (notesModel && itemType === "note" && itemPreview === "")
+                        notesModel.requestPreview(itemPath);
+                }
+                Component.onCompleted: requestMissingPreview()
+                onItemPathChanged: requestMissingPreview()
 
                 Rectangle {
                     id: delegateRoot
@@ -431,6 +442,28 @@ Item {
                                 }
                             }
 
+                            FluText {
+                                visible: wrapper.itemType === "note" && wrapper.itemSnippet === "" && text !== ""
+                                text: wrapper.itemPreview
+                                font.pixelSize: 11
+                                color: FluTheme.dark ? "#999" : "#777"
+                                elide: Text.ElideRight
+                                maximumLineCount: 1
+                                Layout.fillWidth: true
+                            }
+
+                            FluText {
+                                visible: wrapper.itemSnippet !== ""
+                                text: wrapper.itemSnippet
+                                textFormat: Text.StyledText
+                                font.pixelSize: 11
+                                color: FluTheme.dark ? "#BBB" : "#555"
+                                wrapMode: Text.Wrap
+                                elide: Text.ElideRight
+                                maximumLineCount: 2
+                                Layout.fillWidth: true
+                            }
+
                             // Tags row
                             Flow {
                                 visible: wrapper.itemTags && wrapper.itemTags.length > 0
@@ -463,7 +496,7 @@ Item {
                             }
 
                             FluText {
-                                text: wrapper.itemDate
+                                text: wrapper.itemMatchCount > 0 ? wrapper.itemDate + " · " + wrapper.itemMatchCount + (wrapper.itemMatchCount === 1 ? " match" : " matches") : wrapper.itemDate
                                 font.pixelSize: 11
                                 color: FluTheme.dark ? "#777" : "#999"
                             }
@@ -515,7 +548,7 @@ Item {
 
             // Empty state
             Rectangle {
-                visible: notesModel ? (notesModel.rowCount() === 0 && !notesModel.loading) : false
+                visible: notesModel ? (listView.count === 0 && !notesModel.loading) : false
                 anchors.centerIn: parent
                 width: 200
                 height: 120
@@ -2,6 +2,7 @@ import QtQuick 2.15
 import QtQuick.Layouts 1.15
 import QtQuick.Controls 2.15
 import FluentUI 1.0
+import EdgeGesture.Notes 1.0
 
 Item {
     id: root
@@ -28,6 +29,7 @@ Item {
     }
 
     property string notePath: ""
+    onNotePathChanged: loadEmbedContent() // "![[#Heading]]" depends on it
     property string vaultRootPath: ""
     property int blockIndex: -1
     property string type: "embed"
@@ -69,72 +71,42 @@ Item {
         loadEmbedContent();
     }
 
+    property int embedRequest: -1
+
     function loadEmbedContent() {
         console.log("EmbedBlock: loadEmbedContent called for content:", root.content);
 
-        if (!notesFileHandler) {
-            console.log("EmbedBlock: Error - notesFileHandler is null");
-            return;
-        }
-
-        if (!notesIndex) {
-            console.log("EmbedBlock: Warning - notesIndex is null");
-        } else {
-            console.log("EmbedBlock: notesIndex is available");
-        }
-
-        var notePathToLoad = "";
-        if (notesIndex && targetNote !== "") {
-            console.log("EmbedBlock: Searching index for title:", targetNote);
-            notePathToLoad = notesIndex.findPathByTitle(targetNote);
-            console.log("EmbedBlock: Index returned path:", notePathToLoad);
-        }
-
-        // Fallback to local
-        if (notePathToLoad === "" && targetNote !== "" && folderPath) {
-            console.log("EmbedBlock: Checking local folder for:", targetNote);
-            var local = folderPath + "/" + targetNote + ".md";
-            if (notesFileHandler.exists(local)) {
-                notePathToLoad = local;
-                console.log("EmbedBlock: Found locally:", notePathToLoad);
-            }
-        }
-
-        if (notePathToLoad === "") {
-            console.log("EmbedBlock: Failed to find note:", targetNote);
-            errorMsg = "Note not found: " + targetNote;
-            embedLoaded = false;
-            return;
-        }
-
-        var extracted = "";
-        if (targetBlockId !== "") {
-            console.log("EmbedBlock: Extracting block:", targetBlockId);
-            extracted = notesFileHandler.extractBlock(notePathToLoad, targetBlockId);
+        if (targetBlockId !== "")
             embedTitle = targetNote + " > ^" + targetBlockId;
-        } else if (targetSection !== "") {
-            console.log("EmbedBlock: Extracting section:", targetSection);
-            extracted = notesFileHandler.extractSection(notePathToLoad, targetSection);
+        else if (targetSection !== "")
             embedTitle = targetNote + " > " + targetSection;
-        } else {
-            // Full note
-            console.log("EmbedBlock: Reading full note");
-            var data = notesFileHandler.readNote(notePathToLoad);
-            extracted = data.content;
-            if (extracted.length > 500)
-                extracted = extracted.substring(0, 500) + "...";
+        else
             embedTitle = targetNote;
-        }
 
-        if (extracted === "") {
-            console.log("EmbedBlock: Extracted content is empty");
-            errorMsg = "Content not found";
-            embedLoaded = false;
-        } else {
-            console.log("EmbedBlock: Content loaded successfully, length:", extracted.length);
-            embedBody = extracted;
-            embedLoaded = true;
-            errorMsg = "";
+        // Resolved in the background from the shared parse cache; nested
+        // embeds are expanded and cycles stopped there
+        embedRequest = ParsedNoteCache.requestEmbed(root.notePath, root.content);
+    }
+
+    Connections {
+        target: ParsedNoteCache
+        function onEmbedResolved(request, text, error) {
+            if (request !== root.embedRequest)
+                return;
+            root.embedRequest = -1;
+            if (error !== "" || text === "") {
+                console.log("EmbedBlock: Embed not resolved:", error);
+                root.errorMsg = error !== "" ? error : "Content not found";
+                root.embedLoaded = false;
+                return;
+            }
+            // A whole note is previewed, not shown in full
+            var extracted = text;
+            if (root.targetSection === "" && root.targetBlockId === "" && extracted.length > 500)
+                extracted = extracted.substring(0, 500) + "...";
+            root.embedBody = extracted;
+            root.embedLoaded = true;
+            root.errorMsg = "";
         }
     }
 
@@ -192,7 +164,8 @@ Item {
                 // Content
                 Text {
                     Layout.fillWidth: true
-                    text: root.embedLoaded ? root.embedBody : root.errorMsg
+                    // Re-evaluated when the embed arrives from the cache
+                    text: root.embedLoaded ? process(root.embedBody) : root.errorMsg
 
                     wrapMode: Text.Wrap
                     color: FluTheme.dark ? "#e2e8f0" : "#2d3748"
@@ -209,11 +182,6 @@ Item {
                         t = t.replace(/`([^`]+)`/g, '<code style="background-color: ' + codeBg + '; color: ' + codeColor + '; padding: 2px 4px; border-radius: 5px;">$1</code>');
                         return t;
                     }
-
-                    Component.onCompleted: {
-                        if (root.embedLoaded)
-                            text = process(root.embedBody);
-                    }
                 }
             }
 
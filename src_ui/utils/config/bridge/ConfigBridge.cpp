@@ -34,7 +34,11 @@ ConfigBridge::ConfigBridge(QObject *parent)
   m_systemListener = new SystemEventListener(this);
   QCoreApplication::instance()->installNativeEventFilter(m_systemListener);
   connect(m_systemListener, &SystemEventListener::showPluginRequest, this,
-          &ConfigBridge::showPlugin);
+          &ConfigBridge::onShowPluginRequest);
+  connect(m_systemListener, &SystemEventListener::preparePluginRequest, this,
+          &ConfigBridge::onPreparePluginRequest);
+  connect(m_systemListener, &SystemEventListener::discardPluginRequest, this,
+          &ConfigBridge::onDiscardPluginRequest);
 
   // Auto-save timer
   m_saveTimer = new QTimer(this);
@@ -71,8 +75,8 @@ ConfigBridge::ConfigBridge(QObject *parent)
             loadConfig();
           });
 
-  // Load config
-  m_engineControl->cleanUp();
+  // Load config; a running engine is adopted by setEnabled() rather than
+  // being killed and restarted
   loadConfig();
   m_plugin->scanPlugins();
 }
@@ -148,6 +152,50 @@ void ConfigBridge::setWindowDark(bool dark) {
   WindowsUtils::setWindowDark(dark);
 }
 
+void ConfigBridge::onShowPluginRequest(const QString &name) {
+  m_showPrewarmed = (m_preparedPlugin == name);
+  m_preparedPlugin.clear();
+  m_showTimer.start();
+  emit showPlugin(name);
+}
+
+void ConfigBridge::onPreparePluginRequest(const QString &name) {
+  if (!m_enabledPlugins.contains(name))
+    return;
+  m_preparedPlugin = name;
+  emit preparePlugin(name);
+}
+
+void ConfigBridge::onDiscardPluginRequest(const QString &name) {
+  // The hidden instance stays loaded; only stop counting the next show as warm
+  if (m_preparedPlugin == name)
+    m_preparedPlugin.clear();
+}
+
+void ConfigBridge::reportPluginShown(const QString &name) {
+  if (!m_showTimer.isValid())
+    return;
+
+  qint64 elapsed = m_showTimer.elapsed();
+  m_showTimer.invalidate();
+
+  if (m_showPrewarmed) {
+    m_warmTotalMs += elapsed;
+    m_warmCount++;
+  } else {
+    m_coldTotalMs += elapsed;
+    m_coldCount++;
+  }
+
+  qDebug() << "[Plugin]" << name << "lift-to-visible:" << elapsed << "ms"
+           << (m_showPrewarmed ? "(pre-warmed)" : "(cold)")
+           << "| avg warm:"
+           << (m_warmCount ? m_warmTotalMs / m_warmCount : 0) << "ms over"
+           << m_warmCount << "| avg cold:"
+           << (m_coldCount ? m_coldTotalMs / m_coldCount : 0) << "ms over"
+           << m_coldCount;
+}
+
 void ConfigBridge::loadConfig() {
   m_loading = true;
 
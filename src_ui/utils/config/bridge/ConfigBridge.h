@@ -1,6 +1,7 @@
 #ifndef CONFIGBRIDGE_H
 #define CONFIGBRIDGE_H
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QVariantMap>
 
@@ -65,16 +66,22 @@ public:
   Q_INVOKABLE void applySettings();
   Q_INVOKABLE void setPreviewHandle(bool pressed, bool isLeft);
   Q_INVOKABLE void setWindowDark(bool dark);
+  // Called by the plugin container once its first frame is on screen
+  Q_INVOKABLE void reportPluginShown(const QString &name);
 
 signals:
   void enabledPluginsChanged();
   void engineEnabledChanged();
   void splitModeChanged();
   void showPlugin(QString name);
+  void preparePlugin(QString name);
   void settingsChanged(); // Restored signal
 
 private slots:
   void onPluginsScanned(const QVariantList &plugins);
+  void onShowPluginRequest(const QString &name);
+  void onPreparePluginRequest(const QString &name);
+  void onDiscardPluginRequest(const QString &name);
   void delayedSave();
 
 private:
@@ -103,6 +110,15 @@ private:
   int m_splitMode;
   QStringList m_enabledPlugins;
   bool m_loading;
+
+  // Lift-to-visible latency, split by whether the plugin was pre-warmed
+  QString m_preparedPlugin;
+  QElapsedTimer m_showTimer;
+  bool m_showPrewarmed = false;
+  qint64 m_warmTotalMs = 0;
+  int m_warmCount = 0;
+  qint64 m_coldTotalMs = 0;
+  int m_coldCount = 0;
 };
 
 #endif // CONFIGBRIDGE_H
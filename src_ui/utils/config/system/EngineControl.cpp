@@ -4,25 +4,32 @@
 #include <QCoreApplication>
 #include <QDebug>
 #include <QProcess>
+#include <QTimer>
 
 EngineControl::EngineControl(QObject *parent) : QObject(parent) {
   m_process = new QProcess(this);
   m_process->setProgram(QCoreApplication::applicationDirPath() +
                         "/GestureEngine.exe");
+
+  m_exitTimer = new QTimer(this);
+  m_exitTimer->setInterval(kExitPollMs);
+  connect(m_exitTimer, &QTimer::timeout, this, &EngineControl::onExitPoll);
 }
 
 EngineControl::~EngineControl() {
   if (m_process->state() != QProcess::NotRunning) {
     m_process->kill();
     m_process->waitForFinished(1000);
+  } else if (m_adopted) {
+    WindowsUtils::postQuitToWindowThread(L"OHOInputOverlay", L"OHO_Left");
   }
 }
 
 void EngineControl::setEnabled(bool enabled) {
-  if (m_enabled != enabled) {
-    m_enabled = enabled;
-    updateState();
-  }
+  // Always reconcile: an engine left over from an earlier session must be
+  // stopped even when the requested state did not change
+  m_enabled = enabled;
+  updateState();
 }
 
 void EngineControl::cleanUp() {
@@ -50,17 +57,76 @@ void EngineControl::setPreviewHandle(bool enabled, bool isLeft) {
                                     wMode, 0);
 }
 
+bool EngineControl::isEngineRunning() const {
+  // Held by GestureEngine for its whole lifetime
+  return WindowsUtils::namedMutexExists(L"EdgeGestureEngineMutex");
+}
+
+void EngineControl::onExitPoll() {
+  if (isEngineRunning()) {
+    if (!m_exitDeadline.hasExpired())
+      return;
+    if (!m_exitKilled) {
+      qDebug() << "[EngineControl] Engine did not exit in time, killing it.";
+      cleanUp();
+      m_exitKilled = true;
+      m_exitDeadline.setRemainingTime(kKillWaitMs);
+      return;
+    }
+  }
+
+  m_exitTimer->stop();
+  m_quitPending = false;
+  updateState();
+}
+
+void EngineControl::stopEngine() {
+  bool asked =
+      WindowsUtils::postQuitToWindowThread(L"OHOInputOverlay", L"OHO_Left");
+  m_quitPending = asked;
+
+  if (m_process->state() != QProcess::NotRunning) {
+    if (!asked || !m_process->waitForFinished(500)) {
+      m_process->kill();
+      m_process->waitForFinished(500);
+    }
+  } else if (!asked) {
+    cleanUp(); // no window to ask yet
+  }
+  m_adopted = false;
+}
+
 void EngineControl::updateState() {
   if (m_enabled) {
-    if (m_process->state() == QProcess::NotRunning) {
+    if (m_adopted && !isEngineRunning())
+      m_adopted = false; // exited behind our back
+    if (m_process->state() != QProcess::NotRunning || m_adopted ||
+        m_exitTimer->isActive())
+      return;
+
+    // An engine just asked to quit still holds the mutex while it exits;
+    // adopting it would leave nothing running once it is gone. Wait on a
+    // timer so the UI stays responsive; onExitPoll() comes back here.
+    if (m_quitPending && isEngineRunning()) {
+      m_exitKilled = false;
+      m_exitDeadline.setRemainingTime(kQuitWaitMs);
+      m_exitTimer->start();
+      return;
+    }
+    m_quitPending = false;
+
+    if (isEngineRunning()) {
+      // Reuse the running engine and bring it up to date with the config
+      m_adopted = true;
+      notifyChanges();
+      qDebug() << "[EngineControl] Adopted running engine.";
+    } else {
       m_process->start();
     }
   } else {
-    if (m_process->state() != QProcess::NotRunning) {
-      m_process->terminate();
-      if (!m_process->waitForFinished(500)) {
-        m_process->kill();
-      }
-    }
+    m_exitTimer->stop(); // the wait only served a restart
+    if (m_process->state() != QProcess::NotRunning || m_adopted ||
+        isEngineRunning())
+      stopEngine();
   }
 }
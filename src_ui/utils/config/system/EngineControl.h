@@ -1,8 +1,10 @@
 #pragma once
 
+#include <QDeadlineTimer>
 #include <QObject>
 
 class QProcess;
+class QTimer;
 
 class EngineControl : public QObject {
   Q_OBJECT
@@ -24,7 +26,25 @@ public:
 
 private:
   void updateState();
+  bool isEngineRunning() const;
+  void stopEngine();
+  // Polled while an engine asked to quit releases its mutex; resumes
+  // updateState() once it has, or once it had to be killed
+  void onExitPoll();
 
   bool m_enabled = false;
+  // Set when an engine that was already running is reused instead of
+  // being killed and restarted
+  bool m_adopted = false;
+  // Set when an engine was asked to quit and may still be shutting down
+  bool m_quitPending = false;
   QProcess *m_process = nullptr;
+
+  // Waiting for a quitting engine without blocking the event loop
+  static constexpr int kExitPollMs = 20;
+  static constexpr int kQuitWaitMs = 2000;
+  static constexpr int kKillWaitMs = 1000;
+  QTimer *m_exitTimer = nullptr;
+  QDeadlineTimer m_exitDeadline;
+  bool m_exitKilled = false;
 };
@@ -24,6 +24,14 @@ bool SystemEventListener::nativeEventFilter(const QByteArray &eventType,
       emit showPluginRequest(pluginName);
       return true;
     }
+    if (cds->dwData == 2) { // Likely action hint, gesture still in progress
+      emit preparePluginRequest(QString::fromUtf8((char *)cds->lpData));
+      return true;
+    }
+    if (cds->dwData == 3) { // Gesture cancelled or changed its mind
+      emit discardPluginRequest(QString::fromUtf8((char *)cds->lpData));
+      return true;
+    }
   }
 #endif
   return false;
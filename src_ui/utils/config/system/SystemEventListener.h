@@ -14,4 +14,6 @@ public:
 
 signals:
   void showPluginRequest(const QString &pluginName);
+  void preparePluginRequest(const QString &pluginName);
+  void discardPluginRequest(const QString &pluginName);
 };
@@ -45,6 +45,27 @@ void killProcess(const QString &processName) {
                                               << "/IM" << processName);
 }
 
+bool namedMutexExists(const std::wstring &name) {
+  HANDLE mutex = OpenMutexW(SYNCHRONIZE, FALSE, name.c_str());
+  if (!mutex)
+    return false;
+  CloseHandle(mutex);
+  return true;
+}
+
+// Asks the thread owning the window to leave its message loop, which lets
+// the process shut down cleanly instead of being killed
+bool postQuitToWindowThread(const std::wstring &className,
+                            const std::wstring &windowName) {
+  HWND hwnd = FindWindowW(className.empty() ? nullptr : className.c_str(),
+                          windowName.empty() ? nullptr : windowName.c_str());
+  if (!hwnd)
+    return false;
+
+  DWORD threadId = GetWindowThreadProcessId(hwnd, nullptr);
+  return threadId && PostThreadMessageW(threadId, WM_QUIT, 0, 0);
+}
+
 void applyMica(HWND hwnd) {
   if (!hwnd)
     return;
@@ -19,6 +19,9 @@ void postMessageToWindow(const std::wstring &className,
                          const std::wstring &windowName, UINT msg,
                          WPARAM wParam, LPARAM lParam);
 void killProcess(const QString &processName);
+bool namedMutexExists(const std::wstring &name);
+bool postQuitToWindowThread(const std::wstring &className,
+                            const std::wstring &windowName);
 void applyMica(HWND hwnd);
 
 } // namespace WindowsUtils